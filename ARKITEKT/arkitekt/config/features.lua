@@ -13,6 +13,10 @@ local M = {}
 -- When enabled, shows frame timing and performance metrics
 M.PROFILER_ENABLED = false
 
+-- Trace: span/instant events in a ring buffer, dumped as Chrome trace JSON
+-- (arkitekt/debug/trace.lua). Off: trace calls are empty functions
+M.TRACE_ENABLED = false
+
 -- ============================================================================
 -- NOTES
 -- ============================================================================
@@ -0,0 +1,104 @@
+-- @noindex
+-- Arkitekt/core/base64.lua
+-- Base64 encode/decode (RFC 4648, standard alphabet, '=' padding)
+-- Used to keep binary blocks inside text storage (ExtState, RPP chunks)
+
+local M = {}
+
+local byte, char, concat = string.byte, string.char, table.concat
+
+local ALPHABET = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/'
+
+-- 6-bit value -> character, and the reverse (byte -> 6-bit value)
+local ENC = {}
+local DEC = {}
+for i = 1, #ALPHABET do
+  local c = ALPHABET:sub(i, i)
+  ENC[i - 1] = c
+  DEC[byte(c)] = i - 1
+end
+
+-- Output is assembled in chunks to keep table.concat inputs bounded
+local CHUNK = 4096
+
+--- Encode a (binary) string
+--- @param data string
+--- @return string encoded
+function M.encode(data)
+  local n = #data
+  local out, parts = {}, {}
+  local o = 0
+  local full = n - n % 3
+
+  for i = 1, full, 3 do
+    local a, b, c = byte(data, i, i + 2)
+    local v = (a << 16) | (b << 8) | c
+    o = o + 1
+    out[o] = ENC[v >> 18] .. ENC[(v >> 12) & 63] .. ENC[(v >> 6) & 63] .. ENC[v & 63]
+    if o == CHUNK then
+      parts[#parts + 1] = concat(out, '', 1, o)
+      o = 0
+    end
+  end
+
+  local rest = n - full
+  if rest == 1 then
+    local v = byte(data, n) << 16
+    o = o + 1
+    out[o] = ENC[v >> 18] .. ENC[(v >> 12) & 63] .. '=='
+  elseif rest == 2 then
+    local a, b = byte(data, n - 1, n)
+    local v = (a << 16) | (b << 8)
+    o = o + 1
+    out[o] = ENC[v >> 18] .. ENC[(v >> 12) & 63] .. ENC[(v >> 6) & 63] .. '='
+  end
+
+  parts[#parts + 1] = concat(out, '', 1, o)
+  return concat(parts)
+end
+
+--- Decode a base64 string (whitespace is ignored)
+--- @param text string
+--- @return string|nil data Decoded bytes (nil if the input is not valid base64)
+--- @return string|nil error
+function M.decode(text)
+  if text:find('%s') then
+    text = text:gsub('%s+', '')
+  end
+  local n = #text
+  if n % 4 ~= 0 then
+    return nil, 'Invalid base64 length'
+  end
+
+  local pad = 0
+  if n > 0 and byte(text, n) == 61 then pad = pad + 1 end      -- '='
+  if n > 1 and byte(text, n - 1) == 61 then pad = pad + 1 end
+
+  local out, parts = {}, {}
+  local o = 0
+  for i = 1, n, 4 do
+    local c1, c2, c3, c4 = byte(text, i, i + 3)
+    local a, b = DEC[c1], DEC[c2]
+    local c = c3 == 61 and 0 or DEC[c3]
+    local d = c4 == 61 and 0 or DEC[c4]
+    if not (a and b and c and d) then
+      return nil, 'Invalid base64 character near offset ' .. i
+    end
+    local v = (a << 18) | (b << 12) | (c << 6) | d
+    o = o + 1
+    out[o] = char(v >> 16, (v >> 8) & 255, v & 255)
+    if o == CHUNK then
+      parts[#parts + 1] = concat(out, '', 1, o)
+      o = 0
+    end
+  end
+
+  parts[#parts + 1] = concat(out, '', 1, o)
+  local data = concat(parts)
+  if pad > 0 then
+    data = data:sub(1, #data - pad)
+  end
+  return data
+end
+
+return M
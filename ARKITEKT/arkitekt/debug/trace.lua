@@ -0,0 +1,172 @@
+-- @noindex
+-- arkitekt/debug/trace.lua
+-- Span and instant event tracing, dumped as Chrome trace JSON
+--
+-- Usage:
+--   local Trace = require('arkitekt.debug.trace')
+--   local span = Trace.begin('engine', 'update')
+--   ...
+--   Trace.finish(span, 'seeks', 2)
+--   Trace.instant('engine', 'seek_region', 'rid', rid)
+--   Trace.dump(path)   -- open in chrome://tracing or ui.perfetto.dev
+--
+-- Arguments are passed as key/value pairs after the name (up to 4 pairs;
+-- finish() adds up to 2), so a call site builds no table. Off by default: unless
+-- Features.TRACE_ENABLED is set (or enable() is called), every function is
+-- the same empty function and a call site costs one call.
+--
+-- Events go into a fixed ring of parallel arrays (default 100000 events;
+-- the oldest are overwritten). Lua runs scripts on one thread; events from
+-- a coroutine get their own tid, so a stepped job shows up as its own lane.
+-- A span is written when it begins and its duration filled in by finish();
+-- a span overwritten before it finishes is dropped from the dump.
+
+local M = {}
+
+M.DEFAULT_CAPACITY = 100000
+
+M.enabled = false
+
+local capacity = 0
+local seq = 0                 -- Events written so far
+local ph, cat, name, ts, dur, tid, args, ids = {}, {}, {}, {}, {}, {}, {}, {}
+
+local tids = setmetatable({}, { __mode = 'k' })
+local next_tid = 2
+local MAIN_TID = 1
+
+local function noop() end
+
+local function now_us()
+  return (reaper and reaper.time_precise or os.clock)() * 1e6
+end
+
+local function current_tid()
+  local co, is_main = coroutine.running()
+  if is_main then return MAIN_TID end
+  local id = tids[co]
+  if not id then
+    id = next_tid
+    next_tid = id + 1
+    tids[co] = id
+  end
+  return id
+end
+
+local function pack_args(k1, v1, k2, v2, k3, v3, k4, v4)
+  if k1 == nil then return nil end
+  local a = { [k1] = v1 }
+  if k2 ~= nil then a[k2] = v2 end
+  if k3 ~= nil then a[k3] = v3 end
+  if k4 ~= nil then a[k4] = v4 end
+  return a
+end
+
+local function write(kind, category, event_name, ...)
+  seq = seq + 1
+  local slot = (seq - 1) % capacity + 1
+  ph[slot], cat[slot], name[slot] = kind, category, event_name
+  ts[slot], dur[slot], tid[slot] = now_us(), nil, current_tid()
+  args[slot], ids[slot] = pack_args(...), seq
+  return seq
+end
+
+local function begin(category, event_name, ...)
+  return write('X', category, event_name, ...)
+end
+
+local function finish(span, k1, v1, k2, v2)
+  if not span then return end
+  local slot = (span - 1) % capacity + 1
+  if ids[slot] ~= span then return end
+  dur[slot] = now_us() - ts[slot]
+  if k1 ~= nil then
+    local a = args[slot] or {}
+    a[k1] = v1
+    if k2 ~= nil then a[k2] = v2 end
+    args[slot] = a
+  end
+end
+
+local function instant(category, event_name, ...)
+  write('i', category, event_name, ...)
+end
+
+local function bind(on)
+  M.enabled = on
+  M.begin = on and begin or noop
+  M.finish = on and finish or noop
+  M.instant = on and instant or noop
+end
+
+--- Start recording (clears the buffer)
+--- @param size number|nil Ring capacity in events (default DEFAULT_CAPACITY)
+function M.enable(size)
+  capacity = size or M.DEFAULT_CAPACITY
+  M.clear()
+  bind(true)
+end
+
+--- Stop recording (the buffer is kept for dump())
+function M.disable()
+  bind(false)
+end
+
+--- Drop every recorded event
+function M.clear()
+  seq = 0
+  ph, cat, name, ts, dur, tid, args, ids = {}, {}, {}, {}, {}, {}, {}, {}
+end
+
+--- Recorded events, oldest first (unfinished spans are left out)
+--- @return table events Array of Chrome trace events {ph, cat, name, ts, dur, pid, tid, s, args}
+function M.events()
+  local out = {}
+  local first = math.max(1, seq - capacity + 1)
+  for n = first, seq do
+    local slot = (n - 1) % capacity + 1
+    local kind = ph[slot]
+    if kind == 'i' then
+      out[#out + 1] = { ph = 'i', s = 't', cat = cat[slot], name = name[slot], ts = ts[slot],
+        pid = 1, tid = tid[slot], args = args[slot] }
+    elseif dur[slot] then
+      out[#out + 1] = { ph = 'X', cat = cat[slot], name = name[slot], ts = ts[slot], dur = dur[slot],
+        pid = 1, tid = tid[slot], args = args[slot] }
+    end
+  end
+  return out
+end
+
+--- Write recorded events as Chrome trace JSON
+--- @param path string
+--- @return boolean ok
+--- @return string|nil error
+function M.dump(path)
+  local JSON = require('arkitekt.core.json')
+  local f, err = io.open(path, 'w')
+  if not f then return false, err end
+
+  local lanes = {}
+  f:write('{"displayTimeUnit":"ms","traceEvents":[\n')
+  f:write(JSON.encode({ ph = 'M', name = 'thread_name', pid = 1, tid = MAIN_TID, args = { name = 'main' } }))
+  for _, event in ipairs(M.events()) do
+    if event.tid ~= MAIN_TID and not lanes[event.tid] then
+      lanes[event.tid] = true
+      f:write(',\n', JSON.encode({ ph = 'M', name = 'thread_name', pid = 1, tid = event.tid,
+        args = { name = 'coroutine ' .. (event.tid - 1) } }))
+    end
+    f:write(',\n', JSON.encode(event))
+  end
+  f:write('\n]}\n')
+  f:close()
+  return true
+end
+
+bind(false)
+
+local ok, Features = pcall(require, 'arkitekt.config.features')
+if ok and Features and Features.TRACE_ENABLED then
+  M.enable()
+end
+
+return M
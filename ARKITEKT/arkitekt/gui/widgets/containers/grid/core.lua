@@ -1388,6 +1388,9 @@ local function _update_grid_from_opts(grid, opts)
   if opts.extend_input_area ~= nil then
     grid.extend_input_area = opts.extend_input_area
   end
+  if opts.virtual ~= nil then
+    grid.virtual = opts.virtual
+  end
 
   -- Update drag/drop configuration
   if opts.external_drag_check ~= nil then
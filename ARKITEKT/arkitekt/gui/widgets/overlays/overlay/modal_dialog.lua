@@ -7,6 +7,7 @@ local Base = require('arkitekt.gui.widgets.base')
 
 local Sheet = require('arkitekt.gui.widgets.overlays.overlay.sheet')
 local Button = require('arkitekt.gui.widgets.primitives.button')
+local ProgressBar = require('arkitekt.gui.widgets.primitives.progress_bar')
 local Theme = require('arkitekt.theme')
 local Colors = require('arkitekt.core.colors')
 local M = {}
@@ -172,6 +173,81 @@ function M.show_message(ctx, window, title, message, opts)
   return true
 end
 
+-- ============================================================================
+-- PROGRESS DIALOG
+-- ============================================================================
+
+local progress_modal_open = {}
+
+--- Show a progress dialog for work stepped from the defer loop
+--- opts.progress() is polled every frame and returns fraction (0..1) and a
+--- status line; it returns nil once the work is over, which closes the
+--- dialog. Cancel and Esc call opts.on_cancel; a scrim click does nothing,
+--- so a stray click cannot abort long work.
+function M.show_progress(ctx, window, title, opts)
+  opts = opts or {}
+  local id = opts.id or '##progress_dialog'
+  local cancel_label = opts.cancel_label or 'Cancel'
+  local on_cancel = opts.on_cancel
+
+  if not window or not window.overlay then
+    return false
+  end
+
+  if not progress_modal_open[id] then
+    progress_modal_open[id] = true
+    local finished = false
+
+    window.overlay:push({
+      id = id,
+      close_on_scrim = false,
+      esc_to_close = true,
+      on_close = function()
+        progress_modal_open[id] = nil
+        if on_cancel and not finished then on_cancel() end
+      end,
+      render = function(ctx, alpha, bounds)
+        local fraction, status = opts.progress()
+        if not fraction then
+          finished = true
+          window.overlay:pop(id)
+          return
+        end
+
+        Sheet.render(ctx, alpha, bounds, function(ctx, w, h, a)
+          if opts.message then
+            ImGui.PushTextWrapPos(ctx, w)
+            ImGui.Text(ctx, opts.message)
+            ImGui.PopTextWrapPos(ctx)
+            ImGui.Dummy(ctx, 0, 8)
+          end
+
+          ImGui.Text(ctx, status or '')
+          ImGui.Dummy(ctx, 0, 4)
+          ProgressBar.Draw(ctx, { width = w, height = 6, progress = fraction })
+
+          -- Bottom button
+          ImGui.Dummy(ctx, 0, 10)
+          ImGui.Separator(ctx)
+          ImGui.Dummy(ctx, 0, 8)
+
+          local button_w = DEFAULTS.button_width
+          ImGui.SetCursorPosX(ctx, (w - button_w) * 0.5)
+          if ImGui.Button(ctx, cancel_label, button_w, 28) then
+            window.overlay:pop(id)
+          end
+        end, {
+          title = title,
+          width = opts.width or DEFAULTS.width,
+          height = opts.height or DEFAULTS.height
+        })
+      end
+    })
+  end
+
+  return true
+end
+
 -- ============================================================================
 -- CONFIRMATION DIALOG
 -- ============================================================================
@@ -192,6 +268,7 @@ function M.show_confirm(ctx, window, title, message, opts)
 
   if not confirm_modal_open[id] then
     confirm_modal_open[id] = true
+    local confirmed = false
 
     window.overlay:push({
       id = id,
@@ -199,7 +276,7 @@ function M.show_confirm(ctx, window, title, message, opts)
       esc_to_close = true,
       on_close = function()
         confirm_modal_open[id] = nil
-        if on_cancel then on_cancel() end
+        if on_cancel and not confirmed then on_cancel() end
       end,
       render = function(ctx, alpha, bounds)
         Sheet.render(ctx, alpha, bounds, function(ctx, w, h, a)
@@ -219,15 +296,13 @@ function M.show_confirm(ctx, window, title, message, opts)
 
           ImGui.SetCursorPosX(ctx, start_x)
           if ImGui.Button(ctx, cancel_label, button_w, 28) then
-            window.overlay:pop(id)
-            confirm_modal_open[id] = nil
-            if on_cancel then on_cancel() end
+            window.overlay:pop(id)  -- on_close calls on_cancel
           end
 
           ImGui.SameLine(ctx, 0, DEFAULTS.button_spacing)
           if ImGui.Button(ctx, confirm_label, button_w, 28) then
+            confirmed = true
             window.overlay:pop(id)
-            confirm_modal_open[id] = nil
             if on_confirm then on_confirm() end
           end
         end, {
@@ -3,138 +3,257 @@
 -- Region playlist operations matching SWS behavior (Append, Paste, Crop, etc.)
 
 local Colors = require('arkitekt.core.colors')
+local Trace = require('arkitekt.debug.trace')
 
 local M = {}
 
--- ============================================================================
--- UTILITY FUNCTIONS
--- ============================================================================
+local format = string.format
 
---- Get project length based on last item end
-local function get_project_length(proj)
-  proj = proj or 0
-  local length = 0
+local TEMPO_ENVELOPE = 'Tempo map'  -- Master track envelope holding the tempo markers
 
-  for i = 0, reaper.CountTracks(proj) - 1 do
-    local track = reaper.GetTrack(proj, i)
-    for j = 0, reaper.CountTrackMediaItems(track) - 1 do
-      local item = reaper.GetTrackMediaItem(track, j)
-      local item_end = reaper.GetMediaItemInfo_Value(item, 'D_POSITION') +
-                      reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
-      if item_end > length then
-        length = item_end
-      end
+-- ============================================================================
+-- SPLIT / UNSPLIT
+-- ============================================================================
+-- Copying a region needs its items cut at the region bounds. Append and paste
+-- must leave the source untouched afterwards, so each split records only the
+-- fields a split changes on the left piece (position, length, fades, take
+-- start offsets) and is undone by deleting the right piece and writing those
+-- fields back. No item chunk is serialized or reparsed for this, which
+-- matters for MIDI items whose chunks carry every event.
+
+-- Item fields changed by a split (split crossfades can touch either side)
+local SPLIT_ITEM_FIELDS = {
+  'D_POSITION', 'D_LENGTH',
+  'D_FADEINLEN', 'D_FADEOUTLEN', 'D_FADEINLEN_AUTO', 'D_FADEOUTLEN_AUTO',
+}
+
+--- Split an item, recording how to undo it
+--- @param splits table|nil Split records (nil: no record)
+--- @return userdata|nil right The new right-hand item
+local function split_item(item, position, splits)
+  local state, offsets
+  if splits then
+    state = {}
+    for i, field in ipairs(SPLIT_ITEM_FIELDS) do
+      state[i] = reaper.GetMediaItemInfo_Value(item, field)
+    end
+    offsets = {}
+    for t = 0, reaper.CountTakes(item) - 1 do
+      offsets[t + 1] = reaper.GetMediaItemTakeInfo_Value(reaper.GetMediaItemTake(item, t), 'D_STARTOFFS')
     end
   end
 
-  return length
+  local right = reaper.SplitMediaItem(item, position)
+  if right and splits then
+    splits[#splits + 1] = { item = item, right = right, state = state, offsets = offsets }
+  end
+  return right
 end
 
---- Split items at region boundaries and return items in region
-local function split_items_in_region(proj, region_start, region_end)
-  local items_in_region = {}
-
+--- Split items at region boundaries and return the pieces inside the region
+--- @param proj number Project (0 for current)
+--- @param region_start number
+--- @param region_end number
+--- @param splits table|nil Receives split records for unsplit_items()
+--- @return table items Items fully inside the region
+function M.split_items_in_region(proj, region_start, region_end, splits)
+  -- Snapshot first: splitting adds items to the enumeration
+  local overlapping = {}
   for i = 0, reaper.CountMediaItems(proj) - 1 do
     local item = reaper.GetMediaItem(proj, i)
     local item_pos = reaper.GetMediaItemInfo_Value(item, 'D_POSITION')
-    local item_len = reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
-    local item_end = item_pos + item_len
-
-    -- Check if item overlaps with region
+    local item_end = item_pos + reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
     if item_pos < region_end and item_end > region_start then
-      -- Split at region start if item starts before
-      if item_pos < region_start and item_end > region_start then
-        reaper.SplitMediaItem(item, region_start)
-      end
+      overlapping[#overlapping + 1] = { item, item_pos, item_end }
+    end
+  end
 
-      -- Split at region end if item extends beyond
-      if item_pos < region_end and item_end > region_end then
-        reaper.SplitMediaItem(item, region_end)
-      end
+  local items_in_region = {}
+  for _, entry in ipairs(overlapping) do
+    local piece, item_pos, item_end = entry[1], entry[2], entry[3]
 
-      -- Check if this item is now fully within region
-      item_pos = reaper.GetMediaItemInfo_Value(item, 'D_POSITION')
-      item_len = reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
-      item_end = item_pos + item_len
+    -- Split at region start if item starts before; keep the right piece
+    if item_pos < region_start then
+      piece = split_item(piece, region_start, splits)
+    end
 
-      if item_pos >= region_start and item_end <= region_end then
-        items_in_region[#items_in_region + 1] = item
-      end
+    -- Split at region end if item extends beyond
+    if piece and item_end > region_end then
+      split_item(piece, region_end, splits)
+    end
+
+    if piece then
+      items_in_region[#items_in_region + 1] = piece
     end
   end
 
   return items_in_region
 end
 
---- Duplicate items to target position
-local function duplicate_items_to_position(items, time_offset)
-  local new_items = {}
-
-  for _, item in ipairs(items) do
-    local track = reaper.GetMediaItem_Track(item)
-    local _, chunk = reaper.GetItemStateChunk(item, '', false)
+--- Undo recorded splits (newest first, so re-split pieces unwind in order)
+--- @param splits table From split_items_in_region()
+function M.unsplit_items(splits)
+  for i = #splits, 1, -1 do
+    local split = splits[i]
+    reaper.DeleteTrackMediaItem(reaper.GetMediaItem_Track(split.right), split.right)
+    for f, field in ipairs(SPLIT_ITEM_FIELDS) do
+      reaper.SetMediaItemInfo_Value(split.item, field, split.state[f])
+    end
+    for t, offset in ipairs(split.offsets) do
+      local take = reaper.GetMediaItemTake(split.item, t - 1)
+      if take then
+        reaper.SetMediaItemTakeInfo_Value(take, 'D_STARTOFFS', offset)
+      end
+    end
+  end
+end
 
-    -- Create new item
-    local new_item = reaper.AddMediaItemToTrack(track)
+-- ============================================================================
+-- ENVELOPE RANGES
+-- ============================================================================
+-- Automation is copied point by point, straight from each envelope to its
+-- destination ranges (no temporary items). As with SWS env_reduce=2, every
+-- copied range gets edge points at both ends carrying the value there, so a
+-- copy starts and ends on the source value even when no point sits on the
+-- region boundary. Take envelopes live in the item chunk with item-relative
+-- times: they travel with the copied items and the split trims them.
+
+--- All track envelopes of a project, master track included (its tempo
+--- envelope is left to the tempo batch)
+local function list_track_envelopes(proj)
+  local envelopes = {}
+  local function add_track(track)
+    for j = 0, reaper.CountTrackEnvelopes(track) - 1 do
+      local envelope = reaper.GetTrackEnvelope(track, j)
+      local _, name = reaper.GetEnvelopeName(envelope)
+      if name ~= TEMPO_ENVELOPE then
+        envelopes[#envelopes + 1] = envelope
+      end
+    end
+  end
 
-    -- Set chunk
-    reaper.SetItemStateChunk(new_item, chunk, false)
+  add_track(reaper.GetMasterTrack(proj))
+  for i = 0, reaper.CountTracks(proj) - 1 do
+    add_track(reaper.GetTrack(proj, i))
+  end
+  return envelopes
+end
 
-    -- Update position
-    local old_pos = reaper.GetMediaItemInfo_Value(item, 'D_POSITION')
-    reaper.SetMediaItemInfo_Value(new_item, 'D_POSITION', old_pos + time_offset)
+--- Read an envelope range [range_start, range_end] with edge points
+--- @return table|nil points Array of {time, value, shape, tension}; nil for an envelope without points
+local function read_envelope_range(envelope, range_start, range_end)
+  local count = reaper.CountEnvelopePoints(envelope)
+  if count == 0 then
+    return nil
+  end
 
-    new_items[#new_items + 1] = new_item
+  -- Start from the point at/before range_start instead of scanning from 0
+  local first = math.max(reaper.GetEnvelopePointByTime(envelope, range_start), 0)
+  local points = {}
+  local lead_shape, lead_tension = 0, 0
+
+  for k = first, count - 1 do
+    local retval, time, value, shape, tension = reaper.GetEnvelopePoint(envelope, k)
+    if time >= range_end then break end
+    if time >= range_start then
+      points[#points + 1] = { time, value, shape, tension }
+    else
+      lead_shape, lead_tension = shape, tension
+    end
   end
 
-  return new_items
-end
+  -- Leading edge: value at range_start, continuing the segment it cuts
+  if not points[1] or points[1][1] > range_start then
+    local _, value = reaper.Envelope_Evaluate(envelope, range_start, 0, 0)
+    table.insert(points, 1, { range_start, value, lead_shape, lead_tension })
+  end
 
---- Copy tempo markers in range to target position
-local function copy_tempo_markers(proj, source_start, source_end, time_offset)
-  local tempo_count = reaper.CountTempoTimeSigMarkers(proj)
+  -- Trailing edge: the value arriving at range_end (a square segment holds)
+  local tail = points[#points]
+  local end_value = tail[2]
+  if tail[3] ~= 1 then
+    local _
+    _, end_value = reaper.Envelope_Evaluate(envelope, range_end, 0, 0)
+  end
+  points[#points + 1] = { range_end, end_value, 0, 0 }
 
-  for i = 0, tempo_count - 1 do
-    local retval, timepos, measurepos, beatpos, bpm, timesig_num, timesig_denom, lineartempo =
-      reaper.GetTempoTimeSigMarker(proj, i)
+  return points
+end
 
-    if timepos >= source_start and timepos <= source_end then
-      local new_time = timepos + time_offset
-      reaper.SetTempoTimeSigMarker(proj, -1, new_time, -1, -1, bpm, timesig_num, timesig_denom, lineartempo)
+--- Envelope ranges of every envelope with points, as {envelope, points}
+local function read_envelope_sources(track_envelopes, range_start, range_end)
+  local envelopes = {}
+  for _, envelope in ipairs(track_envelopes) do
+    local points = read_envelope_range(envelope, range_start, range_end)
+    if points then
+      envelopes[#envelopes + 1] = { envelope = envelope, points = points }
     end
   end
+  return envelopes
 end
 
---- Copy envelope points in range to target position
-local function copy_envelope_points(proj, source_start, source_end, time_offset)
-  for i = 0, reaper.CountTracks(proj) - 1 do
-    local track = reaper.GetTrack(proj, i)
-    for j = 0, reaper.CountTrackEnvelopes(track) - 1 do
-      local envelope = reaper.GetTrackEnvelope(track, j)
-      local num_points = reaper.CountEnvelopePoints(envelope)
-
-      local points_to_copy = {}
-      for k = 0, num_points - 1 do
-        local retval, time, value, shape, tension, selected = reaper.GetEnvelopePoint(envelope, k)
-        if time >= source_start and time <= source_end then
-          points_to_copy[#points_to_copy + 1] = {
-            time = time + time_offset,
-            value = value,
-            shape = shape,
-            tension = tension
-          }
-        end
+--- Read a region's source material once: items (split at its bounds) and
+--- envelope points inside it
+--- @param track_envelopes table From list_track_envelopes()
+--- @param splits table|nil Receives split records (see unsplit_items)
+local function read_region_source(proj, region_start, region_end, track_envelopes, splits)
+  local items = {}
+  for _, item in ipairs(M.split_items_in_region(proj, region_start, region_end, splits)) do
+    local _, chunk = reaper.GetItemStateChunk(item, '', false)
+    items[#items + 1] = {
+      track = reaper.GetMediaItem_Track(item),
+      chunk = chunk,
+      position = reaper.GetMediaItemInfo_Value(item, 'D_POSITION'),
+    }
+  end
+
+  return {
+    items = items,
+    envelopes = read_envelope_sources(track_envelopes, region_start, region_end),
+  }
+end
+
+--- Write every repetition of a source at the given time offsets
+--- @param dest table {proj, tracks = map|nil, envelopes = map|nil, created = table|nil}
+---   (maps source tracks/envelopes to another project's; nil writes in place.
+---   created = {items, envelopes} logs what was written for rollback)
+--- @param sorted_envelopes table Set of envelopes to sort once at the end
+local function write_source_copies(dest, source, offsets, sorted_envelopes)
+  local created = dest.created
+  for _, src in ipairs(source.items) do
+    local track = dest.tracks and dest.tracks[src.track] or src.track
+    for _, offset in ipairs(offsets) do
+      local new_item = reaper.AddMediaItemToTrack(track)
+      reaper.SetItemStateChunk(new_item, src.chunk, false)
+      reaper.SetMediaItemInfo_Value(new_item, 'D_POSITION', src.position + offset)
+      if created then
+        created.items[#created.items + 1] = new_item
       end
+    end
+  end
 
-      -- Insert copied points
-      for _, point in ipairs(points_to_copy) do
-        reaper.InsertEnvelopePoint(envelope, point.time, point.value, point.shape, point.tension, false, true)
+  for _, env in ipairs(source.envelopes) do
+    local envelope = env.envelope
+    if dest.envelopes then
+      envelope = dest.envelopes[envelope]
+    end
+    -- Unsorted inserts append: points past the first count are ours
+    if envelope and created and not created.envelopes[envelope] then
+      created.envelopes[envelope] = reaper.CountEnvelopePoints(envelope)
+    end
+    for _, offset in ipairs(envelope and offsets or {}) do
+      for _, p in ipairs(env.points) do
+        reaper.InsertEnvelopePoint(envelope, p[1] + offset, p[2], p[3], p[4], false, true)
       end
     end
+    if envelope then
+      sorted_envelopes[envelope] = true
+    end
   end
 end
 
 --- Insert silence at position by moving everything after it
+--- (a negative length closes the gap again: everything from position moves back)
 local function insert_silence(proj, position, length)
   -- Select all items after position
   reaper.SelectAllMediaItems(proj, false)
@@ -148,420 +267,1171 @@ local function insert_silence(proj, position, length)
     end
   end
 
-  -- Move selected items
+  -- Move selected items (nudge units: seconds)
   if reaper.CountSelectedMediaItems(proj) > 0 then
-    reaper.ApplyNudge(proj, 0, 0, 0, length, false, 0)
+    reaper.ApplyNudge(proj, 0, 0, 1, math.abs(length), length < 0, 0)
   end
 
-  -- Move tempo markers
-  local tempo_count = reaper.CountTempoTimeSigMarkers(proj)
-  for i = tempo_count - 1, 0, -1 do
+  -- Move tempo markers (all removed before reinserting: a marker moved back
+  -- would otherwise land between the ones still to move)
+  local moved_tempo = {}
+  for i = reaper.CountTempoTimeSigMarkers(proj) - 1, 0, -1 do
     local retval, timepos, measurepos, beatpos, bpm, timesig_num, timesig_denom, lineartempo =
       reaper.GetTempoTimeSigMarker(proj, i)
+    if timepos < position then break end  -- Markers are sorted by time
 
-    if timepos >= position then
-      reaper.DeleteTempoTimeSigMarker(proj, i)
-      reaper.SetTempoTimeSigMarker(proj, -1, timepos + length, -1, -1, bpm, timesig_num, timesig_denom, lineartempo)
-    end
+    reaper.DeleteTempoTimeSigMarker(proj, i)
+    moved_tempo[#moved_tempo + 1] = { timepos, bpm, timesig_num, timesig_denom, lineartempo }
+  end
+  for _, m in ipairs(moved_tempo) do
+    reaper.SetTempoTimeSigMarker(proj, -1, m[1] + length, -1, -1, m[2], m[3], m[4], m[5])
   end
 
-  -- Move envelope points
-  for i = 0, reaper.CountTracks(proj) - 1 do
-    local track = reaper.GetTrack(proj, i)
-    for j = 0, reaper.CountTrackEnvelopes(track) - 1 do
-      local envelope = reaper.GetTrackEnvelope(track, j)
-      local num_points = reaper.CountEnvelopePoints(envelope)
+  -- Move envelope points (the same envelopes copies write to: master
+  -- included, its tempo envelope moved with the markers above)
+  for _, envelope in ipairs(list_track_envelopes(proj)) do
+    local num_points = reaper.CountEnvelopePoints(envelope)
 
-      local points_to_move = {}
-      for k = num_points - 1, 0, -1 do
-        local retval, time, value, shape, tension, selected = reaper.GetEnvelopePoint(envelope, k)
-        if time >= position then
-          points_to_move[#points_to_move + 1] = {idx = k, time = time, value = value, shape = shape, tension = tension}
-        end
+    local points_to_move = {}
+    for k = num_points - 1, 0, -1 do
+      local retval, time, value, shape, tension, selected = reaper.GetEnvelopePoint(envelope, k)
+      if time >= position then
+        points_to_move[#points_to_move + 1] = {idx = k, time = time, value = value, shape = shape, tension = tension}
       end
+    end
 
-      for _, point in ipairs(points_to_move) do
-        reaper.DeleteEnvelopePointEx(envelope, -1, point.idx)
-        reaper.InsertEnvelopePoint(envelope, point.time + length, point.value, point.shape, point.tension, false, true)
-      end
+    for _, point in ipairs(points_to_move) do
+      reaper.DeleteEnvelopePointEx(envelope, -1, point.idx)
+      reaper.InsertEnvelopePoint(envelope, point.time + length, point.value, point.shape, point.tension, false, true)
+    end
+    if #points_to_move > 0 then
+      reaper.Envelope_SortPoints(envelope)
     end
   end
 end
 
 -- ============================================================================
--- PUBLIC API - MATCHING SWS BEHAVIOR
+-- TEMPO DUPLICATION
 -- ============================================================================
+-- Tempo markers are copied in one batch per operation. REAPER rebuilds the
+-- tempo map on every SetTempoTimeSigMarker, so one call per marker per copy
+-- made dense tempo automation a large part of crop time. A batch takes all
+-- (source range, destination offset, repeat count) entries at once:
+-- touching or overlapping source ranges are merged and read in one pass
+-- over the tempo map, the copies are expanded and sorted, and the result
+-- is written into the master tempo envelope with a single state chunk.
+-- Where two copies put a marker at the same time (a copy's end boundary is
+-- the next copy's start), the later copy's marker is kept.
+
+--- Tempo ranges of every block: {start, end, offset, reps, length}
+local function tempo_ranges(blocks)
+  local ranges = {}
+  for _, block in ipairs(blocks) do
+    local region = block.region
+    ranges[#ranges + 1] = {
+      start = region.start, ['end'] = region['end'], offset = block.start - region.start,
+      reps = block.reps, length = block.length,
+    }
+  end
+  return ranges
+end
 
---- Append playlist to the end of the project
---- @param playlist_items table Array of {rid, reps} objects
---- @return boolean success
-function M.append_playlist_to_project(playlist_items)
-  if not playlist_items or #playlist_items == 0 then
-    return false
+--- Read the source markers of a batch: one pass over merged ranges
+--- @param ranges table From tempo_ranges()
+--- @return table markers Sorted array of {time, bpm, num, denom, linear}
+local function read_tempo_batch(proj, ranges)
+  local spans = {}
+  for i, range in ipairs(ranges) do
+    spans[i] = { range.start, range['end'] }
+  end
+  table.sort(spans, function(a, b) return a[1] < b[1] end)
+  local merged = {}
+  for _, span in ipairs(spans) do
+    local last = merged[#merged]
+    if last and span[1] <= last[2] then
+      last[2] = math.max(last[2], span[2])
+    else
+      merged[#merged + 1] = { span[1], span[2] }
+    end
   end
 
-  local proj = 0
-  local Regions = require('arkitekt.reaper.regions')
+  local markers = {}
+  local span_index = 1
+  for i = 0, reaper.CountTempoTimeSigMarkers(proj) - 1 do
+    local span = merged[span_index]
+    if not span then break end
+    local retval, timepos, measurepos, beatpos, bpm, timesig_num, timesig_denom, lineartempo =
+      reaper.GetTempoTimeSigMarker(proj, i)
+    while span and timepos > span[2] do  -- Markers are sorted by time
+      span_index = span_index + 1
+      span = merged[span_index]
+    end
+    if span and timepos >= span[1] then
+      markers[#markers + 1] = { timepos, bpm, timesig_num, timesig_denom, lineartempo }
+    end
+  end
+  return markers
+end
 
-  reaper.PreventUIRefresh(1)
-  reaper.Undo_BeginBlock()
+--- Expand a batch into the markers to write (pure: no REAPER calls)
+--- @param markers table Sorted source markers (only [1] = time is needed)
+--- @param ranges table From tempo_ranges(), in timeline order
+--- @return table copies Sorted array of {time, source marker}
+local function expand_tempo(markers, ranges)
+  local copies = {}
+  for _, range in ipairs(ranges) do
+    -- First marker at/after the range start
+    local lo, hi = 1, #markers + 1
+    while lo < hi do
+      local mid = (lo + hi) // 2
+      if markers[mid][1] < range.start then lo = mid + 1 else hi = mid end
+    end
+    for rep = 0, range.reps - 1 do
+      local offset = range.offset + rep * range.length
+      for i = lo, #markers do
+        local m = markers[i]
+        if m[1] > range['end'] then break end
+        copies[#copies + 1] = { m[1] + offset, m, #copies + 1 }
+      end
+    end
+  end
 
-  -- Get current project end
-  local project_end = get_project_length(proj)
-  local current_position = project_end
+  -- Time order; at equal times the later copy sorts last and wins
+  table.sort(copies, function(a, b)
+    if a[1] ~= b[1] then return a[1] < b[1] end
+    return a[3] < b[3]
+  end)
+  local kept = {}
+  for i, copy in ipairs(copies) do
+    local next_copy = copies[i + 1]
+    if not (next_copy and next_copy[1] == copy[1]) then
+      kept[#kept + 1] = copy
+    end
+  end
+  return kept
+end
 
-  -- Process each playlist item
-  for _, pl_item in ipairs(playlist_items) do
-    local rid = pl_item.rid
-    local reps = pl_item.reps or 1
+--- Tempo envelope PT line (shape 1 = square, 0 = linear ramp; time
+--- signature packed as num + denom << 16 when the marker sets one)
+local function tempo_point_line(time, m)
+  local timesig = m[3] > 0 and format(' %d', m[3] + (m[4] << 16)) or ''
+  return format('PT %.14g %.14g %d%s', time, m[2], m[5] and 0 or 1, timesig)
+end
 
-    local region = Regions.get_region_by_rid(proj, rid)
-    if region then
-      local region_length = region['end'] - region.start
+--- Write expanded tempo copies with one tempo envelope update
+--- @param copies table From expand_tempo()
+local function write_tempo_batch(proj, copies)
+  if #copies == 0 then
+    return
+  end
 
-      -- Split items in this region
-      local items_in_region = split_items_in_region(proj, region.start, region['end'])
+  -- A project without markers has no tempo envelope until the first one
+  local master = reaper.GetMasterTrack(proj)
+  local first = 1
+  local envelope = reaper.GetTrackEnvelopeByName(master, TEMPO_ENVELOPE)
+  if not envelope then
+    local time, m = copies[1][1], copies[1][2]
+    reaper.SetTempoTimeSigMarker(proj, -1, time, -1, -1, m[2], m[3], m[4], m[5])
+    envelope = reaper.GetTrackEnvelopeByName(master, TEMPO_ENVELOPE)
+    first = 2
+  end
+  local ok, chunk = false, nil
+  if envelope then
+    ok, chunk = reaper.GetEnvelopeStateChunk(envelope, '', false)
+  end
+  if not ok then
+    for i = first, #copies do
+      local time, m = copies[i][1], copies[i][2]
+      reaper.SetTempoTimeSigMarker(proj, -1, time, -1, -1, m[2], m[3], m[4], m[5])
+    end
+    return
+  end
 
-      -- Duplicate for each rep
-      for rep = 1, reps do
+  -- Existing points and the copies in time order (existing first at a tie)
+  local head, points = {}, {}
+  for line in chunk:gmatch('[^\n]+') do
+    local time = line:match('^%s*PT (%S+)')
+    if time then
+      points[#points + 1] = { tonumber(time), #points + 1, line }
+    elseif not line:match('^%s*>%s*$') then
+      head[#head + 1] = line
+    end
+  end
+  for i = first, #copies do
+    local time = copies[i][1]
+    points[#points + 1] = { time, #points + 1, tempo_point_line(time, copies[i][2]) }
+  end
+  table.sort(points, function(a, b)
+    if a[1] ~= b[1] then return a[1] < b[1] end
+    return a[2] < b[2]
+  end)
+  for _, point in ipairs(points) do
+    head[#head + 1] = point[3]
+  end
+  head[#head + 1] = '>'
+  reaper.SetEnvelopeStateChunk(envelope, table.concat(head, '\n'), false)
+  reaper.UpdateTimeline()
+end
 
-        local time_offset = current_position - region.start
+-- ============================================================================
+-- PLAYLIST LAYOUT
+-- ============================================================================
+-- Each playlist item becomes a block: one source region written `reps` times
+-- back to back. All sources are read once up front (a region used by several
+-- items or looped many times is still read once), then every repetition is
+-- written from that read in a single pass. A region looped 64 times used to
+-- be split, read and rescanned 64 times; now it costs one read plus 64 writes.
+-- Reading everything first also keeps copies laid out over a later source
+-- (crop builds from 0) from being picked up as source material.
+
+--- Index project regions by RID (one marker scan instead of one per item)
+local function index_regions(proj)
+  local Regions = require('arkitekt.reaper.regions')
+  local by_rid = {}
+  for _, region in ipairs(Regions.scan_project_regions(proj)) do
+    if not by_rid[region.rid] then
+      by_rid[region.rid] = region
+    end
+  end
+  return by_rid
+end
 
-        -- Duplicate items
-        duplicate_items_to_position(items_in_region, time_offset)
+--- Resolve playlist items to blocks laid out back to back
+--- @param regions_by_rid table From index_regions()
+--- @param playlist_items table Array of {rid, reps}
+--- @param start_position number Destination of the first block
+--- @return table blocks Array of {region, reps, length, start}
+--- @return number end_position
+local function layout_blocks(regions_by_rid, playlist_items, start_position)
+  local blocks = {}
+  local position = start_position
+  for _, pl_item in ipairs(playlist_items) do
+    local region = regions_by_rid[pl_item.rid]
+    local reps = pl_item.reps or 1
+    if region and reps > 0 then
+      local length = region['end'] - region.start
+      blocks[#blocks + 1] = { region = region, reps = reps, length = length, start = position }
+      position = position + length * reps
+    end
+  end
+  return blocks, position
+end
 
-        -- Copy tempo markers
-        copy_tempo_markers(proj, region.start, region['end'], time_offset)
+--- Read the source of every block (each region once)
+--- @param unsplit boolean Restore source items split at region bounds
+--- @return table sources Map region -> source
+local function read_block_sources(proj, blocks, unsplit)
+  local track_envelopes = list_track_envelopes(proj)
+  local splits = unsplit and {} or nil
+  local sources = {}
+  for _, block in ipairs(blocks) do
+    local region = block.region
+    if not sources[region] then
+      sources[region] = read_region_source(proj, region.start, region['end'], track_envelopes, splits)
+    end
+  end
 
-        -- Copy envelope points
-        copy_envelope_points(proj, region.start, region['end'], time_offset)
+  -- Sources are in memory now: put the split items back before writing
+  if splits then
+    M.unsplit_items(splits)
+  end
+  return sources
+end
 
-        -- Create region marker
-        local new_region_start = current_position
-        local new_region_end = current_position + region_length
+--- Write every block's items, tempo markers and envelope points into place
+--- @param dest table See write_source_copies()
+--- @param tempo_markers table From read_tempo_batch()
+local function write_blocks(dest, blocks, sources, tempo_markers)
+  local sorted_envelopes = {}
+  for _, block in ipairs(blocks) do
+    local offsets = {}
+    local base = block.start - block.region.start
+    for rep = 1, block.reps do
+      offsets[rep] = base + (rep - 1) * block.length
+    end
+    write_source_copies(dest, sources[block.region], offsets, sorted_envelopes)
+  end
 
-        -- Convert RGBA color to native REAPER color
-        local native_color = region.color and Colors.RgbaToReaperNative(region.color) or 0
+  for envelope in pairs(sorted_envelopes) do
+    reaper.Envelope_SortPoints(envelope)
+  end
+  write_tempo_batch(dest.proj, expand_tempo(tempo_markers, tempo_ranges(blocks)))
+end
 
-        reaper.AddProjectMarker2(proj, true, new_region_start, new_region_end, region.name or '', -1, native_color)
+--- Create one region marker per block repetition
+--- @param preserve_rid boolean Reuse the source region numbers
+local function add_block_regions(proj, blocks, preserve_rid)
+  for _, block in ipairs(blocks) do
+    local region = block.region
+    local native_color = region.color and Colors.RgbaToReaperNative(region.color) or 0
+    local want_index = preserve_rid and region.rid or -1
+    for rep = 1, block.reps do
+      local new_region_start = block.start + (rep - 1) * block.length
+      reaper.AddProjectMarker2(proj, true, new_region_start, new_region_start + block.length,
+        region.name or '', want_index, native_color)
+    end
+  end
+end
 
-        current_position = current_position + region_length
+-- ============================================================================
+-- PROJECT TRANSFER (NEW TAB)
+-- ============================================================================
+
+--- Track chunk without items and envelope points; FX, routing and envelope
+--- settings are kept. Automation item instances are dropped with the points.
+local function strip_track_chunk(chunk)
+  local out = {}
+  local depth = 0
+  local skip_depth, env_depth
+  for line in chunk:gmatch('[^\n]+') do
+    local trimmed = line:match('^%s*(.-)%s*$')
+    local opens = trimmed:sub(1, 1) == '<'
+    local closes = trimmed == '>'
+
+    if skip_depth then
+      if opens then
+        depth = depth + 1
+      elseif closes then
+        depth = depth - 1
+        if depth < skip_depth then skip_depth = nil end
+      end
+    elseif opens and depth == 1 and trimmed:match('^<ITEM') then
+      depth = depth + 1
+      skip_depth = depth
+    else
+      if opens then
+        depth = depth + 1
+        if trimmed:match('^<%u*ENV') then env_depth = depth end
+      elseif closes then
+        if depth == env_depth then env_depth = nil end
+        depth = depth - 1
+      end
+      local is_point = depth == env_depth and (trimmed:match('^PT ') or trimmed:match('^POOLEDENVINST '))
+      if not is_point then
+        out[#out + 1] = line
       end
     end
   end
+  return table.concat(out, '\n')
+end
 
-  reaper.Undo_EndBlock('Append playlist to project', -1)
-  reaper.PreventUIRefresh(-1)
-  reaper.UpdateArrange()
+--- Map a source track and its envelopes (by name) to a destination track
+local function map_track(dest, src_track, dst_track)
+  dest.tracks[src_track] = dst_track
+  local by_name = {}
+  for j = 0, reaper.CountTrackEnvelopes(dst_track) - 1 do
+    local envelope = reaper.GetTrackEnvelope(dst_track, j)
+    local _, name = reaper.GetEnvelopeName(envelope)
+    by_name[name] = by_name[name] or envelope
+  end
+  for j = 0, reaper.CountTrackEnvelopes(src_track) - 1 do
+    local envelope = reaper.GetTrackEnvelope(src_track, j)
+    local _, name = reaper.GetEnvelopeName(envelope)
+    dest.envelopes[envelope] = by_name[name]
+  end
+end
 
-  return true
+-- ============================================================================
+-- OFFLINE FLATTEN (RPP FILE)
+-- ============================================================================
+-- Writes the linear version of a playlist to a new .RPP without touching the
+-- open project: only Get* calls are made. Items overlapping a region bound
+-- are trimmed in their chunk text (position, length, take offsets, fades)
+-- instead of being split. The file is streamed track by track and item by
+-- item, so the flattened show is never held in memory; only each region's
+-- source is (once, however often it repeats).
+-- Not carried: master track settings, automation items, Bezier tension.
+
+-- Quote a name the way RPP files do (pick a quote char the name lacks)
+local function rpp_quote(text)
+  text = text or ''
+  for _, q in ipairs({ '"', "'", '`' }) do
+    if not text:find(q, 1, true) then
+      return q .. text .. q
+    end
+  end
+  return '"' .. text:gsub('"', "'") .. '"'
 end
 
---- Paste playlist at edit cursor
---- @param playlist_items table Array of {rid, reps} objects
---- @return boolean success
-function M.paste_playlist_at_cursor(playlist_items)
-  if not playlist_items or #playlist_items == 0 then
-    return false
+--- Trim an item chunk to [range_start, range_end]
+--- Drops item/take GUIDs so REAPER assigns fresh ones to every copy.
+--- @return string head Chunk text up to the POSITION value
+--- @return number position Trimmed item position
+--- @return string tail Rest of the chunk after the POSITION value
+local function trim_item_chunk(chunk, item_pos, item_len, range_start, range_end, playrates)
+  local cut = math.max(0, range_start - item_pos)
+  local new_pos = item_pos + cut
+  local new_len = math.min(item_pos + item_len, range_end) - new_pos
+  local trim_end = item_pos + item_len > range_end
+
+  local head, tail = {}, {}
+  local out = head
+  local depth, take, env_depth = 0, 0, nil
+  for line in chunk:gmatch('[^\n]+') do
+    local trimmed = line:match('^%s*(.-)%s*$')
+    local keep = line
+    if trimmed:sub(1, 1) == '<' then
+      depth = depth + 1
+      if depth == 2 and trimmed:match('^<%u*ENV') then env_depth = depth end
+    elseif trimmed == '>' then
+      if depth == env_depth then env_depth = nil end
+      depth = depth - 1
+    elseif depth == 1 then
+      local key = trimmed:match('^(%S+)')
+      if key == 'POSITION' then
+        out[#out + 1] = 'POSITION '
+        out, keep = tail, nil
+      elseif key == 'LENGTH' then
+        keep = format('LENGTH %.14g', new_len)
+      elseif key == 'SOFFS' then
+        take = take + 1
+        local soffs = tonumber(trimmed:match('^SOFFS (%S+)')) or 0
+        keep = format('SOFFS %.14g', soffs + cut * (playrates[take] or 1))
+      elseif key == 'FADEIN' and cut > 0 then
+        keep = trimmed:gsub('^FADEIN (%S+) %S+', 'FADEIN %1 0')
+      elseif key == 'FADEOUT' and trim_end then
+        keep = trimmed:gsub('^FADEOUT (%S+) %S+', 'FADEOUT %1 0')
+      elseif key == 'IGUID' or key == 'GUID' then
+        keep = nil
+      end
+    elseif depth == env_depth and cut > 0 and trimmed:match('^PT ') then
+      -- Take envelope points are item-relative
+      local t, rest = trimmed:match('^PT (%S+)(.*)$')
+      keep = format('PT %.14g', (tonumber(t) or 0) - cut) .. rest
+    end
+    if keep then
+      out[#out + 1] = keep
+    end
   end
 
-  local proj = 0
-  local Regions = require('arkitekt.reaper.regions')
+  return table.concat(head, '\n'), new_pos, '\n' .. table.concat(tail, '\n') .. '\n'
+end
 
-  -- Get edit cursor position
-  local cursor_pos = reaper.GetCursorPosition()
-  local project_end = get_project_length(proj)
+--- Read a region's source for the offline writer (no splits)
+local function read_region_source_offline(proj, region_start, region_end, track_envelopes)
+  local items_by_track = {}
+  for i = 0, reaper.CountMediaItems(proj) - 1 do
+    local item = reaper.GetMediaItem(proj, i)
+    local item_pos = reaper.GetMediaItemInfo_Value(item, 'D_POSITION')
+    local item_len = reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
+    if item_pos < region_end and item_pos + item_len > region_start then
+      local playrates = {}
+      for t = 0, reaper.CountTakes(item) - 1 do
+        playrates[t + 1] = reaper.GetMediaItemTakeInfo_Value(reaper.GetMediaItemTake(item, t), 'D_PLAYRATE')
+      end
+      local _, chunk = reaper.GetItemStateChunk(item, '', false)
+      local head, position, tail = trim_item_chunk(chunk, item_pos, item_len, region_start, region_end, playrates)
 
-  reaper.PreventUIRefresh(1)
-  reaper.Undo_BeginBlock()
+      local track = reaper.GetMediaItem_Track(item)
+      local list = items_by_track[track] or {}
+      items_by_track[track] = list
+      list[#list + 1] = { head = head, position = position, tail = tail }
+    end
+  end
 
-  -- Calculate total playlist length
-  local total_length = 0
-  for _, pl_item in ipairs(playlist_items) do
-    local region = Regions.get_region_by_rid(proj, pl_item.rid)
-    if region then
-      local region_length = region['end'] - region.start
-      local reps = pl_item.reps or 1
-      total_length = total_length + (region_length * reps)
+  local env_points = {}
+  for _, env in ipairs(read_envelope_sources(track_envelopes, region_start, region_end)) do
+    env_points[env.envelope] = env.points
+  end
+
+  return {
+    items_by_track = items_by_track,
+    env_points = env_points,
+  }
+end
+
+--- Call fn(source, offset) for every block repetition, in timeline order
+local function each_copy(blocks, sources, fn)
+  for _, block in ipairs(blocks) do
+    local source = sources[block.region]
+    local base = block.start - block.region.start
+    for rep = 1, block.reps do
+      fn(source, base + (rep - 1) * block.length, block)
     end
   end
+end
 
-  -- Insert silence if pasting inside project
-  if cursor_pos < project_end then
-    insert_silence(proj, cursor_pos, total_length)
+--- Stream one track: its chunk minus items/points, with the flattened
+--- envelope points and item copies written in their place
+local function write_flat_track(f, track, blocks, sources, stats)
+  -- Envelope block header line -> envelope
+  local env_by_header = {}
+  for j = 0, reaper.CountTrackEnvelopes(track) - 1 do
+    local envelope = reaper.GetTrackEnvelope(track, j)
+    local _, env_chunk = reaper.GetEnvelopeStateChunk(envelope, '', false)
+    local header = env_chunk:match('^%s*(<[^\n]*)')
+    if header then
+      env_by_header[header:match('^(.-)%s*$')] = envelope
+    end
   end
 
-  local current_position = cursor_pos
+  local _, chunk = reaper.GetTrackStateChunk(track, '', false)
+  local depth = 0
+  local skip_depth, env_depth, envelope
+  for line in chunk:gmatch('[^\n]+') do
+    local trimmed = line:match('^%s*(.-)%s*$')
+    local opens = trimmed:sub(1, 1) == '<'
+    local closes = trimmed == '>'
+
+    if skip_depth then
+      if opens then
+        depth = depth + 1
+      elseif closes then
+        depth = depth - 1
+        if depth < skip_depth then skip_depth = nil end
+      end
+    elseif opens and depth == 1 and trimmed:match('^<ITEM') then
+      depth = depth + 1
+      skip_depth = depth
+    else
+      if opens then
+        depth = depth + 1
+        if trimmed:match('^<%u*ENV') then
+          env_depth, envelope = depth, env_by_header[trimmed]
+        end
+      elseif closes then
+        if depth == env_depth and envelope then
+          each_copy(blocks, sources, function(source, offset)
+            for _, p in ipairs(source.env_points[envelope] or {}) do
+              f:write(format('PT %.14g %.14g %d\n', p[1] + offset, p[2], p[3]))
+              stats.points = stats.points + 1
+            end
+          end)
+        end
+        if depth == env_depth then env_depth, envelope = nil, nil end
+        if depth == 1 then
+          -- Track closes: item copies go last
+          each_copy(blocks, sources, function(source, offset)
+            for _, it in ipairs(source.items_by_track[track] or {}) do
+              f:write(it.head, format('%.14g', it.position + offset), it.tail)
+              stats.items = stats.items + 1
+            end
+          end)
+        end
+        depth = depth - 1
+      end
+      local is_point = depth == env_depth and (trimmed:match('^PT ') or trimmed:match('^POOLEDENVINST '))
+      if not is_point then
+        f:write(line, '\n')
+      end
+    end
+  end
+end
 
-  -- Process each playlist item
-  for _, pl_item in ipairs(playlist_items) do
-    local rid = pl_item.rid
-    local reps = pl_item.reps or 1
+--- Write a playlist's flattened timeline to a new .RPP file
+--- The open project is only read. Items, track envelopes, tempo and regions
+--- are laid out from 0 like crop; regions keep their numbers.
+--- @param playlist_items table Array of {rid, reps} objects
+--- @param path string Output .RPP path
+--- @param proj number|nil Project (0 for current)
+--- @return boolean ok
+--- @return table|string stats {items, points, regions, tempo, length} or error
+function M.write_playlist_rpp(playlist_items, path, proj)
+  proj = proj or 0
+  if not playlist_items or #playlist_items == 0 then
+    return false, 'Playlist is empty'
+  end
 
-    local region = Regions.get_region_by_rid(proj, rid)
-    if region then
-      local region_length = region['end'] - region.start
+  local blocks, playlist_end = layout_blocks(index_regions(proj), playlist_items, 0)
+  if #blocks == 0 then
+    return false, 'None of the playlist regions exist in this project'
+  end
 
-      -- Split items in this region
-      local items_in_region = split_items_in_region(proj, region.start, region['end'])
+  local f, err = io.open(path, 'wb')
+  if not f then
+    return false, err
+  end
 
-      -- Duplicate for each rep
-      for rep = 1, reps do
+  local track_envelopes = list_track_envelopes(proj)
+  local sources = {}
+  for _, block in ipairs(blocks) do
+    local region = block.region
+    if not sources[region] then
+      sources[region] = read_region_source_offline(proj, region.start, region['end'], track_envelopes)
+    end
+  end
 
-        local time_offset = current_position - region.start
+  local stats = { items = 0, points = 0, regions = 0, tempo = 0, length = playlist_end }
+  local bpm, bpi = reaper.GetProjectTimeSignature2(proj)
+  f:write(format('<REAPER_PROJECT 0.1 %s %d\n', rpp_quote(reaper.GetAppVersion()), os.time()))
+  f:write(format('  TEMPO %.14g %d 4\n', bpm, bpi))
+
+  -- Regions: one MARKER line at the start (name, color) and one at the end
+  for _, block in ipairs(blocks) do
+    local region = block.region
+    local native_color = region.color and Colors.RgbaToReaperNative(region.color) or 0
+    for rep = 1, block.reps do
+      local start_pos = block.start + (rep - 1) * block.length
+      f:write(format('  MARKER %d %.14g %s 1 %d\n', region.rid, start_pos, rpp_quote(region.name), native_color))
+      f:write(format('  MARKER %d %.14g "" 1\n', region.rid, start_pos + block.length))
+      stats.regions = stats.regions + 1
+    end
+  end
 
-        -- Duplicate items
-        duplicate_items_to_position(items_in_region, time_offset)
+  -- Tempo map
+  local ranges = tempo_ranges(blocks)
+  f:write('  <TEMPOENVEX\n    ACT 0 -1\n')
+  for _, copy in ipairs(expand_tempo(read_tempo_batch(proj, ranges), ranges)) do
+    f:write('    ', tempo_point_line(copy[1], copy[2]), '\n')
+    stats.tempo = stats.tempo + 1
+  end
+  f:write('  >\n')
 
-        -- Copy tempo markers
-        copy_tempo_markers(proj, region.start, region['end'], time_offset)
+  for i = 0, reaper.CountTracks(proj) - 1 do
+    write_flat_track(f, reaper.GetTrack(proj, i), blocks, sources, stats)
+  end
 
-        -- Copy envelope points
-        copy_envelope_points(proj, region.start, region['end'], time_offset)
+  f:write('>\n')
+  f:close()
+  return true, stats
+end
 
-        -- Create region marker
-        local new_region_start = current_position
-        local new_region_end = current_position + region_length
+-- ============================================================================
+-- PLAN / APPLY
+-- ============================================================================
+-- Append, paste and crop run in two stages. plan_playlist() reads a snapshot
+-- of the project (regions, cursor, item extents, tempo marker times and the
+-- envelope points of each used region) and turns it into plain data: the
+-- destination range of every copy, the regions to re-create, the tempo
+-- ranges to copy and a dry-run summary of what will be touched. Building
+-- the plan changes nothing.
+--
+-- apply_plan() returns a job that does the work in units (one source region
+-- read or one copy written), running as many units per step() as fit the
+-- time budget. Stepped from a defer loop, the UI keeps drawing and can show
+-- progress; cancel() rolls back everything written so far. Envelope points
+-- stay unsorted and the tempo batch unwritten until the job finishes; the
+-- whole operation becomes a single undo point then (items, envelopes, tempo
+-- and regions).
+--
+-- The job is pinned to the project it was planned on, so switching tabs
+-- while it runs does not redirect its writes. Before each step the items,
+-- tracks and envelopes it holds are checked with ValidatePtr2; if one was
+-- deleted meanwhile, the job rolls back what it still can and stops with
+-- job.error set.
+
+local PLAN_LABELS = {
+  append = 'Append playlist to project',
+  paste = 'Paste playlist at cursor',
+  crop = 'Crop project to playlist',
+}
+
+--- Count the envelope points read_envelope_range() returns (edges included)
+local function count_envelope_range(envelope, range_start, range_end)
+  if reaper.CountEnvelopePoints(envelope) == 0 then
+    return 0
+  end
+  local before_start = reaper.GetEnvelopePointByTime(envelope, range_start)
+  local before_end = reaper.GetEnvelopePointByTime(envelope, range_end)
+  if before_end >= 0 then
+    local _, time = reaper.GetEnvelopePoint(envelope, before_end)
+    if time >= range_end then
+      before_end = before_end - 1
+    end
+  end
+  -- Points strictly inside, plus the leading and trailing edge points
+  return math.max(before_end - math.max(before_start, -1), 0) + 2
+end
 
-        local native_color = region.color and Colors.RgbaToReaperNative(region.color) or 0
+--- Read what planning needs from a project (changes nothing)
+--- @param proj number|userdata Project (0 for current)
+--- @param playlist_items table Array of {rid, reps} (regions to measure)
+--- @return table snapshot {regions_by_rid, cursor, project_end, items, tempo, point_counts}
+function M.snapshot_project(proj, playlist_items)
+  local span = Trace.begin('region_ops', 'snapshot', 'items', #playlist_items)
+  local items, project_end = {}, 0
+  for i = 0, reaper.CountMediaItems(proj) - 1 do
+    local item = reaper.GetMediaItem(proj, i)
+    local item_pos = reaper.GetMediaItemInfo_Value(item, 'D_POSITION')
+    local item_end = item_pos + reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
+    items[#items + 1] = { item_pos, item_end }
+    if item_end > project_end then
+      project_end = item_end
+    end
+  end
 
-        reaper.AddProjectMarker2(proj, true, new_region_start, new_region_end, region.name or '', -1, native_color)
+  local tempo = {}
+  for i = 0, reaper.CountTempoTimeSigMarkers(proj) - 1 do
+    local _, timepos = reaper.GetTempoTimeSigMarker(proj, i)
+    tempo[#tempo + 1] = { timepos }
+  end
 
-        current_position = current_position + region_length
+  local regions_by_rid = index_regions(proj)
+  local track_envelopes = list_track_envelopes(proj)
+  local point_counts = {}
+  for _, pl_item in ipairs(playlist_items) do
+    local region = regions_by_rid[pl_item.rid]
+    if region and not point_counts[region.rid] then
+      local points = 0
+      for _, envelope in ipairs(track_envelopes) do
+        points = points + count_envelope_range(envelope, region.start, region['end'])
       end
+      point_counts[region.rid] = points
     end
   end
 
-  reaper.Undo_EndBlock('Paste playlist at cursor', -1)
-  reaper.PreventUIRefresh(-1)
-  reaper.UpdateArrange()
-
-  return true
+  Trace.finish(span, 'media_items', #items, 'envelopes', #track_envelopes)
+  return {
+    regions_by_rid = regions_by_rid,
+    cursor = reaper.GetCursorPosition(),
+    project_end = project_end,
+    items = items,
+    tempo = tempo,
+    point_counts = point_counts,
+  }
 end
 
---- Crop project to playlist
+--- Plan a playlist operation from a snapshot (pure: no REAPER calls)
+--- @param snapshot table From snapshot_project()
+--- @param mode string 'append', 'paste' or 'crop'
 --- @param playlist_items table Array of {rid, reps} objects
---- @return boolean success
-function M.crop_to_playlist(playlist_items)
-  if not playlist_items or #playlist_items == 0 then
-    return false
+--- @return table plan {mode, label, start, end, silence, crop, blocks,
+---   sources, copies, regions, tempo, summary}
+function M.build_plan(snapshot, mode, playlist_items)
+  local span = Trace.begin('region_ops', 'build_plan', 'mode', mode)
+  local start_position = 0
+  if mode == 'append' then
+    start_position = snapshot.project_end
+  elseif mode == 'paste' then
+    start_position = snapshot.cursor
   end
+  local blocks, end_position = layout_blocks(snapshot.regions_by_rid, playlist_items, start_position)
+
+  local plan = {
+    mode = mode,
+    label = PLAN_LABELS[mode],
+    start = start_position,
+    ['end'] = end_position,
+    blocks = blocks,
+    sources = {},   -- Source regions, each read once
+    copies = {},    -- Destination range of every item repetition
+    regions = {},   -- Regions to create, one per copy
+    tempo = tempo_ranges(blocks),  -- Tempo copy ranges {start, end, offset, reps, length}
+  }
+  local summary = {
+    copies = 0, items = 0, points = 0, tempo = 0, regions = 0, moved_items = 0,
+    length = end_position - start_position,
+  }
 
-  local proj = 0
-  local Regions = require('arkitekt.reaper.regions')
+  -- Pasting inside the project first opens a gap for the playlist
+  if mode == 'paste' and start_position < snapshot.project_end then
+    plan.silence = { position = start_position, length = end_position - start_position }
+    for _, extent in ipairs(snapshot.items) do
+      if extent[1] >= start_position then
+        summary.moved_items = summary.moved_items + 1
+      end
+    end
+  elseif mode == 'crop' then
+    plan.crop = { 0, end_position }
+  end
 
-  reaper.PreventUIRefresh(1)
-  reaper.Undo_BeginBlock()
+  local stats_by_region = {}
+  for _, block in ipairs(blocks) do
+    local region = block.region
+    local range_start, range_end = region.start, region['end']
+    local stats = stats_by_region[region]
+    if not stats then
+      stats = { items = 0, points = snapshot.point_counts[region.rid] or 0 }
+      for _, extent in ipairs(snapshot.items) do
+        if extent[1] < range_end and extent[2] > range_start then
+          stats.items = stats.items + 1
+        end
+      end
+      stats_by_region[region] = stats
+      plan.sources[#plan.sources + 1] = region
+    end
 
-  -- Build playlist content at position 0
-  local current_position = 0
-  local regions_to_create = {}
+    for rep = 1, block.reps do
+      local dest_start = block.start + (rep - 1) * block.length
+      local dest_end = dest_start + block.length
+      plan.copies[#plan.copies + 1] = {
+        block = block, rep = rep, start = dest_start, ['end'] = dest_end, offset = dest_start - range_start,
+      }
+      plan.regions[#plan.regions + 1] = {
+        name = region.name, start = dest_start, ['end'] = dest_end, color = region.color,
+      }
+    end
 
-  for _, pl_item in ipairs(playlist_items) do
-    local rid = pl_item.rid
-    local reps = pl_item.reps or 1
+    summary.items = summary.items + stats.items * block.reps
+    summary.points = summary.points + stats.points * block.reps
+  end
 
-    local region = Regions.get_region_by_rid(proj, rid)
-    if region then
-      local region_length = region['end'] - region.start
+  summary.tempo = #expand_tempo(snapshot.tempo, plan.tempo)
+  summary.copies = #plan.copies
+  summary.regions = #plan.regions
+  plan.summary = summary
+  Trace.finish(span, 'copies', summary.copies, 'sources', #plan.sources)
+  return plan
+end
 
-      -- Split items in this region
-      local items_in_region = split_items_in_region(proj, region.start, region['end'])
+--- Snapshot the project and plan a playlist operation on it
+--- @param mode string 'append', 'paste' or 'crop'
+--- @param playlist_items table Array of {rid, reps} objects
+--- @param proj number|nil Project (0/nil for current)
+--- @return table plan See build_plan()
+function M.plan_playlist(mode, playlist_items, proj)
+  return M.build_plan(M.snapshot_project(proj or 0, playlist_items), mode, playlist_items)
+end
 
-      -- Duplicate for each rep
-      for rep = 1, reps do
-        local time_offset = current_position - region.start
+--- Dry-run summary of a plan for display
+--- @param plan table From build_plan()
+--- @return string
+function M.describe_plan(plan)
+  local s = plan.summary
+  local lines = {
+    string.format('%s: %d cop%s of %d region(s), %.1f s.', plan.label, s.copies,
+      s.copies == 1 and 'y' or 'ies', #plan.sources, s.length),
+    string.format('Writes %d item(s), %d envelope point(s), %d tempo marker(s), %d region(s).',
+      s.items, s.points, s.tempo, s.regions),
+  }
+  if s.moved_items > 0 then
+    lines[#lines + 1] = string.format('Moves %d item(s) after the cursor.', s.moved_items)
+  end
+  return table.concat(lines, '\n')
+end
 
-        -- Duplicate items
-        duplicate_items_to_position(items_in_region, time_offset)
+local Job = {}
+Job.__index = Job
 
-        -- Copy tempo markers
-        copy_tempo_markers(proj, region.start, region['end'], time_offset)
+--- Start applying a plan (nothing runs until step())
+--- @param plan table From build_plan()
+--- @param proj userdata|nil Project the plan was made from (0/nil for current)
+--- @return table job
+function M.apply_plan(plan, proj)
+  if not proj or proj == 0 then
+    proj = reaper.EnumProjects(-1)
+  end
+  return setmetatable({
+    plan = plan,
+    proj = proj,
+    state = 'running',      -- 'running', 'done' or 'cancelled'
+    error = nil,            -- Why the job stopped early (stale project state)
+    stage = 'read',
+    sources = {},
+    next_source = 1,
+    next_copy = 1,
+    splits = {},            -- Crop keeps its splits (the crop removes the leftovers)
+    silenced = false,
+    sorted_envelopes = {},
+    region_numbers = {},
+    dest = { proj = proj, created = { items = {}, envelopes = {} } },
+    units_done = 0,
+    units_total = #plan.sources + #plan.copies + 1,
+  }, Job)
+end
 
-        -- Copy envelope points
-        copy_envelope_points(proj, region.start, region['end'], time_offset)
+--- Fraction of the work done (0..1)
+function Job:progress()
+  return self.units_done / self.units_total
+end
 
-        -- Store region for creation
-        regions_to_create[#regions_to_create + 1] = {
-          start = current_position,
-          ['end'] = current_position + region_length,
-          name = region.name,
-          color = region.color
-        }
+--- Short description of the current stage
+function Job:status()
+  if self.stage == 'read' then
+    return string.format('Reading region %d/%d', math.min(self.next_source, #self.plan.sources), #self.plan.sources)
+  elseif self.stage == 'write' then
+    return string.format('Writing copy %d/%d', math.min(self.next_copy, #self.plan.copies), #self.plan.copies)
+  end
+  return self.state == 'cancelled' and 'Cancelled' or 'Finishing'
+end
 
-        current_position = current_position + region_length
-      end
-    end
+function Job:_read_next()
+  local plan, proj = self.plan, self.proj
+  local region = plan.sources[self.next_source]
+  local span = Trace.begin('region_ops', 'read_source', 'rid', region.rid)
+  self.track_envelopes = self.track_envelopes or list_track_envelopes(proj)
+
+  -- Tempo sources are read with the first region, before any change
+  self.tempo_markers = self.tempo_markers or read_tempo_batch(proj, plan.tempo)
+
+  local splits = {}
+  self.sources[region] = read_region_source(proj, region.start, region['end'], self.track_envelopes, splits)
+  if plan.crop then
+    table.move(splits, 1, #splits, #self.splits + 1, self.splits)
+  else
+    M.unsplit_items(splits)  -- Source is in memory: put the pieces back
   end
 
-  local playlist_end = current_position
+  self.next_source = self.next_source + 1
+  if self.next_source > #plan.sources then
+    self.stage = 'write'
+  end
+  Trace.finish(span, 'splits', #splits)
+end
 
-  -- Set time selection to playlist range
-  reaper.GetSet_LoopTimeRange(true, false, 0, playlist_end, false)
+function Job:_write_next()
+  local plan, proj = self.plan, self.proj
+  -- Sources were read before the gap opens, at their original positions
+  if plan.silence and not self.silenced then
+    local silence_span = Trace.begin('region_ops', 'insert_silence', 'length', plan.silence.length)
+    insert_silence(proj, plan.silence.position, plan.silence.length)
+    self.silenced = true
+    Trace.finish(silence_span)
+  end
 
-  -- Crop project to time selection
-  reaper.Main_OnCommand(40289, 0) -- Item: Remove items/tracks/envelope points/markers/regions/... Time selection
+  local copy = plan.copies[self.next_copy]
+  local span = Trace.begin('region_ops', 'write_copy', 'copy', self.next_copy, 'rid', copy.block.region.rid)
+  write_source_copies(self.dest, self.sources[copy.block.region], { copy.offset }, self.sorted_envelopes)
+  if not plan.crop then
+    local region = plan.regions[self.next_copy]
+    self.region_numbers[#self.region_numbers + 1] = reaper.AddProjectMarker2(proj, true, region.start,
+      region['end'], region.name or '', -1, region.color and Colors.RgbaToReaperNative(region.color) or 0)
+  end
 
-  -- Create region markers
-  for _, rgn in ipairs(regions_to_create) do
-    local native_color = rgn.color and Colors.RgbaToReaperNative(rgn.color) or 0
+  self.next_copy = self.next_copy + 1
+  if self.next_copy > #plan.copies then
+    self.stage = 'finish'
+  end
+  Trace.finish(span)
+end
 
-    reaper.AddProjectMarker2(proj, true, rgn.start, rgn['end'], rgn.name or '', -1, native_color)
+function Job:_finish()
+  local plan, proj = self.plan, self.proj
+  local span = Trace.begin('region_ops', 'finish', 'mode', plan.mode)
+  for envelope in pairs(self.sorted_envelopes) do
+    reaper.Envelope_SortPoints(envelope)
+  end
+  write_tempo_batch(proj, expand_tempo(self.tempo_markers or {}, plan.tempo))
+
+  if plan.crop then
+    reaper.Undo_BeginBlock2(proj)
+    reaper.GetSet_LoopTimeRange2(proj, true, false, plan.crop[1], plan.crop[2], false)
+    reaper.Main_OnCommandEx(40289, 0, proj) -- Item: Remove items/tracks/envelope points/markers/regions/... Time selection
+    for _, region in ipairs(plan.regions) do
+      reaper.AddProjectMarker2(proj, true, region.start, region['end'], region.name or '', -1,
+        region.color and Colors.RgbaToReaperNative(region.color) or 0)
+    end
+    reaper.GetSet_LoopTimeRange2(proj, true, false, 0, 0, false)
+    reaper.SetEditCurPos2(proj, 0, false, false)
+    reaper.Undo_EndBlock2(proj, plan.label, -1)
+  else
+    -- Earlier steps made no undo points: this one covers all of them
+    -- (all flags: tempo, envelopes and regions as well as items)
+    reaper.Undo_OnStateChangeEx2(proj, plan.label, -1, -1)
   end
+  self.state = 'done'
+  Trace.finish(span)
+end
 
-  -- Clear time selection
-  reaper.GetSet_LoopTimeRange(true, false, 0, 0, false)
-  reaper.SetEditCurPos(0, false, false)
+-- First project object the job holds that was deleted since it was stored
+function Job:_stale()
+  local proj = self.proj
+  if not reaper.ValidatePtr2(0, proj, 'ReaProject*') then
+    return 'project closed'
+  end
+  for _, envelope in ipairs(self.track_envelopes or {}) do
+    if not reaper.ValidatePtr2(proj, envelope, 'TrackEnvelope*') then return 'envelope deleted' end
+  end
+  for _, source in pairs(self.sources) do
+    for _, src in ipairs(source.items) do
+      if not reaper.ValidatePtr2(proj, src.track, 'MediaTrack*') then return 'track deleted' end
+    end
+  end
+  for _, split in ipairs(self.splits) do
+    if not reaper.ValidatePtr2(proj, split.item, 'MediaItem*')
+        or not reaper.ValidatePtr2(proj, split.right, 'MediaItem*') then
+      return 'item deleted'
+    end
+  end
+  for _, item in ipairs(self.dest.created.items) do
+    if not reaper.ValidatePtr2(proj, item, 'MediaItem*') then return 'item deleted' end
+  end
+  return nil
+end
+
+--- Run work units until the time budget is used up or the job ends
+--- @param budget number|nil Seconds (nil runs to completion)
+--- @return boolean finished True once done or cancelled
+function Job:step(budget)
+  if self.state ~= 'running' then
+    return true
+  end
+  local stale = self:_stale()
+  if stale then
+    self.error = 'Project changed while the operation ran (' .. stale .. ')'
+    self:cancel()
+    return true
+  end
+  local deadline = budget and reaper.time_precise() + budget
+  local span = Trace.begin('region_ops', 'step', 'stage', self.stage)
+  local units_before = self.units_done
 
-  reaper.Undo_EndBlock('Crop project to playlist', -1)
+  reaper.PreventUIRefresh(1)
+  repeat
+    if self.stage == 'read' and self.next_source <= #self.plan.sources then
+      self:_read_next()
+    elseif self.stage ~= 'finish' and self.next_copy <= #self.plan.copies then
+      self.stage = 'write'
+      self:_write_next()
+    else
+      self:_finish()
+    end
+    self.units_done = self.units_done + 1
+  until self.state ~= 'running' or (deadline and reaper.time_precise() >= deadline)
   reaper.PreventUIRefresh(-1)
   reaper.UpdateArrange()
+  Trace.finish(span, 'units', self.units_done - units_before)
 
-  return true
+  return self.state ~= 'running'
 end
 
---- Crop playlist to new project tab (SWS-style with undo trick)
---- @param playlist_items table Array of {rid, reps} objects
---- @param playlist_name string Name of the playlist to recreate
---- @param playlist_chip_color number Chip color of the playlist
---- @return boolean success
-function M.crop_to_playlist_new_tab(playlist_items, playlist_name, playlist_chip_color)
-  if not playlist_items or #playlist_items == 0 then
-    return false
+--- Stop the job and roll back what it wrote (no-op once finished)
+--- Objects deleted meanwhile are skipped; a closed project is left alone.
+function Job:cancel()
+  if self.state ~= 'running' then
+    return
   end
-
-  -- First, build the playlist in current project using crop_to_playlist logic
-  local proj = 0
-  local Regions = require('arkitekt.reaper.regions')
+  local proj, created = self.proj, self.dest.created
+  if not reaper.ValidatePtr2(0, proj, 'ReaProject*') then
+    self.state = 'cancelled'
+    return
+  end
+  local span = Trace.begin('region_ops', 'cancel', 'copies', self.next_copy - 1)
 
   reaper.PreventUIRefresh(1)
-  reaper.Undo_BeginBlock()
-
-  -- Build playlist content at position 0
-  local current_position = 0
-  local regions_to_create = {}
+  for i = #self.region_numbers, 1, -1 do
+    reaper.DeleteProjectMarker(proj, self.region_numbers[i], true)
+  end
+  for i = #created.items, 1, -1 do
+    local item = created.items[i]
+    if reaper.ValidatePtr2(proj, item, 'MediaItem*') then
+      reaper.DeleteTrackMediaItem(reaper.GetMediaItem_Track(item), item)
+    end
+  end
 
-  for _, pl_item in ipairs(playlist_items) do
-    local rid = pl_item.rid
-    local reps = pl_item.reps or 1
+  -- Unsorted inserts were appended after each envelope's original points
+  for envelope, base_count in pairs(created.envelopes) do
+    if reaper.ValidatePtr2(proj, envelope, 'TrackEnvelope*') then
+      for k = reaper.CountEnvelopePoints(envelope) - 1, base_count, -1 do
+        reaper.DeleteEnvelopePointEx(envelope, -1, k)
+      end
+    end
+  end
 
-    local region = Regions.get_region_by_rid(proj, rid)
-    if region then
-      local region_length = region['end'] - region.start
+  if self.silenced then
+    local silence = self.plan.silence
+    insert_silence(proj, silence.position + silence.length, -silence.length)
+  end
+  local splits = {}
+  for _, split in ipairs(self.splits) do
+    if reaper.ValidatePtr2(proj, split.item, 'MediaItem*') and reaper.ValidatePtr2(proj, split.right, 'MediaItem*') then
+      splits[#splits + 1] = split
+    end
+  end
+  M.unsplit_items(splits)
 
-      -- Split items in this region
-      local items_in_region = split_items_in_region(proj, region.start, region['end'])
+  self.state = 'cancelled'
+  reaper.PreventUIRefresh(-1)
+  reaper.UpdateArrange()
+  Trace.finish(span)
+end
 
-      -- Duplicate for each rep
-      for rep = 1, reps do
-        local time_offset = current_position - region.start
+-- ============================================================================
+-- PUBLIC API - MATCHING SWS BEHAVIOR
+-- ============================================================================
 
-        -- Duplicate items
-        duplicate_items_to_position(items_in_region, time_offset)
+--- Append playlist to the end of the project
+--- @param playlist_items table Array of {rid, reps} objects
+--- @return boolean success
+function M.append_playlist_to_project(playlist_items)
+  if not playlist_items or #playlist_items == 0 then
+    return false
+  end
 
-        -- Copy tempo markers
-        copy_tempo_markers(proj, region.start, region['end'], time_offset)
+  M.apply_plan(M.plan_playlist('append', playlist_items)):step()
+  return true
+end
 
-        -- Copy envelope points
-        copy_envelope_points(proj, region.start, region['end'], time_offset)
+--- Paste playlist at edit cursor (later material moves back to make room)
+--- @param playlist_items table Array of {rid, reps} objects
+--- @return boolean success
+function M.paste_playlist_at_cursor(playlist_items)
+  if not playlist_items or #playlist_items == 0 then
+    return false
+  end
 
-        -- Store region for creation (preserving original RID!)
-        regions_to_create[#regions_to_create + 1] = {
-          start = current_position,
-          ['end'] = current_position + region_length,
-          name = region.name,
-          color = region.color,
-          rid = rid,  -- CRITICAL: Store original RID for playlist recreation
-          reps = reps  -- Store reps for playlist recreation
-        }
+  M.apply_plan(M.plan_playlist('paste', playlist_items)):step()
+  return true
+end
 
-        current_position = current_position + region_length
-      end
-    end
+--- Crop project to playlist
+--- @param playlist_items table Array of {rid, reps} objects
+--- @return boolean success
+function M.crop_to_playlist(playlist_items)
+  if not playlist_items or #playlist_items == 0 then
+    return false
   end
 
-  -- Store master track state
-  local master_track = reaper.GetMasterTrack(proj)
-  local _, master_chunk = reaper.GetTrackStateChunk(master_track, '', false)
+  M.apply_plan(M.plan_playlist('crop', playlist_items)):step()
+  return true
+end
 
-  -- Select and copy all tracks
-  reaper.Main_OnCommand(40296, 0) -- Track: Select all tracks
-  reaper.Main_OnCommand(40210, 0) -- Track: Copy selected tracks
+--- Crop playlist to a new project tab
+--- The cropped track, item, region and tempo state is written straight into
+--- the new tab: the source project is read (and left as it was) instead of
+--- being cropped and undone, and the clipboard is never touched. Tracks keep
+--- their FX, routing and envelope settings; items and automation come from
+--- the playlist layout. Regions keep their numbers, so a copy of the
+--- playlist stays valid in the new tab.
+--- @param playlist_items table Array of {rid, reps} objects
+--- @return userdata|nil new_proj The new project tab (nil if nothing to crop)
+function M.crop_to_playlist_new_tab(playlist_items)
+  if not playlist_items or #playlist_items == 0 then
+    return nil
+  end
 
-  reaper.PreventUIRefresh(-1)
+  local src_proj = reaper.EnumProjects(-1)
+  local blocks = layout_blocks(index_regions(src_proj), playlist_items, 0)
+  if #blocks == 0 then
+    return nil
+  end
 
-  -- Undo trick: end block and undo to restore original project
-  reaper.Undo_EndBlock('Crop playlist to new tab', -1)
-  reaper.Undo_DoUndo2(0)
+  reaper.PreventUIRefresh(1)
+
+  local span = Trace.begin('region_ops', 'read_sources', 'blocks', #blocks)
+  local sources = read_block_sources(src_proj, blocks, true)
+  local tempo_markers = read_tempo_batch(src_proj, tempo_ranges(blocks))
+  Trace.finish(span)
+
+  -- Track state without items/envelope points (the layout writes those)
+  local src_master = reaper.GetMasterTrack(src_proj)
+  local _, master_chunk = reaper.GetTrackStateChunk(src_master, '', false)
+  master_chunk = strip_track_chunk(master_chunk)
+  local src_tracks, track_chunks = {}, {}
+  for i = 0, reaper.CountTracks(src_proj) - 1 do
+    local track = reaper.GetTrack(src_proj, i)
+    local _, chunk = reaper.GetTrackStateChunk(track, '', false)
+    src_tracks[i + 1] = track
+    track_chunks[i + 1] = strip_track_chunk(chunk)
+  end
 
   -- Create new project tab with EMPTY project (no template)
   reaper.Main_OnCommand(41929, 0) -- File: New project tab (ignore default template)
+  local new_proj = reaper.EnumProjects(-1)
 
   reaper.Undo_BeginBlock()
-  reaper.PreventUIRefresh(1)
-
-  -- Paste tracks
-  reaper.Main_OnCommand(40058, 0) -- Track: Paste tracks/items
-  reaper.Main_OnCommand(40297, 0) -- Track: Unselect all tracks
 
-  -- Restore master track
-  local new_master = reaper.GetMasterTrack(0)
+  local dest = { proj = new_proj, tracks = {}, envelopes = {} }
+  local new_master = reaper.GetMasterTrack(new_proj)
   reaper.SetTrackStateChunk(new_master, master_chunk, false)
-
-  -- Create region markers with PRESERVED region numbers
-  local region_rid_map = {}  -- Track which RID appears at which position for playlist
-  for idx, rgn in ipairs(regions_to_create) do
-    local native_color = 0
-    if rgn.color then
-      local r = (rgn.color >> 24) & 0xFF
-      local g = (rgn.color >> 16) & 0xFF
-      local b = (rgn.color >> 8) & 0xFF
-      native_color = reaper.ColorToNative(r, g, b) | 0x1000000
-    end
-
-    -- Use the original RID (markrgnindexnumber) instead of -1 to preserve region numbers
-    reaper.AddProjectMarker2(0, true, rgn.start, rgn['end'], rgn.name or '', rgn.rid, native_color)
-
-    -- Track this region for playlist creation
-    if not region_rid_map[rgn.rid] then
-      region_rid_map[rgn.rid] = {rid = rgn.rid, reps = rgn.reps}
-    end
+  map_track(dest, src_master, new_master)
+  for i, chunk in ipairs(track_chunks) do
+    reaper.InsertTrackAtIndex(i - 1, false)
+    local track = reaper.GetTrack(new_proj, i - 1)
+    reaper.SetTrackStateChunk(track, chunk, false)
+    map_track(dest, src_tracks[i], track)
   end
 
-  reaper.PreventUIRefresh(-1)
+  span = Trace.begin('region_ops', 'write_blocks', 'blocks', #blocks)
+  write_blocks(dest, blocks, sources, tempo_markers)
+  add_block_regions(new_proj, blocks, true)
+  Trace.finish(span)
+
   reaper.Undo_EndBlock('Crop playlist to new tab', -1)
+  reaper.PreventUIRefresh(-1)
   reaper.UpdateArrange()
 
-  -- Now recreate the playlist in the new project tab
-  local State = require('RegionPlaylist.core.app_state')
-  local UUID = require('arkitekt.core.uuid')
-
-  -- Create new playlist with the same name
-  local new_playlist = {
-    id = UUID.generate(),
-    name = playlist_name or 'Cropped Playlist',
-    items = {},
-    chip_color = playlist_chip_color
-  }
-
-  -- Rebuild playlist items with the preserved RIDs
-  for _, pl_item in ipairs(playlist_items) do
-    new_playlist.items[#new_playlist.items + 1] = {
-      type = 'region',
-      rid = pl_item.rid,  -- RID is preserved since we used it when creating regions
-      reps = pl_item.reps or 1,
-      enabled = true,
-      key = UUID.generate()
-    }
-  end
-
-  -- Add playlist to state
-  local playlists = State.get_playlists()
-  playlists[#playlists + 1] = new_playlist
-  State.set_active_playlist(new_playlist.id)
-  State.persist()  -- Save to project
-
-  return true
+  return new_proj
 end
 
 return M
@@ -0,0 +1,114 @@
+-- @noindex
+-- Arkitekt/reaper/render_queue.lua
+-- Render time ranges of a project through REAPER's render queue
+--
+-- queue() points the render bounds and output file at one range and adds
+-- the project to the render queue (41823); render() runs the queue (41207),
+-- which renders the entries in the order they were added. The render
+-- settings changed for queueing are restored right after, so items,
+-- regions and settings of the project are left as they were. Ranges render
+-- the master mix without tail, so consecutive parts butt-join. The output
+-- format is the project's own.
+--
+-- 41207 renders every queued entry, not only ours, so queue() refuses to
+-- start while REAPER's queue (QueuedRenders in the resource path) already
+-- holds renders the user added.
+
+local M = {}
+
+-- Render settings changed while queueing (restored after each entry)
+local NUMBER_SETTINGS = {
+  'RENDER_SETTINGS', 'RENDER_BOUNDSFLAG', 'RENDER_STARTPOS', 'RENDER_ENDPOS',
+  'RENDER_TAILFLAG', 'RENDER_ADDTOPROJ',
+}
+local STRING_SETTINGS = { 'RENDER_FILE', 'RENDER_PATTERN' }
+
+local Queue = {}
+Queue.__index = Queue
+
+--- Create a render queue for a project
+--- @param proj number|nil Project (0 for current)
+--- @return table queue
+function M.new(proj)
+  return setmetatable({ proj = proj or 0, count = 0 }, Queue)
+end
+
+--- Renders waiting in REAPER's render queue
+--- @return number count
+function M.pending_count()
+  local dir = reaper.GetResourcePath() .. '/QueuedRenders'
+  local count = 0
+  while reaper.EnumerateFiles(dir, count) do
+    count = count + 1
+  end
+  return count
+end
+
+--- Whether the project renders to WAV (no format set means WAV too)
+--- @param proj number|nil Project (0 for current)
+--- @return boolean
+function M.renders_wav(proj)
+  local _, format = reaper.GetSetProjectInfo_String(proj or 0, 'RENDER_FORMAT', '', false)
+  -- Base64 sink config; WAV configs start with 'evaw'
+  return format == '' or format:sub(1, 6) == 'ZXZhdw'
+end
+
+--- Queue one time range, rendered to path
+--- @param range table {start, end}
+--- @param path string Output file (directory and name are taken from it)
+--- @return boolean ok
+--- @return string|nil error
+function Queue:queue(range, path)
+  if self.count == 0 then
+    local pending = M.pending_count()
+    if pending > 0 then
+      return false, string.format(
+        'The render queue already holds %d render(s); render or clear them first (File > Render queue)', pending)
+    end
+  end
+
+  local proj = self.proj
+  local saved_numbers, saved_strings = {}, {}
+  for _, key in ipairs(NUMBER_SETTINGS) do
+    saved_numbers[key] = reaper.GetSetProjectInfo(proj, key, 0, false)
+  end
+  for _, key in ipairs(STRING_SETTINGS) do
+    local _, value = reaper.GetSetProjectInfo_String(proj, key, '', false)
+    saved_strings[key] = value
+  end
+
+  local dir, name = path:match('^(.*)[/\\]([^/\\]-)%.%w+$')
+  reaper.GetSetProjectInfo(proj, 'RENDER_SETTINGS', 0, true)      -- Master mix
+  reaper.GetSetProjectInfo(proj, 'RENDER_BOUNDSFLAG', 0, true)    -- Custom time bounds
+  reaper.GetSetProjectInfo(proj, 'RENDER_STARTPOS', range.start, true)
+  reaper.GetSetProjectInfo(proj, 'RENDER_ENDPOS', range['end'], true)
+  reaper.GetSetProjectInfo(proj, 'RENDER_TAILFLAG', 0, true)
+  reaper.GetSetProjectInfo(proj, 'RENDER_ADDTOPROJ', 0, true)
+  reaper.GetSetProjectInfo_String(proj, 'RENDER_FILE', dir or '', true)
+  reaper.GetSetProjectInfo_String(proj, 'RENDER_PATTERN', name or path, true)
+
+  reaper.Main_OnCommand(41823, 0) -- File: Add project to render queue, using the most recent render settings
+
+  for key, value in pairs(saved_numbers) do
+    reaper.GetSetProjectInfo(proj, key, value, true)
+  end
+  for key, value in pairs(saved_strings) do
+    reaper.GetSetProjectInfo_String(proj, key, value, true)
+  end
+  self.count = self.count + 1
+  return true
+end
+
+--- Render the queued ranges (blocks until the queue is done)
+--- @return boolean ok
+--- @return string|nil error
+function Queue:render()
+  if self.count == 0 then
+    return false, 'Render queue is empty'
+  end
+  reaper.Main_OnCommand(41207, 0) -- File: Render all queued renders
+  self.count = 0
+  return true
+end
+
+return M
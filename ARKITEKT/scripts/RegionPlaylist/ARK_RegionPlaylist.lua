@@ -58,6 +58,14 @@ local function load_tests()
   if not ok then
     Logger.warn('TEST', 'Failed to load integration tests: %s', tostring(err))
   end
+
+  -- Load benchmarks (pure Lua, timings logged to console)
+  ok, err = pcall(function()
+    require('RegionPlaylist.tests.benchmarks')
+  end)
+  if not ok then
+    Logger.warn('TEST', 'Failed to load benchmarks: %s', tostring(err))
+  end
 end
 load_tests()
 
@@ -70,6 +78,7 @@ Shell.run({
   version      = 'v0.1.0',
   app_name     = 'RegionPlaylist',  -- For per-app theme overrides
   draw         = function(ctx, shell_state) gui:draw(ctx, shell_state.window, shell_state) end,
+  on_close     = function() gui:close() end,
   settings     = settings,
   initial_pos  = { x = 120, y = 120 },
   initial_size = { w = 1000, h = 700 },
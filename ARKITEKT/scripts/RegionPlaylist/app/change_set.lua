@@ -0,0 +1,59 @@
+-- @noindex
+-- RegionPlaylist/app/change_set.lua
+-- Accumulated change mask for coalesced UI refreshes
+--
+-- PURPOSE:
+-- Mutations happen from many places (controller commits, region edits in
+-- REAPER, undo/redo, preference setters). Instead of each one refreshing the
+-- UI on the spot, producers mark what changed and the GUI consumes the mask
+-- once per frame, refreshing only the widgets that depend on those bits.
+-- Marking the same bit many times in a frame costs one refresh.
+--
+-- BITS:
+--   PLAYLISTS  Playlist set changed (add/remove/rename/recolor/reorder/active)
+--   ITEMS      Items inside playlists changed
+--   REGIONS    Project regions changed (names, bounds, colors, count)
+--   POOL_VIEW  Pool search/sort/mode/order changed
+--
+-- Transport state is not tracked here: it moves every frame and is already
+-- resolved once per frame by the tile renderers (ActiveTile.begin_frame).
+
+local M = {}
+
+M.PLAYLISTS = 1
+M.ITEMS     = 2
+M.REGIONS   = 4
+M.POOL_VIEW = 8
+M.ALL       = 15
+
+local ChangeSet = {}
+ChangeSet.__index = ChangeSet
+
+--- Create a change set (starts fully dirty so the first frame builds everything)
+--- @return table change_set
+function M.new()
+  return setmetatable({ mask = M.ALL }, ChangeSet)
+end
+
+--- Mark bits as changed
+--- @param bits number Bitwise OR of change flags
+function ChangeSet:mark(bits)
+  self.mask = self.mask | bits
+end
+
+--- Check pending bits without consuming them
+--- @param bits number Flags to test
+--- @return boolean
+function ChangeSet:has(bits)
+  return self.mask & bits ~= 0
+end
+
+--- Consume and clear the accumulated mask
+--- @return number mask
+function ChangeSet:take()
+  local mask = self.mask
+  self.mask = 0
+  return mask
+end
+
+return M
@@ -5,6 +5,7 @@
 
 local Ark = require('arkitekt')
 local Logger = require('arkitekt.debug.logger')
+local PlaylistDomain = require('RegionPlaylist.domain.playlist')
 
 local M = {}
 local Controller = {}
@@ -20,6 +21,9 @@ function M.new(state_module, settings, undo_manager)
     state = state_module,
     settings = settings,
     undo = undo_manager,
+    -- Merge adjacent duplicates at mutation sites (opt-in)
+    auto_compact = settings and settings:get('auto_compact') or false,
+    _touched = {},  -- Playlists handed out since the last undoable operation
   }, Controller)
   
   return ctrl
@@ -36,6 +40,9 @@ end
 function Controller:_with_undo(fn)
   self.state.capture_undo_snapshot()
   local success, result = pcall(fn)
+  -- Playlists handed out may have been edited (even on failure): drop their
+  -- shared undo copies so the next snapshot re-copies only those
+  self:_flush_touched()
   if success then
     self:_commit()
     return true, result
@@ -45,7 +52,85 @@ function Controller:_with_undo(fn)
 end
 
 function Controller:_get_playlist(id)
-  return self.state.get_playlist_by_id(id)
+  local pl = self.state.get_playlist_by_id(id)
+  if pl then
+    self._touched[#self._touched + 1] = pl
+  end
+  return pl
+end
+
+function Controller:_flush_touched()
+  local touched = self._touched
+  if #touched > 0 then
+    self.state.mark_playlists_dirty(touched)
+    self._touched = {}
+  end
+end
+
+-- Drop keys merged away by compaction from `keys` (the caller's return value)
+local function prune_keys(keys, removed)
+  if #removed == 0 or not keys then return end
+
+  local gone = {}
+  for _, k in ipairs(removed) do gone[k] = true end
+  local w = 0
+  for r = 1, #keys do
+    if not gone[keys[r]] then
+      w = w + 1
+      keys[w] = keys[r]
+    end
+  end
+  for i = #keys, w + 1, -1 do keys[i] = nil end
+end
+
+--- Compact around a touched range when auto-compaction is on
+--- @param pl table Playlist
+--- @param first number First touched index
+--- @param last number Last touched index
+--- @param keys table|nil New item keys to prune
+function Controller:_compact_range(pl, first, last, keys)
+  if not self.auto_compact then return end
+  prune_keys(keys, PlaylistDomain.compact_range(pl.items, first, last))
+end
+
+--- Compact around touched items (see PlaylistDomain.compact_around) when
+--- auto-compaction is on
+--- @param pl table Playlist
+--- @param touched table Items whose neighbours or values changed
+--- @param keys table|nil New item keys to prune
+function Controller:_compact_around(pl, touched, keys)
+  if not self.auto_compact then return end
+  prune_keys(keys, PlaylistDomain.compact_around(pl.items, touched))
+end
+
+function Controller:set_auto_compact(enabled)
+  self.auto_compact = enabled and true or false
+  if self.settings then
+    self.settings:set('auto_compact', self.auto_compact)
+  end
+end
+
+--- Switch the saved playlist format (compact block or JSON) and re-save
+--- @param enabled boolean
+function Controller:set_compact_storage(enabled)
+  self.state.set_compact_storage(enabled)
+  if self.settings then
+    self.settings:set('compact_storage', enabled and true or false)
+  end
+end
+
+--- Merge adjacent duplicates across a whole playlist (single undo entry)
+--- @param playlist_id string Playlist UUID
+--- @return boolean success
+--- @return number|string merged Number of items merged away (or error)
+function Controller:normalize_playlist(playlist_id)
+  local pl = self:_get_playlist(playlist_id)
+  if not pl then
+    return false, 'Playlist not found'
+  end
+  return self:_with_undo(function()
+    return #PlaylistDomain.normalize(pl.items)
+  end)
 end
 
 function Controller:_generate_playlist_id()
@@ -365,12 +450,15 @@ function Controller:delete_playlist(id)
       self.state.set_active_playlist(playlists[new_active_index].id)
     end
     
+    -- Nested references may live in any playlist
+    self.state.mark_playlists_dirty(playlists)
     for _, pl in ipairs(playlists) do
       local i = 1
       while i <= #pl.items do
         local item = pl.items[i]
         if item.type == 'playlist' and item.playlist_id == id then
           table.remove(pl.items, i)
+          PlaylistDomain.forget_index(pl.items)
         else
           i = i + 1
         end
@@ -379,6 +467,36 @@ function Controller:delete_playlist(id)
   end)
 end
 
+--- Append prepared playlists (e.g. a library import) as one undo step
+--- Names that already exist get a ' Copy' suffix; the first one becomes active.
+--- @param new_playlists table Array of playlists with fresh ids and keys
+--- @return boolean success
+--- @return number|string count Number of playlists added (or error)
+function Controller:import_playlists(new_playlists)
+  if not new_playlists or #new_playlists == 0 then
+    return false, 'Nothing to import'
+  end
+
+  return self:_with_undo(function()
+    local playlists = self.state.get_playlists()
+    local names = {}
+    for _, pl in ipairs(playlists) do
+      names[pl.name] = true
+    end
+
+    for _, pl in ipairs(new_playlists) do
+      if names[pl.name] then
+        pl.name = self:_generate_unique_name(pl.name)
+      end
+      names[pl.name] = true
+      playlists[#playlists + 1] = pl
+    end
+
+    self.state.set_active_playlist(new_playlists[1].id)
+    return #new_playlists
+  end)
+end
+
 function Controller:reorder_playlists(from_idx, to_idx)
   if from_idx == to_idx then
     return true
@@ -414,8 +532,11 @@ function Controller:add_item(playlist_id, rid, insert_index)
     }
 
     -- Use table.insert for positional insert (3 args), not optimization
-    table.insert(pl.items, insert_index or (#pl.items + 1), new_item)
-    return new_item.key
+    local idx = insert_index or (#pl.items + 1)
+    table.insert(pl.items, idx, new_item)
+    local keys = { new_item.key }
+    self:_compact_range(pl, idx, idx, keys)
+    return keys[1]
   end)
 end
 
@@ -474,6 +595,7 @@ function Controller:add_items_batch(playlist_id, rids, insert_index)
       keys[#keys + 1] = new_item.key
     end
 
+    self:_compact_range(pl, idx, idx + #keys - 1, keys)
     return keys
   end)
 end
@@ -527,11 +649,12 @@ function Controller:add_mixed_items_batch(playlist_id, items, insert_index)
       end
 
       if new_item then
-        table.insert(pl.items, idx + i - 1, new_item)
+        table.insert(pl.items, idx + #keys, new_item)
         keys[#keys + 1] = new_item.key
       end
     end
 
+    self:_compact_range(pl, idx, idx + #keys - 1, keys)
     return keys
   end)
 end
@@ -572,6 +695,7 @@ function Controller:copy_items(playlist_id, items, insert_index)
       keys[#keys + 1] = new_item.key
     end
 
+    self:_compact_range(pl, idx, idx + #keys - 1, keys)
     return keys
   end)
 end
@@ -587,6 +711,70 @@ function Controller:reorder_items(playlist_id, new_order)
   end)
 end
 
+--- Move a selection as one block (single splice, single undo/commit)
+--- @param playlist_id string Playlist UUID
+--- @param item_keys table Keys to move, in drop order
+--- @param before_key string|nil Insert before this key (nil = append at end)
+--- @return boolean success
+--- @return boolean|string moved True if order changed (or error message)
+function Controller:move_items(playlist_id, item_keys, before_key)
+  local pl = self:_get_playlist(playlist_id)
+  if not pl then
+    return false, 'Playlist not found'
+  end
+
+  local new_items, touched = PlaylistDomain.plan_move(pl.items, item_keys, before_key)
+  if not new_items then
+    return true, false  -- Dropped in place: no undo entry, no resync
+  end
+
+  return self:_with_undo(function()
+    PlaylistDomain.apply_order(pl.items, new_items)
+    -- Only the dropped block and the gaps it left can create duplicates
+    self:_compact_around(pl, touched)
+    return true
+  end)
+end
+
+--- Apply a batch of edits as one transaction
+--- One undo entry, one persist, one sequence resync and one UI refresh,
+--- however many items the batch touches. See PlaylistDomain.apply_edits
+--- for the edit operations. Invalid batches are rejected before any change.
+--- @param playlist_id string Playlist UUID
+--- @param edits table Array of edit operations
+--- @return boolean success
+--- @return table|string keys Keys of inserted items (or error message)
+function Controller:edit_items(playlist_id, edits)
+  local pl = self:_get_playlist(playlist_id)
+  if not pl then
+    return false, 'Playlist not found'
+  end
+
+  local ok, err = PlaylistDomain.validate_edits(edits)
+  if not ok then
+    return false, err
+  end
+
+  ok, err = PlaylistDomain.validate_nested(playlist_id, edits,
+    function(id) return self:_get_playlist(id) ~= nil end,
+    self.state.detect_circular_reference)
+  if not ok then
+    return false, err
+  end
+
+  return self:_with_undo(function()
+    local keys, touched = PlaylistDomain.apply_edits(pl.items, edits, {
+      new_key = function() return self:_generate_item_key() end,
+      describe_region = function(rid)
+        local region = self.state.get_region_by_rid(rid)
+        if region then return region.guid, region.name end
+      end,
+    })
+    self:_compact_around(pl, touched, keys)
+    return keys
+  end)
+end
+
 function Controller:delete_items(playlist_id, item_keys)
   return self:_with_undo(function()
     local pl = self:_get_playlist(playlist_id)
@@ -600,13 +788,24 @@ function Controller:delete_items(playlist_id, item_keys)
     end
     
     local new_items = {}
+    local joins = {}
+    local prev_deleted = false
     for _, item in ipairs(pl.items) do
       if not keys_set[item.key] then
         new_items[#new_items + 1] = item
+        if prev_deleted then joins[#joins + 1] = #new_items end
+        prev_deleted = false
+      else
+        prev_deleted = true
       end
     end
     
     pl.items = new_items
+
+    -- Only the seams left by deleted runs can create new duplicates
+    for i = #joins, 1, -1 do
+      self:_compact_range(pl, joins[i], joins[i])
+    end
   end)
 end
 
@@ -617,11 +816,9 @@ function Controller:toggle_item_enabled(playlist_id, item_key, enabled)
       error('Playlist not found')
     end
 
-    for _, item in ipairs(pl.items) do
-      if item.key == item_key then
-        item.enabled = enabled
-        return
-      end
+    local idx = PlaylistDomain.find_item_index(pl.items, item_key)
+    if idx then
+      pl.items[idx].enabled = enabled
     end
   end)
 end
@@ -693,19 +890,18 @@ function Controller:cycle_repeats(playlist_id, item_key)
       error('Playlist not found')
     end
     
-    for _, item in ipairs(pl.items) do
-      if item.key == item_key then
-        local reps = item.reps or 1
-        if reps == 1 then
-          item.reps = 2
-        elseif reps == 2 then
-          item.reps = 4
-        elseif reps == 4 then
-          item.reps = 8
-        else
-          item.reps = 1
-        end
-        return
+    local idx = PlaylistDomain.find_item_index(pl.items, item_key)
+    local item = idx and pl.items[idx]
+    if item then
+      local reps = item.reps or 1
+      if reps == 1 then
+        item.reps = 2
+      elseif reps == 2 then
+        item.reps = 4
+      elseif reps == 4 then
+        item.reps = 8
+      else
+        item.reps = 1
       end
     end
   end)
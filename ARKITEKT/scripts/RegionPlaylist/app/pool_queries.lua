@@ -77,17 +77,34 @@ end
 -- =============================================================================
 
 -- Get filtered and sorted pool regions
--- @param params Table with: pool_order, region_index, search_filter, sort_mode, sort_dir
+-- @param params Table with: pool_order, region_index, search_filter, sort_mode, sort_dir,
+--               search_regions (optional function(query) -> rid set, from the region search index)
 -- @return Filtered and sorted list of regions
 function M.get_filtered_pool_regions(params)
   local result = {}
   local search = (params.search_filter or ''):lower()
 
+  -- Resolve the search once through the index instead of per region
+  local match_set
+  if search ~= '' and params.search_regions then
+    match_set = params.search_regions(search)
+  end
+
   -- Filter regions
   for _, rid in ipairs(params.pool_order) do
     local region = params.region_index[rid]
-    if region and region.name ~= '__TRANSITION_TRIGGER' and (search == '' or region.name:lower():find(search, 1, true)) then
-      result[#result + 1] = region
+    if region and region.name ~= '__TRANSITION_TRIGGER' then
+      local visible
+      if search == '' then
+        visible = true
+      elseif match_set then
+        visible = match_set[rid]
+      else
+        visible = region.name:lower():find(search, 1, true)
+      end
+      if visible then
+        result[#result + 1] = region
+      end
     end
   end
 
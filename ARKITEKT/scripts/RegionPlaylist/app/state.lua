@@ -70,6 +70,7 @@ local Dependency = require('RegionPlaylist.domain.dependency')
 local Playlist = require('RegionPlaylist.domain.playlist')
 local Overlap = require('RegionPlaylist.domain.overlap')
 local PoolQueries = require('RegionPlaylist.app.pool_queries')
+local ChangeSet = require('RegionPlaylist.app.change_set')
 local Logger = require('arkitekt.debug.logger')
 
 local M = {}
@@ -152,6 +153,10 @@ M.overlap_map_dirty = true                    -- Whether overlap map needs recom
 M.beyond_map = nil                            -- Map of rid -> true for regions beyond project end
 M.beyond_map_dirty = true                     -- Whether beyond map needs recomputation
 
+-- Coalesced UI refresh (producers mark, GUI consumes once per frame)
+M.changes = ChangeSet.new()                   -- Accumulated change mask
+M.last_tabs_signature = nil                   -- Detects playlist set changes on persist
+
 -- Event callbacks (set by GUI)
 M.on_state_restored = nil                     -- Called when undo/redo restores state
 M.on_repeat_cycle = nil                       -- Called when repeat count cycles
@@ -161,6 +166,7 @@ M.settings = nil                              -- Persistent UI settings
 
 function M.initialize(settings)
   M.settings = settings
+  RegionState.set_compact_encoding(settings and settings:get('compact_storage'))
 
   -- Initialize domains
   M.animation = Animation.new()
@@ -240,26 +246,78 @@ function M.load_project_state()
   M.playlist:set_active(saved_active or playlists[1].id)
 end
 
-function M.reload_project_data()
+--- Reload playlists (project switch/reload, or after an import)
+--- @param playlists table|nil Already-decoded playlists (skips reading project data)
+--- @param active_id string|nil Active playlist for `playlists` (default: first)
+function M.reload_project_data(playlists, active_id)
   if M.bridge and M.bridge.engine and M.bridge.engine.is_playing then
     M.bridge:stop()
   end
-  
-  M.load_project_state()
-  M.rebuild_dependency_graph()
-  M.refresh_regions()
-  M.bridge:invalidate_sequence()
-  M.bridge:get_sequence()
-  
-  M.undo_manager = UndoManager.new({ max_history = 50 })
-  
-  M.clear_pending()
-  
+
+  -- end_load() must run even if loading throws, or every later persist()
+  -- and sequence resync would stay deferred
+  M.begin_load()
+  local ok, err = xpcall(function()
+    if playlists and #playlists > 0 then
+      M.playlist:load_playlists(playlists)
+      M.playlist:set_active(active_id or playlists[1].id)
+      RegionState.save_active_playlist(M.playlist:get_active_id(), 0)
+    else
+      M.load_project_state()
+    end
+    M.rebuild_dependency_graph()
+    M.refresh_regions()
+    M.bridge:invalidate_sequence()
+
+    -- Fresh history for the new project, starting from its loaded state
+    UndoBridge.invalidate_all()
+    M.undo_manager = UndoManager.new({ max_history = 50 })
+    M.capture_undo_snapshot()
+
+    M.clear_pending()
+    M.mark_changed(ChangeSet.ALL)
+  end, debug.traceback)
+  M.end_load()
+  if not ok then
+    error(err, 0)
+  end
+
   if M.on_state_restored then
     M.on_state_restored()
   end
 end
 
+-- >>> LOAD BATCHING (BEGIN)
+-- While a load is in progress, persist() and sequence resyncs are deferred;
+-- end_load() runs each of them at most once. Loads may nest.
+
+M.load_depth = 0                              -- >0 while a load is in progress
+M.load_pending_persist = false                -- persist() was requested during load
+
+function M.begin_load()
+  M.load_depth = M.load_depth + 1
+end
+
+function M.is_loading()
+  return M.load_depth > 0
+end
+
+--- Finish a load: one persist (if requested) and one sequence resync
+function M.end_load()
+  M.load_depth = math.max(0, M.load_depth - 1)
+  if M.load_depth > 0 then return end
+
+  if M.load_pending_persist then
+    M.load_pending_persist = false
+    M.persist()
+  end
+  if M.bridge then
+    M.bridge:get_sequence()
+  end
+end
+
+-- <<< LOAD BATCHING (END)
+
 -- >>> CANONICAL ACCESSORS (BEGIN)
 -- Single source of truth for state access - use these instead of direct field access
 
@@ -291,12 +349,17 @@ function M.get_region_index()
   return M.region:get_region_index()
 end
 
+function M.get_regions()
+  return M.region.regions or {}
+end
+
 function M.get_pool_order()
   return M.region:get_pool_order()
 end
 
 function M.set_pool_order(new_order)
   M.region:set_pool_order(new_order)
+  M.mark_changed(ChangeSet.POOL_VIEW)
 end
 
 function M.get_search_filter()
@@ -305,6 +368,7 @@ end
 
 function M.set_search_filter(text)
   M.ui_preferences:set_search_filter(text)
+  M.mark_changed(ChangeSet.POOL_VIEW)
 end
 
 function M.get_sort_mode()
@@ -313,6 +377,7 @@ end
 
 function M.set_sort_mode(mode)
   M.ui_preferences:set_sort_mode(mode)
+  M.mark_changed(ChangeSet.POOL_VIEW)
 end
 
 function M.get_sort_direction()
@@ -321,6 +386,7 @@ end
 
 function M.set_sort_direction(direction)
   M.ui_preferences:set_sort_direction(direction)
+  M.mark_changed(ChangeSet.POOL_VIEW)
 end
 
 function M.get_layout_mode()
@@ -337,6 +403,7 @@ end
 
 function M.set_pool_mode(mode)
   M.ui_preferences:set_pool_mode(mode)
+  M.mark_changed(ChangeSet.POOL_VIEW)
 end
 
 function M.get_pending_spawn()
@@ -535,11 +602,45 @@ function M.refresh_regions()
   M.region:refresh_from_bridge(regions)
   M.invalidate_overlap_map()
   M.invalidate_beyond_map()
+  M.mark_changed(ChangeSet.REGIONS)
+end
+
+--- Mark parts of the UI as stale (see app/change_set.lua for bits)
+--- @param bits number Bitwise OR of ChangeSet flags
+function M.mark_changed(bits)
+  M.changes:mark(bits)
+end
+
+--- Consume the change mask accumulated since the last call
+--- @return number mask
+function M.take_changes()
+  return M.changes:take()
+end
+
+-- Tabs only show id/name/color (+ active), so only those affect the tab bar
+local function _tabs_signature(playlists, active_id)
+  local parts = { tostring(active_id) }
+  for _, pl in ipairs(playlists) do
+    parts[#parts + 1] = pl.id .. '\31' .. tostring(pl.name) .. '\31' .. tostring(pl.chip_color)
+  end
+  return table.concat(parts, '\30')
 end
 
 function M.persist()
+  if M.load_depth > 0 then
+    M.load_pending_persist = true
+    return
+  end
   M.playlist:mark_changed()  -- Rebuild lookup table whenever playlists change
-  RegionState.save_playlists(M.playlist:get_all(), 0)
+  local playlists = M.playlist:get_all()
+  local signature = _tabs_signature(playlists, M.playlist:get_active_id())
+  if signature ~= M.last_tabs_signature then
+    M.last_tabs_signature = signature
+    M.mark_changed(ChangeSet.PLAYLISTS | ChangeSet.ITEMS)
+  else
+    M.mark_changed(ChangeSet.ITEMS)
+  end
+  RegionState.save_playlists(playlists, 0)
   RegionState.save_active_playlist(M.playlist:get_active_id(), 0)
   M.mark_graph_dirty()
   if M.bridge then
@@ -547,6 +648,13 @@ function M.persist()
   end
 end
 
+--- Switch the saved playlist encoding and re-save in the new format
+--- @param enabled boolean True for the compact block, false for JSON
+function M.set_compact_storage(enabled)
+  RegionState.set_compact_encoding(enabled)
+  RegionState.save_playlists(M.playlist:get_all(), 0)
+end
+
 function M.persist_ui_prefs()
   M.ui_preferences:save_to_settings()
 end
@@ -556,6 +664,14 @@ function M.capture_undo_snapshot()
   M.undo_manager:push(snapshot)
 end
 
+--- Report edited playlists so the next undo snapshot re-copies them
+--- @param playlists table Array of live playlists
+function M.mark_playlists_dirty(playlists)
+  for _, pl in ipairs(playlists) do
+    UndoBridge.mark_dirty(pl)
+  end
+end
+
 function M.clear_pending()
   M.animation:clear_all()
 end
@@ -639,7 +755,7 @@ function M.set_active_playlist(playlist_id, move_to_end)
   end
 
   M.persist()
-  if M.bridge then
+  if M.bridge and M.load_depth == 0 then
     M.bridge:get_sequence()
   end
 end
@@ -665,9 +781,19 @@ function M.get_filtered_pool_regions()
     search_filter = M.get_search_filter(),
     sort_mode = M.get_sort_mode(),
     sort_dir = M.get_sort_direction(),
+    search_regions = M.search_regions,
   })
 end
 
+--- Find regions by name substring or number prefix (indexed, any region count)
+--- @param query string Search text
+--- @param limit number|nil Maximum number of matches
+--- @return table matches Set of rid -> true
+--- @return number count Number of matches
+function M.search_regions(query, limit)
+  return M.region:search(query, limit)
+end
+
 function M.mark_graph_dirty()
   M.dependency:mark_dirty()
 end
@@ -739,9 +865,13 @@ function M.cleanup_deleted_regions()
   end
 
   for _, pl in ipairs(playlists) do
-    local i = 1
-    while i <= #pl.items do
-      local item = pl.items[i]
+    -- Single pass with a write index: removals never shift the tail
+    local items = pl.items
+    local n = #items
+    local w = 0
+    for r = 1, n do
+      local item = items[r]
+      local keep = true
       if item.type == 'region' then
         -- Try to resolve region: GUID → Name → RID
         local region = M.region:resolve_region(item.guid, item.rid, item.region_name)
@@ -779,23 +909,29 @@ function M.cleanup_deleted_regions()
             item.region_name = region.name
             updated_any = true
           end
-          i = i + 1
         else
           -- Region truly deleted - remove from playlist
           if DEBUG_CLEANUP then
             reaper.ShowConsoleMsg(string.format('    REMOVING (not found)\n'))
           end
-          table.remove(pl.items, i)
+          keep = false
           removed_any = true
           M.add_pending_destroy(item.key)
         end
-      else
-        i = i + 1
       end
+      if keep then
+        w = w + 1
+        items[w] = item
+      end
+    end
+    for i = n, w + 1, -1 do
+      items[i] = nil
     end
+    if w < n then Playlist.forget_index(items) end
   end
 
   if removed_any or updated_any then
+    UndoBridge.invalidate_all()
     M.persist()
   end
 
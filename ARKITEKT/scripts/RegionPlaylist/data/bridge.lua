@@ -69,11 +69,12 @@ local Engine = require('RegionPlaylist.domain.playback.controller')
 local Playback = require('RegionPlaylist.domain.playback.loop')
 local RegionState = require('RegionPlaylist.data.storage')
 local SequenceExpander = require('RegionPlaylist.domain.playback.expander')
+local MonitorFeed = require('RegionPlaylist.data.monitor_feed')
+local Recorder = require('RegionPlaylist.domain.playback.recorder')
+local TraceFile = require('RegionPlaylist.data.trace_file')
 local Logger = require('arkitekt.debug.logger')
 local Callbacks = require('arkitekt.core.callbacks')
-
--- Set to true for verbose sequence building debug logs
-local DEBUG_BRIDGE = false
+local Trace = require('arkitekt.debug.trace')
 
 -- Performance: Localize math functions for hot path (30% faster in loops)
 local max = math.max
@@ -146,6 +147,21 @@ function M.create(opts)
     RegionState.save_settings(saved_settings, bridge.proj)
   end
 
+  -- External display feed (opt-in: writes a small file while playing)
+  if saved_settings.monitor_feed then
+    bridge.monitor_feed = MonitorFeed.new({ path = saved_settings.monitor_feed_path })
+  end
+
+  -- Playback trace for offline replay (opt-in: ring file, see tools/trace_replay.lua)
+  if saved_settings.trace_record then
+    local writer, err = TraceFile.create(saved_settings.trace_record_path)
+    if writer then
+      bridge.engine:set_recorder(Recorder.new({ writer = writer }))
+    else
+      Logger.warn('BRIDGE', 'Trace recording disabled: %s', tostring(err))
+    end
+  end
+
   bridge.playback = Playback.new(bridge.engine, {
     on_region_change = opts.on_region_change,
     on_playback_start = opts.on_playback_start,
@@ -194,14 +210,13 @@ function M.create(opts)
     -- Don't rebuild sequence if we're currently playing
     -- This prevents the transport from switching playlists when user changes tabs during playback
     if is_playing and bridge._playing_playlist_id then
-      if DEBUG_BRIDGE then
-        Logger.debug('BRIDGE', 'Skipping sequence rebuild - currently playing playlist %s (active: %s)',
-          tostring(bridge._playing_playlist_id), tostring(active_playlist_id))
-      end
+      Trace.instant('bridge', 'rebuild_skipped', 'playing', tostring(bridge._playing_playlist_id),
+        'active', tostring(active_playlist_id))
       bridge.sequence_dirty = false
       return
     end
 
+    local span = Trace.begin('bridge', 'rebuild_sequence', 'playlist', tostring(active_playlist_id))
     local sequence = {}
 
     if playlist then
@@ -214,15 +229,9 @@ function M.create(opts)
     for idx, entry in ipairs(sequence) do
       if entry.item_key and not bridge.sequence_lookup[entry.item_key] then
         bridge.sequence_lookup[entry.item_key] = idx
-        if DEBUG_BRIDGE then Logger.debug('BRIDGE', "Mapping key '%s' -> idx %d", entry.item_key, idx) end
       end
     end
 
-    if DEBUG_BRIDGE then
-      Logger.debug('BRIDGE', 'Final sequence_lookup built with %d entries',
-        (function() local count = 0; for _ in pairs(bridge.sequence_lookup) do count = count + 1 end; return count end)())
-    end
-
     local previous_key = bridge._last_known_item_key or bridge.engine.state:get_current_item_key()
 
     bridge.engine:set_sequence(sequence)
@@ -277,6 +286,7 @@ function M.create(opts)
     if not is_playing then
       bridge._playing_playlist_id = active_playlist_id
     end
+    Trace.finish(span, 'items', #state_sequence)
   end
 
   function bridge:invalidate_sequence()
@@ -348,6 +358,9 @@ function M.create(opts)
     self:_ensure_sequence()
     self.playback:update()
     self:_emit_repeat_cycle_if_needed()
+    if self.monitor_feed then
+      self.monitor_feed:publish(self.engine)
+    end
   end
 
   function bridge:play()
@@ -442,6 +455,8 @@ function M.create(opts)
 
   --- Get keys of items that will be skipped due to scheduled transition
   --- Returns a set (table with key -> true) of item keys being skipped
+  --- Cached on (current_idx, next_idx, sequence_version): tile renderers query
+  --- this for every visible tile, so the set is only rebuilt when it can change.
   --- @return table|nil skipped_keys Set of skipped keys, or nil if not skipping
   function bridge:get_skipped_keys()
     if not self.engine:get_is_playing() then return nil end
@@ -449,26 +464,35 @@ function M.create(opts)
     local state = self.engine.state
     local current_idx = state.current_idx or -1
     local next_idx = state.next_idx or -1
-    local sequence = state.sequence or {}
 
     -- No skip if next is immediately after current
     if next_idx <= current_idx + 1 then return nil end
     if next_idx <= 0 or current_idx < 0 then return nil end
 
+    local cache = self._skipped_cache
+    if cache and cache.current_idx == current_idx and cache.next_idx == next_idx
+       and cache.sequence_version == state.sequence_version then
+      return cache.keys
+    end
+
     -- Build set of skipped keys (from current_idx + 1 to next_idx - 1)
-    local skipped = {}
+    local sequence = state.sequence or {}
+    local skipped = nil
     for i = current_idx + 1, next_idx - 1 do
       local entry = sequence[i]
       if entry and entry.item_key then
+        skipped = skipped or {}
         skipped[entry.item_key] = true
       end
     end
 
-    -- Return nil if nothing actually skipped
-    local count = 0
-    for _ in pairs(skipped) do count = count + 1 end
-    if count == 0 then return nil end
-
+    -- nil if nothing actually skipped
+    self._skipped_cache = {
+      current_idx = current_idx,
+      next_idx = next_idx,
+      sequence_version = state.sequence_version,
+      keys = skipped,
+    }
     return skipped
   end
 
@@ -565,6 +589,46 @@ function M.create(opts)
     return self.engine:get_follow_viewport()
   end
 
+  function bridge:set_monitor_feed_enabled(enabled)
+    if enabled and not self.monitor_feed then
+      local settings = RegionState.load_settings(self.proj)
+      self.monitor_feed = MonitorFeed.new({ path = settings.monitor_feed_path })
+    elseif not enabled and self.monitor_feed then
+      self.monitor_feed:close(self.engine)
+      self.monitor_feed = nil
+    end
+    local settings = RegionState.load_settings(self.proj)
+    settings.monitor_feed = enabled and true or false
+    RegionState.save_settings(settings, self.proj)
+  end
+
+  function bridge:get_monitor_feed_enabled()
+    return self.monitor_feed ~= nil
+  end
+
+  function bridge:set_trace_record_enabled(enabled)
+    local recorder = self.engine.recorder
+    if enabled and not recorder then
+      local settings = RegionState.load_settings(self.proj)
+      local writer, err = TraceFile.create(settings.trace_record_path)
+      if not writer then
+        Logger.warn('BRIDGE', 'Trace recording failed: %s', tostring(err))
+        return
+      end
+      self.engine:set_recorder(Recorder.new({ writer = writer }))
+    elseif not enabled and recorder then
+      self.engine:set_recorder(nil)
+      recorder:close()
+    end
+    local settings = RegionState.load_settings(self.proj)
+    settings.trace_record = enabled and true or false
+    RegionState.save_settings(settings, self.proj)
+  end
+
+  function bridge:get_trace_record_enabled()
+    return self.engine.recorder ~= nil
+  end
+
   function bridge:get_playing_playlist_id()
     -- Return the ID of the playlist that is currently playing
     -- Returns nil if not playing or no playlist is locked
@@ -635,6 +699,17 @@ function M.create(opts)
     return nil
   end
 
+  --- Get ancestry chain of the entry under the playlist pointer
+  --- @return table|nil ancestry Array of {key, playlist_id, ...} (outermost first)
+  function bridge:get_current_ancestry()
+    if not self.engine:get_is_playing() then return nil end
+
+    self:_ensure_sequence()
+    local state = self.engine.state
+    local entry = state and state.sequence[state.playlist_pointer or -1]
+    return entry and entry.ancestry or nil
+  end
+
   -- Check if a playlist item contains the current playback position
   -- Uses ancestry tracking: playlist_key is active if it appears in current entry's ancestry
   function bridge:is_playlist_active(playlist_key)
@@ -0,0 +1,250 @@
+-- @noindex
+-- RegionPlaylist/data/monitor_feed.lua
+-- Publishes a compact playback snapshot for external display processes
+--
+-- PURPOSE:
+-- Stage-side displays (big-font "now playing" screens, tablets, lighting
+-- desks) run outside REAPER and must not depend on our ImGui window.
+-- Each frame the bridge hands the engine to this feed, which publishes:
+--   current/next item, loop pass, elapsed/remaining, sync state
+--
+-- TRANSPORT:
+-- ReaScript has no shared memory, so the feed is a tiny key=value file
+-- replaced atomically (write temp + rename). Readers just open/read it.
+-- The same record is mirrored into non-persistent ExtState so other
+-- REAPER scripts can poll it without touching the disk.
+--
+-- CONSISTENCY (seqlock-style):
+-- The first line is 'seq=N' and the last line is 'end=N'. A reader that
+-- sees matching values has a complete record; on mismatch it retries.
+-- seq increments on every publish, so readers can also skip unchanged data.
+--
+-- RATE:
+-- Discrete changes (item, loop pass, play state) are written immediately.
+-- Continuous values (elapsed/remaining) are throttled to min_interval.
+--
+-- SEE ALSO:
+--   - tools/monitor_reader.lua (reference reader, runs with plain Lua)
+
+local Fs = require('arkitekt.core.fs')
+local Transport = require('arkitekt.reaper.transport')
+
+-- Performance: Localize math functions for hot path (30% faster in loops)
+local max = math.max
+local format = string.format
+local concat = table.concat
+
+local M = {}
+
+M.EXT_SECTION = 'ARK_REGIONPLAYLIST_MONITOR'
+M.EXT_KEY = 'snapshot'
+M.FILE_NAME = 'monitor.txt'
+
+-- Field order is part of the feed format; append new fields at the end
+M.FIELDS = {
+  'state', 'playlist_mode', 'transport_override',
+  'index', 'count',
+  'current_key', 'current_rid', 'current_name',
+  'next_key', 'next_rid', 'next_name',
+  'loop', 'loops',
+  'elapsed', 'remaining', 'duration',
+  'time',
+}
+
+local Feed = {}
+Feed.__index = Feed
+
+local function default_path()
+  if ARK and ARK.get_data_dir then
+    return Fs.join(ARK.get_data_dir('RegionPlaylist'), M.FILE_NAME)
+  end
+  return reaper.GetResourcePath() .. '/Scripts/ARKITEKT/data/RegionPlaylist/' .. M.FILE_NAME
+end
+
+--- Create a monitor feed
+--- @param opts table|nil {path, min_interval, use_file, use_extstate}
+--- @return table feed
+function M.new(opts)
+  opts = opts or {}
+  local self = setmetatable({}, Feed)
+
+  self.path = opts.path or default_path()
+  self.min_interval = opts.min_interval or 0.05
+  self.use_file = opts.use_file ~= false
+  self.use_extstate = opts.use_extstate ~= false
+  self.enabled = true
+
+  self.seq = 0
+  self.last_publish_time = 0
+  self.last_discrete = nil
+  self._dir_ready = false
+
+  -- Reused tables (no per-frame table allocation; formatted values are
+  -- still new strings)
+  self._record = {}
+  self._lines = {}
+  self._signature = {}
+
+  return self
+end
+
+--- Flatten newlines so a value always fits on one line
+local function sanitize(value)
+  if value == nil then return '' end
+  local s = tostring(value)
+  if s:find('[\r\n]') then
+    s = s:gsub('[\r\n]', ' ')
+  end
+  return s
+end
+
+local function region_name(state, rid)
+  local region = rid and state:get_region_by_rid(rid)
+  return region and region.name or ''
+end
+
+--- Fill self._record from the engine; returns discrete signature string
+function Feed:_collect(engine)
+  local rec = self._record
+  local state = engine.state
+  local transport = engine.transport
+  local sequence = state.sequence
+
+  if transport.is_playing then
+    rec.state = 'playing'
+  elseif transport.is_paused then
+    rec.state = 'paused'
+  else
+    rec.state = 'stopped'
+  end
+  rec.playlist_mode = transport._playlist_mode and 1 or 0
+  rec.transport_override = transport.transport_override and 1 or 0
+
+  local pointer = state.playlist_pointer or -1
+  local current = sequence[pointer]
+  local next_idx = state.next_idx or -1
+  local next_entry = (next_idx ~= pointer) and sequence[next_idx] or sequence[pointer + 1]
+
+  rec.index = current and pointer or 0
+  rec.count = #sequence
+  rec.current_key = current and current.item_key or ''
+  rec.current_rid = current and current.rid or ''
+  rec.current_name = current and region_name(state, current.rid) or ''
+  rec.next_key = next_entry and next_entry.item_key or ''
+  rec.next_rid = next_entry and next_entry.rid or ''
+  rec.next_name = next_entry and region_name(state, next_entry.rid) or ''
+
+  local loop, loops = state:get_current_loop_info()
+  rec.loop = loop or 1
+  rec.loops = loops or 1
+
+  local region = current and state:get_region_by_rid(current.rid)
+  if region and rec.state ~= 'stopped' then
+    local playpos = Transport.get_play_position(engine.proj)
+    local duration = region['end'] - region.start
+    rec.duration = format('%.3f', duration)
+    rec.elapsed = format('%.3f', max(0, playpos - region.start))
+    rec.remaining = format('%.3f', max(0, region['end'] - playpos))
+  else
+    rec.duration, rec.elapsed, rec.remaining = '0', '0', '0'
+  end
+
+  local sig = self._signature
+  sig[1], sig[2], sig[3], sig[4] = rec.state, rec.playlist_mode, rec.index, rec.count
+  sig[5], sig[6], sig[7], sig[8] = rec.current_key, rec.next_key, rec.loop, rec.loops
+  return concat(sig, '|')
+end
+
+function Feed:_serialize(now)
+  local rec = self._record
+  local lines = self._lines
+  rec.time = format('%.3f', now)
+
+  local n = 1
+  lines[n] = 'seq=' .. self.seq
+  for _, field in ipairs(M.FIELDS) do
+    n = n + 1
+    lines[n] = field .. '=' .. sanitize(rec[field])
+  end
+  n = n + 1
+  lines[n] = 'end=' .. self.seq
+  for i = #lines, n + 1, -1 do lines[i] = nil end
+
+  return concat(lines, '\n') .. '\n'
+end
+
+function Feed:_ensure_dir()
+  if self._dir_ready then return end
+  Fs.ensure_parent_dir(self.path)
+  self._dir_ready = true
+end
+
+--- Publish engine snapshot (call once per frame)
+--- @param engine table Playback engine (domain/playback/controller)
+--- @return boolean published True if a new record was written
+function Feed:publish(engine)
+  if not self.enabled or not engine then return false end
+
+  local now = reaper.time_precise()
+  local discrete = self:_collect(engine)
+  local changed = discrete ~= self.last_discrete
+
+  if not changed then
+    -- Nothing continuous moves while stopped
+    if self._record.state == 'stopped' then return false end
+    if now - self.last_publish_time < self.min_interval then return false end
+  end
+
+  self.seq = self.seq + 1
+  local payload = self:_serialize(now)
+
+  if self.use_extstate then
+    reaper.SetExtState(M.EXT_SECTION, M.EXT_KEY, payload, false)
+  end
+  if self.use_file then
+    self:_ensure_dir()
+    Fs.write_text_atomic(self.path, payload)
+  end
+
+  self.last_discrete = discrete
+  self.last_publish_time = now
+  return true
+end
+
+--- Publish a final 'stopped' record and stop updating
+function Feed:close(engine)
+  if engine then
+    self.last_discrete = nil
+    self:publish(engine)
+  end
+  self.enabled = false
+end
+
+-- ============================================================================
+-- READER HELPERS
+-- ============================================================================
+
+--- Parse a feed payload
+--- @param payload string Raw feed text
+--- @return table|nil record Parsed fields (nil if torn/incomplete)
+--- @return number|nil seq Sequence number of the record
+function M.parse(payload)
+  if not payload or payload == '' then return nil end
+  local rec = {}
+  for key, value in payload:gmatch('([%w_]+)=([^\n]*)') do
+    rec[key] = value
+  end
+  local seq = tonumber(rec.seq)
+  if not seq or seq ~= tonumber(rec['end']) then return nil end
+  rec.seq, rec['end'] = nil, nil
+  return rec, seq
+end
+
+--- Read the latest snapshot from ExtState (in-REAPER readers)
+--- @return table|nil record
+--- @return number|nil seq
+function M.read_extstate()
+  return M.parse(reaper.GetExtState(M.EXT_SECTION, M.EXT_KEY))
+end
+
+return M
@@ -0,0 +1,424 @@
+-- @noindex
+-- RegionPlaylist/data/playlist_codec.lua
+-- Compact encoding for saved playlists (optional, see storage.set_compact_encoding)
+--
+-- FORMAT:
+-- 'ARKPL1:' .. base64(block). The block is a versioned stream of varints:
+--   version, string table (count, then len + bytes each), playlist count,
+--   per playlist: id, name, chip color, item count, then item runs.
+-- A run is a count of consecutive items that share every field except their
+-- key (type, rid, playlist_id, reps, enabled, guid, region_name); the fields
+-- are written once and only the keys follow. Region numbers are stored as a
+-- zigzag delta from the previous run, strings by index into the table, and
+-- UUID keys as 16 raw bytes.
+--
+-- Playlists with fields this format does not know about are not encoded
+-- (encode returns nil) so the caller can fall back to JSON without losing
+-- data. Readers detect the prefix; anything else is treated as JSON.
+
+local Base64 = require('arkitekt.core.base64')
+local JSON = require('arkitekt.core.json')
+
+local M = {}
+
+M.VERSION = 1
+local PREFIX = 'ARKPL' .. M.VERSION .. ':'
+
+local byte, char, format = string.byte, string.char, string.format
+local unpack, concat = table.unpack, table.concat
+local math_type = math.type
+
+-- Item flags
+local F_PLAYLIST = 1      -- nested playlist item (else region)
+local F_ENABLED = 2       -- enabled == true
+local F_ENABLED_NIL = 4   -- enabled == nil
+local F_GUID = 8
+local F_REGION_NAME = 16
+local F_REPS_NIL = 32
+
+-- Key encodings (varint tag)
+local KEY_NIL = 0
+local KEY_UUID = 1        -- 16 raw bytes follow
+local KEY_STRING = 2      -- tag - KEY_STRING + 1 = string table index
+
+local ITEM_FIELDS = {
+  type = true, rid = true, guid = true, region_name = true,
+  reps = true, enabled = true, key = true, playlist_id = true,
+}
+local PLAYLIST_FIELDS = { id = true, name = true, chip_color = true, items = true }
+
+-- Lowercase hex digit byte -> nibble (UUID.generate emits lowercase)
+local NIBBLE = {}
+for i = 0, 9 do NIBBLE[48 + i] = i end
+for i = 0, 5 do NIBBLE[97 + i] = 10 + i end
+
+-- Positions of the 32 hex digits in 'xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx'
+local HEX_POS = {}
+for i = 1, 36 do
+  if i ~= 9 and i ~= 14 and i ~= 19 and i ~= 24 then
+    HEX_POS[#HEX_POS + 1] = i
+  end
+end
+local UUID_FORMAT = '%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x'
+
+local CHUNK = 4096
+
+local function zigzag(v)
+  return v >= 0 and v * 2 or -v * 2 - 1
+end
+
+local function unzigzag(z)
+  return (z & 1 == 0) and (z >> 1) or -((z + 1) >> 1)
+end
+
+local function is_uint(v)
+  return math_type(v) == 'integer' and v >= 0
+end
+
+local function has_only(t, allowed)
+  for k in pairs(t) do
+    if not allowed[k] then return false end
+  end
+  return true
+end
+
+local function same_record(a, b)
+  return a.type == b.type and a.rid == b.rid and a.playlist_id == b.playlist_id
+    and a.reps == b.reps and a.enabled == b.enabled
+    and a.guid == b.guid and a.region_name == b.region_name
+end
+
+-- ============================================================================
+-- ENCODE
+-- ============================================================================
+
+--- Check whether a stored value uses the compact encoding
+--- @param text string|nil
+--- @return boolean
+function M.is_compact(text)
+  return type(text) == 'string' and text:sub(1, #PREFIX) == PREFIX
+end
+
+--- Encode playlists into the compact text form
+--- @param playlists table Array of playlists
+--- @return string|nil text Encoded text (nil if the data cannot be represented)
+--- @return string|nil error Reason for falling back
+function M.encode(playlists)
+  local buf, n = {}, 0
+  local strings, string_index = {}, {}
+
+  local function put(v)
+    while v >= 0x80 do
+      n = n + 1
+      buf[n] = (v & 0x7F) | 0x80
+      v = v >> 7
+    end
+    n = n + 1
+    buf[n] = v
+  end
+
+  -- String reference: 0 = nil, else 1-based table index
+  local function put_str(s)
+    if s == nil then
+      put(0)
+      return true
+    end
+    if type(s) ~= 'string' then return false end
+    local idx = string_index[s]
+    if not idx then
+      idx = #strings + 1
+      strings[idx] = s
+      string_index[s] = idx
+    end
+    put(idx)
+    return true
+  end
+
+  local function put_key(key)
+    if key == nil then
+      put(KEY_NIL)
+      return true
+    end
+    if type(key) ~= 'string' then return false end
+    if #key == 36 then
+      local b = { byte(key, 1, 36) }
+      if b[9] == 45 and b[14] == 45 and b[19] == 45 and b[24] == 45 then
+        local packed, ok = {}, true
+        for j = 1, 16 do
+          local hi, lo = NIBBLE[b[HEX_POS[j * 2 - 1]]], NIBBLE[b[HEX_POS[j * 2]]]
+          if not (hi and lo) then ok = false break end
+          packed[j] = (hi << 4) | lo
+        end
+        if ok then
+          put(KEY_UUID)
+          for j = 1, 16 do
+            n = n + 1
+            buf[n] = packed[j]
+          end
+          return true
+        end
+      end
+    end
+    local idx = string_index[key]
+    if not idx then
+      idx = #strings + 1
+      strings[idx] = key
+      string_index[key] = idx
+    end
+    put(KEY_STRING + idx - 1)
+    return true
+  end
+
+  put(#playlists)
+  for _, pl in ipairs(playlists) do
+    if not has_only(pl, PLAYLIST_FIELDS) or type(pl.items) ~= 'table' then
+      return nil, 'Unsupported playlist fields'
+    end
+    if not (put_str(pl.id) and put_str(pl.name)) then
+      return nil, 'Unsupported playlist id/name'
+    end
+    local color = pl.chip_color
+    if color == nil then
+      put(0)
+    elseif math_type(color) == 'integer' then
+      put(zigzag(color) + 1)
+    else
+      return nil, 'Unsupported chip color'
+    end
+
+    local items = pl.items
+    local count = #items
+    put(count)
+
+    local prev_rid = 0
+    local i = 1
+    while i <= count do
+      local item = items[i]
+      if type(item) ~= 'table' or not has_only(item, ITEM_FIELDS) then
+        return nil, 'Unsupported item fields'
+      end
+
+      local run_end = i
+      while run_end < count do
+        local nxt = items[run_end + 1]
+        -- Unknown fields end the run so the next pass declines the item
+        if type(nxt) ~= 'table' or not same_record(item, nxt) or not has_only(nxt, ITEM_FIELDS) then break end
+        run_end = run_end + 1
+      end
+      put(run_end - i + 1)
+
+      local flags = 0
+      if item.type == 'playlist' then
+        if item.rid ~= nil then return nil, 'Unsupported nested item rid' end
+        flags = F_PLAYLIST
+      elseif item.type ~= 'region' or math_type(item.rid) ~= 'integer' or item.playlist_id ~= nil then
+        return nil, 'Unsupported item type'
+      end
+      if item.enabled == true then
+        flags = flags | F_ENABLED
+      elseif item.enabled == nil then
+        flags = flags | F_ENABLED_NIL
+      elseif item.enabled ~= false then
+        return nil, 'Unsupported enabled value'
+      end
+      if item.guid ~= nil then flags = flags | F_GUID end
+      if item.region_name ~= nil then flags = flags | F_REGION_NAME end
+      if item.reps == nil then
+        flags = flags | F_REPS_NIL
+      elseif not is_uint(item.reps) then
+        return nil, 'Unsupported repeat count'
+      end
+      put(flags)
+
+      if flags & F_PLAYLIST ~= 0 then
+        if not put_str(item.playlist_id) then return nil, 'Unsupported playlist reference' end
+      else
+        put(zigzag(item.rid - prev_rid))
+        prev_rid = item.rid
+      end
+      if item.reps ~= nil then put(item.reps) end
+      if item.guid ~= nil and not put_str(item.guid) then return nil, 'Unsupported guid' end
+      if item.region_name ~= nil and not put_str(item.region_name) then
+        return nil, 'Unsupported region name'
+      end
+
+      for k = i, run_end do
+        if not put_key(items[k].key) then return nil, 'Unsupported item key' end
+      end
+      i = run_end + 1
+    end
+  end
+
+  -- Header + string table go in front of the body
+  local body, body_n = buf, n
+  buf, n = {}, 0
+  put(M.VERSION)
+  put(#strings)
+  for _, s in ipairs(strings) do
+    put(#s)
+    for p = 1, #s, CHUNK do
+      local chunk = { byte(s, p, math.min(p + CHUNK - 1, #s)) }
+      for j = 1, #chunk do
+        n = n + 1
+        buf[n] = chunk[j]
+      end
+    end
+  end
+
+  local parts = {}
+  for _, src in ipairs({ { buf, n }, { body, body_n } }) do
+    local bytes, len = src[1], src[2]
+    for p = 1, len, CHUNK do
+      parts[#parts + 1] = char(unpack(bytes, p, math.min(p + CHUNK - 1, len)))
+    end
+  end
+
+  return PREFIX .. Base64.encode(concat(parts))
+end
+
+-- ============================================================================
+-- DECODE
+-- ============================================================================
+
+--- Decode the compact text form
+--- @param text string Stored text (with prefix)
+--- @return table|nil playlists Array of playlists (nil on error)
+--- @return string|nil error
+function M.decode(text)
+  if not M.is_compact(text) then
+    return nil, 'Not a compact playlist block'
+  end
+  local data, err = Base64.decode(text:sub(#PREFIX + 1))
+  if not data then return nil, err end
+
+  local pos, len = 1, #data
+
+  local function get()
+    local v, shift = 0, 0
+    while true do
+      if pos > len then error('Truncated playlist block', 0) end
+      local b = byte(data, pos)
+      pos = pos + 1
+      v = v | ((b & 0x7F) << shift)
+      if b < 0x80 then return v end
+      shift = shift + 7
+    end
+  end
+
+  local ok, result = pcall(function()
+    local version = get()
+    if version ~= M.VERSION then
+      error('Unsupported playlist block version ' .. tostring(version), 0)
+    end
+
+    local strings = {}
+    for i = 1, get() do
+      local slen = get()
+      if pos + slen - 1 > len then error('Truncated string table', 0) end
+      strings[i] = data:sub(pos, pos + slen - 1)
+      pos = pos + slen
+    end
+
+    local function get_str()
+      local idx = get()
+      if idx == 0 then return nil end
+      local s = strings[idx]
+      if not s then error('Bad string reference', 0) end
+      return s
+    end
+
+    local playlists = {}
+    for p = 1, get() do
+      local pl = { id = get_str(), name = get_str() }
+      local color = get()
+      if color ~= 0 then pl.chip_color = unzigzag(color - 1) end
+
+      local items = {}
+      local count = get()
+      local i, prev_rid = 0, 0
+      while i < count do
+        local run = get()
+        local flags = get()
+        local rid, playlist_id
+        if flags & F_PLAYLIST ~= 0 then
+          playlist_id = get_str()
+        else
+          rid = prev_rid + unzigzag(get())
+          prev_rid = rid
+        end
+        local reps = (flags & F_REPS_NIL == 0) and get() or nil
+        local guid = (flags & F_GUID ~= 0) and get_str() or nil
+        local region_name = (flags & F_REGION_NAME ~= 0) and get_str() or nil
+        local enabled
+        if flags & F_ENABLED_NIL == 0 then enabled = flags & F_ENABLED ~= 0 end
+        local item_type = (flags & F_PLAYLIST ~= 0) and 'playlist' or 'region'
+
+        if run < 1 or i + run > count then error('Bad item run', 0) end
+        for _ = 1, run do
+          local tag, key = get(), nil
+          if tag == KEY_UUID then
+            if pos + 15 > len then error('Truncated key', 0) end
+            key = format(UUID_FORMAT, byte(data, pos, pos + 15))
+            pos = pos + 16
+          elseif tag >= KEY_STRING then
+            key = strings[tag - KEY_STRING + 1]
+            if not key then error('Bad key reference', 0) end
+          end
+          i = i + 1
+          items[i] = {
+            type = item_type,
+            rid = rid,
+            playlist_id = playlist_id,
+            guid = guid,
+            region_name = region_name,
+            reps = reps,
+            enabled = enabled,
+            key = key,
+          }
+        end
+      end
+
+      pl.items = items
+      playlists[p] = pl
+    end
+    return playlists
+  end)
+
+  if not ok then return nil, result end
+  return result
+end
+
+-- ============================================================================
+-- STORED TEXT (either format)
+-- ============================================================================
+
+--- Encode playlists for storage, compact when possible
+--- @param playlists table Array of playlists
+--- @param compact boolean Try the compact block first
+--- @return string text
+--- @return string|nil fallback_reason Why JSON was used although compact was requested
+function M.encode_text(playlists, compact)
+  if compact then
+    local encoded, err = M.encode(playlists)
+    if encoded then return encoded end
+    return JSON.encode(playlists), err
+  end
+  return JSON.encode(playlists)
+end
+
+--- Decode stored playlists, detecting the format
+--- @param text string Compact block or JSON
+--- @return table|nil playlists
+--- @return string|nil error
+function M.decode_text(text)
+  if M.is_compact(text) then
+    return M.decode(text)
+  end
+  local ok, data = pcall(JSON.decode, text)
+  if not ok or type(data) ~= 'table' then
+    return nil, 'Invalid playlist JSON'
+  end
+  return data
+end
+
+return M
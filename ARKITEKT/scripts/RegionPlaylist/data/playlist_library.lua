@@ -0,0 +1,369 @@
+-- @noindex
+-- RegionPlaylist/data/playlist_library.lua
+-- Standalone playlist library files (share set lists between projects)
+--
+-- FILE LAYOUT (text, versioned):
+--   ARKPLLIB 1
+--   <count>
+--   <offset> <length> <item count> <id> <name>      (one line per playlist)
+--   <blank line>
+--   <entries>
+-- Each entry is the playlist in stored form (compact block or JSON, see
+-- playlist_codec.lua) followed by a JSON line describing the regions it
+-- references (number, name, start, end) so they can be matched in another
+-- project. Offsets are relative to the first entry.
+--
+-- LAZY LOADING:
+-- open() reads only the header; get(i) seeks to one entry and decodes it on
+-- first access. Listing a 1,000-playlist library costs one short read.
+-- (No mmap from Lua; seek + read of just the needed entry is the equivalent.)
+
+local JSON = require('arkitekt.core.json')
+local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+
+local M = {}
+
+M.MAGIC = 'ARKPLLIB'
+M.VERSION = 1
+M.EXTENSION = 'arkpl'
+
+-- Region start/end tolerance for position matching (seconds)
+local POSITION_EPSILON = 0.001
+
+local format = string.format
+
+-- Ids and names are space-free in the header: escape '%' and whitespace
+local function escape_field(s)
+  return ((s or ''):gsub('[%%%s]', function(c) return format('%%%02X', c:byte()) end))
+end
+
+local function unescape_field(s)
+  return (s:gsub('%%(%x%x)', function(h) return string.char(tonumber(h, 16)) end))
+end
+
+-- ============================================================================
+-- WRITE
+-- ============================================================================
+
+--- Write playlists to a library file
+--- Nested playlist items are kept; on import they resolve to playlists
+--- imported alongside them (or existing ones with the same id).
+--- @param path string Library file path
+--- @param playlists table Array of playlists to export
+--- @param region_index table Map rid -> region {name, start, end} of the source project
+--- @param opts table|nil {compact = boolean} (default: compact)
+--- @return boolean ok
+--- @return string|nil error
+function M.write(path, playlists, region_index, opts)
+  local compact = not (opts and opts.compact == false)
+  local entries, index_lines = {}, {}
+  local offset = 0
+
+  for i, pl in ipairs(playlists) do
+    local regions, seen = {}, {}
+    for _, item in ipairs(pl.items) do
+      local rid = item.type == 'region' and item.rid
+      if rid and not seen[rid] then
+        seen[rid] = true
+        local region = region_index and region_index[rid]
+        regions[#regions + 1] = {
+          rid = rid,
+          name = region and region.name or item.region_name,
+          start = region and region.start,
+          ['end'] = region and region['end'],
+        }
+      end
+    end
+
+    local entry = PlaylistCodec.encode_text({ pl }, compact) .. '\n' .. JSON.encode(regions) .. '\n'
+    entries[i] = entry
+    index_lines[i] = format('%d %d %d %s %s', offset, #entry, #pl.items, escape_field(pl.id), escape_field(pl.name))
+    offset = offset + #entry
+  end
+
+  local header = format('%s %d\n%d\n%s\n\n', M.MAGIC, M.VERSION, #playlists, table.concat(index_lines, '\n'))
+  if #playlists == 0 then
+    header = format('%s %d\n0\n\n', M.MAGIC, M.VERSION)
+  end
+
+  local f, err = io.open(path, 'wb')
+  if not f then return false, err end
+  f:write(header)
+  f:write(table.concat(entries))
+  f:close()
+  return true
+end
+
+-- ============================================================================
+-- READ (LAZY)
+-- ============================================================================
+
+local Library = {}
+Library.__index = Library
+
+--- Open a library file and read its index
+--- @param path string Library file path
+--- @return table|nil library
+--- @return string|nil error
+function M.open(path)
+  local f, err = io.open(path, 'rb')
+  if not f then return nil, err end
+
+  local magic, version = (f:read('l') or ''):match('^(%S+) (%d+)$')
+  if magic ~= M.MAGIC then
+    f:close()
+    return nil, 'Not a playlist library file'
+  end
+  if tonumber(version) > M.VERSION then
+    f:close()
+    return nil, 'Library version ' .. version .. ' is newer than supported'
+  end
+
+  local count = tonumber(f:read('l'))
+  if not count then
+    f:close()
+    return nil, 'Malformed library header'
+  end
+
+  local index = {}
+  for i = 1, count do
+    local line = f:read('l')
+    local offset, length, items, id, name = (line or ''):match('^(%d+) (%d+) (%d+) (%S*) ?(.*)$')
+    if not offset then
+      f:close()
+      return nil, 'Malformed library index at entry ' .. i
+    end
+    index[i] = {
+      offset = tonumber(offset),
+      length = tonumber(length),
+      item_count = tonumber(items),
+      id = unescape_field(id),
+      name = unescape_field(name),
+    }
+  end
+  f:read('l')  -- Blank separator line
+
+  return setmetatable({
+    path = path,
+    file = f,
+    body_start = f:seek(),
+    index = index,
+    cache = {},
+  }, Library)
+end
+
+--- Number of playlists in the library
+--- @return number
+function Library:count()
+  return #self.index
+end
+
+--- Index entry (id, name, item_count) without decoding the playlist
+--- @param i number Entry index
+--- @return table|nil
+function Library:info(i)
+  return self.index[i]
+end
+
+--- Decode one playlist (cached after first access)
+--- @param i number Entry index
+--- @return table|nil entry {playlist, regions}
+--- @return string|nil error
+function Library:get(i)
+  local cached = self.cache[i]
+  if cached then return cached end
+
+  local info = self.index[i]
+  if not info then return nil, 'No library entry ' .. tostring(i) end
+  if not self.file then return nil, 'Library is closed' end
+
+  self.file:seek('set', self.body_start + info.offset)
+  local data = self.file:read(info.length)
+  if not data or #data ~= info.length then
+    return nil, 'Truncated library entry ' .. i
+  end
+
+  local text, regions_text = data:match('^(.-)\n(.-)\n$')
+  local playlists, err = PlaylistCodec.decode_text(text or '')
+  if not playlists or not playlists[1] then
+    return nil, err or 'Empty library entry ' .. i
+  end
+  local ok, regions = pcall(JSON.decode, regions_text or '[]')
+
+  local entry = { playlist = playlists[1], regions = ok and regions or {} }
+  self.cache[i] = entry
+  return entry
+end
+
+--- Release the file handle
+function Library:close()
+  if self.file then
+    self.file:close()
+    self.file = nil
+  end
+end
+
+-- ============================================================================
+-- IMPORT (REGION MATCHING)
+-- ============================================================================
+
+--- Match library regions to regions of the target project
+--- Order: name + number, name, position (start/end), number.
+--- @param source_regions table Array of {rid, name, start, end}
+--- @param target_regions table Array of project regions {rid, name, start, end, guid}
+--- @return table map source rid -> target region
+--- @return table matched Counts per method {exact, name, position, number}
+function M.match_regions(source_regions, target_regions)
+  local by_rid, by_name, by_start = {}, {}, {}
+  for _, region in ipairs(target_regions) do
+    by_rid[region.rid] = region
+    if region.name and region.name ~= '' and not by_name[region.name] then
+      by_name[region.name] = region
+    end
+    if region.start then
+      local bucket = math.floor(region.start / POSITION_EPSILON + 0.5)
+      by_start[bucket] = by_start[bucket] or {}
+      local list = by_start[bucket]
+      list[#list + 1] = region
+    end
+  end
+
+  local function at_position(src)
+    if not (src.start and src['end']) then return nil end
+    local bucket = math.floor(src.start / POSITION_EPSILON + 0.5)
+    for b = bucket - 1, bucket + 1 do
+      for _, region in ipairs(by_start[b] or {}) do
+        if math.abs(region.start - src.start) <= POSITION_EPSILON
+           and math.abs(region['end'] - src['end']) <= POSITION_EPSILON then
+          return region
+        end
+      end
+    end
+    return nil
+  end
+
+  local map = {}
+  local matched = { exact = 0, name = 0, position = 0, number = 0 }
+  for _, src in ipairs(source_regions) do
+    local same_number = by_rid[src.rid]
+    local has_name = src.name and src.name ~= ''
+    local target, method
+    if same_number and has_name and same_number.name == src.name then
+      target, method = same_number, 'exact'
+    elseif has_name and by_name[src.name] then
+      target, method = by_name[src.name], 'name'
+    else
+      target = at_position(src)
+      if target then
+        method = 'position'
+      elseif same_number then
+        target, method = same_number, 'number'
+      end
+    end
+    if target then
+      map[src.rid] = target
+      matched[method] = matched[method] + 1
+    end
+  end
+  return map, matched
+end
+
+--- Prepare library entries for import into the current project
+--- Playlists and items get new ids/keys; region items are remapped to
+--- matched regions (unmatched ones are dropped); nested playlist items are
+--- remapped to playlists imported alongside, kept if the id already exists
+--- in the project, dropped otherwise.
+--- @param entries table Array of {playlist, regions} (from Library:get)
+--- @param target_regions table Array of project regions
+--- @param opts table {new_id = fn, new_key = fn, existing_ids = set|nil}
+--- @return table playlists Ready to insert
+--- @return table report {playlists, items, dropped_regions, dropped_nested, matched}
+function M.prepare_import(entries, target_regions, opts)
+  local existing = opts.existing_ids or {}
+  local report = {
+    playlists = 0,
+    items = 0,
+    dropped_regions = 0,
+    dropped_nested = 0,
+    matched = { exact = 0, name = 0, position = 0, number = 0 },
+  }
+
+  local id_map = {}
+  for _, entry in ipairs(entries) do
+    id_map[entry.playlist.id] = opts.new_id()
+  end
+
+  local result = {}
+  for _, entry in ipairs(entries) do
+    local src = entry.playlist
+    local region_map, matched = M.match_regions(entry.regions or {}, target_regions)
+    for method, n in pairs(matched) do
+      report.matched[method] = report.matched[method] + n
+    end
+
+    local items = {}
+    for _, item in ipairs(src.items or {}) do
+      if item.type == 'playlist' then
+        local nested = id_map[item.playlist_id] or (existing[item.playlist_id] and item.playlist_id)
+        if nested then
+          items[#items + 1] = {
+            type = 'playlist',
+            playlist_id = nested,
+            reps = item.reps or 1,
+            enabled = item.enabled ~= false,
+            key = opts.new_key(),
+          }
+        else
+          report.dropped_nested = report.dropped_nested + 1
+        end
+      else
+        local region = region_map[item.rid]
+        if region then
+          items[#items + 1] = {
+            type = 'region',
+            rid = region.rid,
+            guid = region.guid,
+            region_name = region.name,
+            reps = item.reps or 1,
+            enabled = item.enabled ~= false,
+            key = opts.new_key(),
+          }
+        else
+          report.dropped_regions = report.dropped_regions + 1
+        end
+      end
+    end
+
+    result[#result + 1] = {
+      id = id_map[src.id],
+      name = src.name,
+      chip_color = src.chip_color,
+      items = items,
+    }
+    report.playlists = report.playlists + 1
+    report.items = report.items + #items
+  end
+
+  return result, report
+end
+
+--- Format an import report for display
+--- @param report table From prepare_import
+--- @return string
+function M.format_report(report)
+  local m = report.matched
+  local lines = {
+    format('Imported %d playlist(s), %d item(s).', report.playlists, report.items),
+    format('Regions matched: %d by name and number, %d by name, %d by position, %d by number.',
+      m.exact, m.name, m.position, m.number),
+  }
+  if report.dropped_regions > 0 then
+    lines[#lines + 1] = format('%d item(s) dropped: region not found in this project.', report.dropped_regions)
+  end
+  if report.dropped_nested > 0 then
+    lines[#lines + 1] = format('%d nested playlist item(s) dropped: playlist not imported.', report.dropped_nested)
+  end
+  return table.concat(lines, '\n')
+end
+
+return M
@@ -0,0 +1,210 @@
+-- @noindex
+-- RegionPlaylist/data/rpp_scan.lua
+-- RPP text scanning: SWS playlist chunks and project markers/regions
+--
+-- Pure Lua (no REAPER API): used by the SWS importer inside REAPER and by
+-- tools/rpp_analyzer.lua on plain project files.
+
+local M = {}
+
+M.SWS_SECTION_TAG = "<S&M_RGN_PLAYLIST"
+M.SWS_REGION_FLAG = 0x40000000  -- Bit 30 indicates region in SWS format
+M.SWS_INFINITE_LOOP = -1
+
+local SECTION_TAG = M.SWS_SECTION_TAG
+local MAX_MALFORMED_REPORTED = 20  -- Per playlist; the count is always exact
+
+-- Performance: Localize string functions for the streaming parser
+local find = string.find
+local sub = string.sub
+local match = string.match
+
+-- ============================================================================
+-- SWS PLAYLIST CHUNKS (STREAMING)
+-- ============================================================================
+-- The project text is scanned in place: a plain find jumps straight to each
+-- <S&M_RGN_PLAYLIST tag (no per-line table for the rest of the RPP), and
+-- item lines are matched anchored at the current offset, so only the two
+-- integer captures are allocated per item. Items are stored in parallel
+-- arrays (raw SWS ids, decoded region numbers, loop counts) instead of one
+-- table per item. Lines that are neither items, blank, nor the closing '>'
+-- are counted and reported as malformed.
+
+-- Parse header line: <S&M_RGN_PLAYLIST "Name" [0|1] or <S&M_RGN_PLAYLIST Name [0|1]
+local function parse_header(header)
+  -- Try quoted name first, then unquoted (first token after the tag)
+  local name = match(header, '<S&M_RGN_PLAYLIST%s+"([^"]+)"')
+            or match(header, '<S&M_RGN_PLAYLIST%s+([^%s]+)')
+  -- Active flag (0 or 1 at end)
+  local is_active = match(header, '%s+(%d+)%s*$') == "1"
+  return name or "Imported", is_active
+end
+
+-- Parse one playlist section starting at its tag
+-- Returns: playlist table, position after the section
+local function parse_section(text, tag_pos)
+  local len = #text
+  local line_end = find(text, "\n", tag_pos, true) or (len + 1)
+  local name, is_active = parse_header(sub(text, tag_pos, line_end - 1))
+
+  local ids, numbers, loops, n = {}, {}, {}, 0
+  local flag = M.SWS_REGION_FLAG
+  local malformed, malformed_count = {}, 0
+  local pos = line_end + 1
+
+  while pos <= len do
+    -- Fast path: "<regionId> <loopCount>" line, anchored at pos
+    local _, e, id, count = find(text, "^[ \t]*(%d+)[ \t]+(%-?%d+)[ \t]*\r?\n", pos)
+    if e then
+      n = n + 1
+      id = tonumber(id)
+      ids[n] = id
+      numbers[n] = id >= flag and id - flag or false
+      loops[n] = tonumber(count)
+      pos = e + 1
+    else
+      local eol = find(text, "\n", pos, true) or (len + 1)
+      local line_end = eol - 1
+      if sub(text, line_end, line_end) == "\r" then line_end = line_end - 1 end
+      local line = sub(text, pos, line_end)
+      pos = eol + 1
+
+      -- End of playlist section (allow leading whitespace)
+      if find(line, "^%s*>%s*$") then
+        break
+      end
+
+      -- Last line without newline, or blank line
+      id, count = match(line, "^[ \t]*(%d+)[ \t]+(%-?%d+)%s*$")
+      if id then
+        n = n + 1
+        id = tonumber(id)
+        ids[n] = id
+        numbers[n] = id >= flag and id - flag or false
+        loops[n] = tonumber(count)
+      elseif find(line, "%S") then
+        malformed_count = malformed_count + 1
+        if malformed_count <= MAX_MALFORMED_REPORTED then
+          malformed[malformed_count] = { entry = n + malformed_count, text = line }
+        end
+      end
+    end
+  end
+
+  return {
+    name = name,
+    is_active = is_active,
+    sws_rgn_ids = ids,
+    region_numbers = numbers,   -- REAPER region number per item, false if not a region id
+    sws_loop_counts = loops,
+    count = n,
+    malformed = malformed,
+    malformed_count = malformed_count,
+  }, pos
+end
+
+--- Parse all SWS playlists from RPP text
+--- @param text string Project file contents
+--- @return table playlists Array of {name, is_active, sws_rgn_ids, region_numbers, sws_loop_counts,
+---   count, malformed, malformed_count}
+function M.parse_sws_playlists(text)
+  local playlists = {}
+  local pos = 1
+
+  while true do
+    local tag_pos = find(text, SECTION_TAG, pos, true)
+    if not tag_pos then break end
+    local playlist, next_pos = parse_section(text, tag_pos)
+    playlists[#playlists + 1] = playlist
+    pos = next_pos
+  end
+
+  return playlists
+end
+
+-- ============================================================================
+-- PROJECT MARKERS / REGIONS
+-- ============================================================================
+-- Top-level MARKER lines: MARKER <number> <pos> <name> <flags> [color ...]
+-- Flags bit 0 marks a region; a region is written as two lines with the same
+-- number, the second one (empty name) holding the end position.
+
+-- Split an RPP line into tokens ("..." / '...' / `...` quoting, else spaces)
+local function tokenize(line)
+  local tokens = {}
+  local pos, len = 1, #line
+  while pos <= len do
+    local s = find(line, "%S", pos)
+    if not s then break end
+    local q = sub(line, s, s)
+    local token, next_pos
+    if q == '"' or q == "'" or q == "`" then
+      local e = find(line, q, s + 1, true) or (len + 1)
+      token, next_pos = sub(line, s + 1, e - 1), e + 1
+    else
+      local e = (find(line, "%s", s) or (len + 1)) - 1
+      token, next_pos = sub(line, s, e), e + 1
+    end
+    tokens[#tokens + 1] = token
+    pos = next_pos
+  end
+  return tokens
+end
+
+--- Parse project markers and regions from RPP text
+--- Regions keep file order; a region without its end line is dropped.
+--- @param text string Project file contents
+--- @return table regions Array of {rid, name, start, end}
+--- @return table markers Array of {number, name, pos}
+function M.parse_markers(text)
+  local regions, markers = {}, {}
+  local open = {}  -- region number -> region awaiting its end line
+  local pos = 1
+
+  while true do
+    local s = find(text, "MARKER ", pos, true)
+    if not s then break end
+    local eol = find(text, "\n", s, true) or (#text + 1)
+    pos = eol + 1
+
+    -- Only project-level lines ("  MARKER ..."), not substrings elsewhere
+    local bol = s
+    while bol > 1 do
+      local c = sub(text, bol - 1, bol - 1)
+      if c ~= " " and c ~= "\t" then break end
+      bol = bol - 1
+    end
+    if bol == 1 or sub(text, bol - 1, bol - 1) == "\n" then
+      local t = tokenize(sub(text, s + 7, eol - 1))
+      local number, at, flags = tonumber(t[1]), tonumber(t[2]), tonumber(t[4])
+      if number and at and flags then
+        if flags & 1 == 1 then
+          local region = open[number]
+          if region then
+            region["end"] = at
+            regions[#regions + 1] = region
+            open[number] = nil
+          else
+            open[number] = { rid = number, name = t[3] or "", start = at }
+          end
+        else
+          markers[#markers + 1] = { number = number, name = t[3] or "", pos = at }
+        end
+      end
+    end
+  end
+
+  return regions, markers
+end
+
+--- Decode an SWS region id to a REAPER region number
+--- @param sws_id number
+--- @return number|nil region_number
+function M.decode_sws_region_id(sws_id)
+  if sws_id >= M.SWS_REGION_FLAG then
+    return sws_id - M.SWS_REGION_FLAG
+  end
+  return nil
+end
+
+return M
@@ -0,0 +1,230 @@
+-- @noindex
+-- RegionPlaylist/data/script_api.lua
+-- Batch playlist edits for other ReaScripts (setup/rebuild scripts)
+--
+-- PURPOSE:
+-- Setup scripts build or rebuild whole playlists (often 1000+ items). They
+-- send one batch of edits (see PlaylistDomain.apply_edits for operations)
+-- and get one undo point, one save and one playback resync for all of it.
+--
+-- TRANSPORT:
+-- While Region Playlist is running, requests go through non-persistent
+-- ExtState: the script writes 'request', the app applies it on its next frame
+-- through Controller:edit_items (app undo history + sequence resync) and
+-- writes 'response'. One request slot; submit() refuses while one is pending.
+-- The app refreshes a heartbeat ('alive' = time_precise) while it serves;
+-- a heartbeat older than ALIVE_TIMEOUT counts as not running, so a crashed
+-- app never leaves clients waiting. When the app is not running,
+-- apply_to_project() edits the project data directly inside a single REAPER
+-- undo block, with the same checks as the app (nested playlists must exist
+-- and must not form a cycle; regions are tagged with their guid and name).
+--
+-- USAGE (from another script, after loading the ARKITEKT framework):
+-- ```lua
+-- local Api = require('RegionPlaylist.data.script_api')
+-- local edits = { { op = 'clear' }, { op = 'insert', items = { {rid=1}, {rid=2, reps=4} } } }
+-- if Api.is_running() then
+--   local id = Api.submit('Playlist 1', edits)   -- id, name, or nil = active
+--   -- ...later (next defer cycle): local res = Api.read_response(id)
+-- else
+--   local ok, keys_or_err = Api.apply_to_project(0, 'Playlist 1', edits)
+-- end
+-- ```
+
+local JSON = require('arkitekt.core.json')
+local RegionState = require('RegionPlaylist.data.storage')
+local PlaylistDomain = require('RegionPlaylist.domain.playlist')
+local Logger = require('arkitekt.debug.logger')
+
+local M = {}
+
+M.EXT_SECTION = 'ARK_REGIONPLAYLIST_API'
+M.ALIVE_TIMEOUT = 2.0       -- Seconds without a heartbeat before the app counts as gone
+local HEARTBEAT_INTERVAL = 0.5
+local KEY_REQUEST = 'request'
+local KEY_RESPONSE = 'response'
+local KEY_ALIVE = 'alive'
+
+-- Resolve a playlist reference (id, then name, then active when nil)
+local function find_playlist(playlists, ref, active_id)
+  ref = ref or active_id
+  for _, pl in ipairs(playlists) do
+    if pl.id == ref then return pl end
+  end
+  for _, pl in ipairs(playlists) do
+    if pl.name == ref then return pl end
+  end
+  return nil
+end
+
+-- ============================================================================
+-- CLIENT SIDE (other scripts)
+-- ============================================================================
+
+--- Check whether a Region Playlist instance is serving requests
+--- @return boolean
+function M.is_running()
+  local beat = tonumber(reaper.GetExtState(M.EXT_SECTION, KEY_ALIVE))
+  return beat ~= nil and reaper.time_precise() - beat < M.ALIVE_TIMEOUT
+end
+
+--- Queue a batch for the running app
+--- @param playlist_ref string|nil Playlist id or name (nil = active playlist)
+--- @param edits table Array of edit operations
+--- @return string|nil request_id Id to match the response (nil if slot busy/invalid)
+--- @return string|nil error
+function M.submit(playlist_ref, edits)
+  local ok, err = PlaylistDomain.validate_edits(edits)
+  if not ok then return nil, err end
+  if not M.is_running() then
+    return nil, 'Region Playlist is not running'
+  end
+  if reaper.GetExtState(M.EXT_SECTION, KEY_REQUEST) ~= '' then
+    return nil, 'A request is already pending'
+  end
+
+  local id = string.format('%.0f-%d', reaper.time_precise() * 1000, math.random(1, 1 << 30))
+  local payload = JSON.encode({ id = id, playlist = playlist_ref, edits = edits })
+  reaper.SetExtState(M.EXT_SECTION, KEY_RESPONSE, '', false)
+  reaper.SetExtState(M.EXT_SECTION, KEY_REQUEST, payload, false)
+  return id
+end
+
+--- Read the response for a submitted request
+--- @param request_id string Id returned by submit()
+--- @return table|nil response {id, ok, error, keys} or nil if not answered (yet)
+--- @return string|nil error Set when no answer will come (the app stopped)
+function M.read_response(request_id)
+  local raw = reaper.GetExtState(M.EXT_SECTION, KEY_RESPONSE)
+  local response = raw ~= '' and JSON.decode(raw) or nil
+  if type(response) == 'table' and response.id == request_id then
+    return response
+  end
+  if not M.is_running() then
+    return nil, 'Region Playlist stopped before answering'
+  end
+  return nil
+end
+
+--- Apply a batch directly to project data (app not running)
+--- Creates exactly one REAPER undo point.
+--- @param proj number|userdata Project (0 = current)
+--- @param playlist_ref string|nil Playlist id or name (nil = saved active playlist)
+--- @param edits table Array of edit operations
+--- @return boolean ok
+--- @return table|string keys Inserted item keys (or error message)
+function M.apply_to_project(proj, playlist_ref, edits)
+  local ok, err = PlaylistDomain.validate_edits(edits)
+  if not ok then return false, err end
+
+  local playlists = RegionState.load_playlists(proj)
+  local pl = find_playlist(playlists, playlist_ref, RegionState.load_active_playlist(proj))
+  if not pl then return false, 'Playlist not found' end
+
+  -- Same nested-playlist checks as Controller:edit_items
+  local by_id = {}
+  for _, p in ipairs(playlists) do by_id[p.id] = p end
+  local graph = require('RegionPlaylist.domain.dependency').new()
+  graph:rebuild(playlists)
+  ok, err = PlaylistDomain.validate_nested(pl.id, edits,
+    function(id) return by_id[id] ~= nil end,
+    function(target, added) return graph:detect_circular_reference(target, added) end)
+  if not ok then return false, err end
+
+  local regions
+  local function describe_region(rid)
+    if not regions then
+      regions = {}
+      for _, region in ipairs(require('arkitekt.reaper.regions').scan_project_regions(proj)) do
+        regions[region.rid] = region
+      end
+    end
+    local region = regions[rid]
+    if region then return region.guid, region.name end
+  end
+
+  -- apply_edits leaves pl.items as it was when it fails; only the save
+  -- touches the project, and the undo block is closed whatever happens
+  local UUID = require('arkitekt.core.uuid')
+  local applied, keys = pcall(PlaylistDomain.apply_edits, pl.items, edits, {
+    new_key = UUID.generate,
+    describe_region = describe_region,
+  })
+  if not applied then return false, tostring(keys) end
+
+  reaper.Undo_BeginBlock2(proj)
+  local saved, save_err = pcall(RegionState.save_playlists, playlists, proj)
+  reaper.Undo_EndBlock2(proj, 'Region Playlist: Batch edit', -1)
+  if not saved then return false, tostring(save_err) end
+  return true, keys
+end
+
+-- ============================================================================
+-- SERVER SIDE (running app)
+-- ============================================================================
+
+local Server = {}
+Server.__index = Server
+
+--- Create the request server (marks the app as running)
+--- A request left by a client of an app that crashed is dropped: its
+--- client has long given up on it.
+--- @return table server
+function M.new_server()
+  reaper.DeleteExtState(M.EXT_SECTION, KEY_REQUEST, false)
+  reaper.DeleteExtState(M.EXT_SECTION, KEY_RESPONSE, false)
+  local self = setmetatable({ last_beat = 0 }, Server)
+  self:_heartbeat()
+  return self
+end
+
+function Server:_heartbeat()
+  local now = reaper.time_precise()
+  if now - self.last_beat >= HEARTBEAT_INTERVAL then
+    self.last_beat = now
+    reaper.SetExtState(M.EXT_SECTION, KEY_ALIVE, string.format('%.3f', now), false)
+  end
+end
+
+--- Apply a pending request, if any (call once per frame)
+--- @param controller table Playlist controller
+--- @param state table App state module
+--- @return boolean handled True if a request was processed
+function Server:poll(controller, state)
+  self:_heartbeat()
+  local raw = reaper.GetExtState(M.EXT_SECTION, KEY_REQUEST)
+  if raw == '' then return false end
+  reaper.DeleteExtState(M.EXT_SECTION, KEY_REQUEST, false)
+
+  local request = JSON.decode(raw)
+  local response
+  if type(request) ~= 'table' then
+    response = { ok = false, error = 'Malformed request' }
+  else
+    local pl = find_playlist(state.get_playlists(), request.playlist, state.get_active_playlist_id())
+    if not pl then
+      response = { id = request.id, ok = false, error = 'Playlist not found' }
+    else
+      local ok, result = controller:edit_items(pl.id, request.edits)
+      response = { id = request.id, ok = ok }
+      if ok then
+        response.keys = result
+      else
+        response.error = tostring(result)
+      end
+    end
+  end
+
+  if not response.ok then
+    Logger.warn('API', 'Batch edit rejected: %s', response.error)
+  end
+  reaper.SetExtState(M.EXT_SECTION, KEY_RESPONSE, JSON.encode(response), false)
+  return true
+end
+
+--- Stop serving (call on app shutdown)
+function Server:close()
+  reaper.DeleteExtState(M.EXT_SECTION, KEY_ALIVE, false)
+end
+
+return M
@@ -4,6 +4,7 @@
 -- REFACTORED: Now uses arkitekt.reaper.project_state module
 
 local ProjectState = require('arkitekt.reaper.project_state')
+local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
 local Logger = require('arkitekt.debug.logger')
 local Ark = require('arkitekt')
 local M = {}
@@ -24,13 +25,40 @@ local function get_storage(proj)
   return storage_cache[proj]
 end
 
+-- Save playlists with the compact encoding (see playlist_codec.lua).
+-- Off by default; loading detects either format.
+local compact_encoding = false
+
+--- Choose the encoding used by save_playlists
+--- @param enabled boolean True for the compact block, false for JSON
+function M.set_compact_encoding(enabled)
+  compact_encoding = enabled and true or false
+end
+
+function M.is_compact_encoding()
+  return compact_encoding
+end
+
 function M.save_playlists(playlists, proj)
   Logger.info('STORAGE', 'Saving %d playlists to project', #playlists)
-  get_storage(proj):save(KEY_PLAYLISTS, playlists)
+  local text, fallback = PlaylistCodec.encode_text(playlists, compact_encoding)
+  if fallback then
+    Logger.warn('STORAGE', 'Compact encoding skipped (%s), saving as JSON', fallback)
+  end
+  reaper.SetProjExtState(proj or 0, EXT_STATE_SECTION, KEY_PLAYLISTS, text)
 end
 
 function M.load_playlists(proj)
-  local playlists = get_storage(proj):load(KEY_PLAYLISTS, {})
+  local ok, raw = reaper.GetProjExtState(proj or 0, EXT_STATE_SECTION, KEY_PLAYLISTS)
+  if ok ~= 1 or not raw or raw == '' then
+    return {}
+  end
+
+  local playlists, err = PlaylistCodec.decode_text(raw)
+  if not playlists then
+    Logger.error('STORAGE', 'Failed to load playlists: %s', err)
+    playlists = {}
+  end
   Logger.info('STORAGE', 'Loaded %d playlists from project', #playlists)
   return playlists
 end
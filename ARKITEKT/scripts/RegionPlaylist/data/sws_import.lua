@@ -4,70 +4,22 @@
 
 local RegionState = require("RegionPlaylist.data.storage")
 local Ark = require('arkitekt')
+local PlaylistDomain = require('RegionPlaylist.domain.playlist')
+local RppScan = require('RegionPlaylist.data.rpp_scan')
 local M = {}
 
 -- Constants
-local SWS_REGION_FLAG = 0x40000000  -- Bit 30 indicates region in SWS format
-local SWS_INFINITE_LOOP = -1
-local ARK_INFINITE_LOOP_REPS = 999  -- ARK representation of infinite loop
+local SWS_INFINITE_LOOP = RppScan.SWS_INFINITE_LOOP
+local ARK_INFINITE_LOOP_REPS = PlaylistDomain.INFINITE_REPS  -- ARK representation of infinite loop
 local SWS_PLAYLIST_NAME_PREFIX = "[SWS] "
 
--- Parse a single SWS playlist section from RPP lines
--- Returns: playlist table or nil on error
-local function parse_sws_playlist_section(lines, start_idx)
-  local playlist = {
-    items = {},
-    name = "Imported",
-    is_active = false,
-  }
-
-  -- Parse header line: <S&M_RGN_PLAYLIST "Name" [0|1] or <S&M_RGN_PLAYLIST Name [0|1]
-  local header = lines[start_idx]
-
-  -- Try quoted name first
-  local name = header:match('<S&M_RGN_PLAYLIST%s+"([^"]+)"')
-  if not name then
-    -- Try unquoted name (everything between PLAYLIST and the number or end of line)
-    name = header:match('<S&M_RGN_PLAYLIST%s+([^%s]+)')
-  end
-  if name then
-    playlist.name = name
-  end
-
-  -- Extract active flag (0 or 1 at end)
-  local is_active = header:match('%s+(%d+)%s*$')
-  if is_active == "1" then
-    playlist.is_active = true
-  end
-
-  -- Parse items until we hit '>'
-  local idx = start_idx + 1
-  while idx <= #lines do
-    local line = lines[idx]
-
-    -- End of playlist section (allow leading whitespace)
-    if line:match('^%s*>%s*$') then
-      return playlist, idx
-    end
-
-    -- Parse item line: regionId loopCount (allow leading whitespace)
-    local rgn_id, loop_count = line:match('^%s*(%d+)%s+(-?%d+)%s*$')
-    if rgn_id and loop_count then
-      playlist.items[#playlist.items + 1] = {
-        sws_rgn_id = tonumber(rgn_id),
-        sws_loop_count = tonumber(loop_count),
-      }
-    end
-
-    idx = idx + 1
-  end
-
-  return playlist, idx
-end
+-- Performance: Localize string functions (parsing lives in rpp_scan.lua)
+local find = string.find
+local SECTION_TAG = RppScan.SWS_SECTION_TAG
 
 -- Read current project file as text
--- Returns: lines table or nil on error
-local function read_project_file()
+-- Returns: text or nil, error
+local function read_project_text()
   ---@diagnostic disable-next-line: redundant-parameter
   local proj_path = reaper.GetProjectPath("")
   ---@diagnostic disable-next-line: redundant-parameter
@@ -77,78 +29,51 @@ local function read_project_file()
   end
 
   local filepath = proj_path .. "/" .. proj_name
-  local file = io.open(filepath, "r")
+  local file = io.open(filepath, "rb")
   if not file then
     return nil, "Could not open project file: " .. filepath
   end
-  
-  local lines = {}
-  for line in file:lines() do
-    lines[#lines + 1] = line
-  end
-  file:close()
-  
-  return lines
-end
-
--- Parse all SWS playlists from RPP file lines
--- Returns: array of playlist tables
-local function parse_sws_playlists(lines)
-  local playlists = {}
-  local idx = 1
-
-  while idx <= #lines do
-    local line = lines[idx]
-
-    -- Found a playlist section (allow leading whitespace)
-    if line:match('<S&M_RGN_PLAYLIST') then
-      local playlist, end_idx = parse_sws_playlist_section(lines, idx)
-      if playlist then
-        playlists[#playlists + 1] = playlist
-        idx = end_idx
-      end
-    end
 
-    idx = idx + 1
-  end
+  local text = file:read("a")
+  file:close()
 
-  return playlists
+  return text
 end
 
--- Decode SWS region ID to region number
--- SWS uses bitfield format: 0x40000000 | region_number for regions
--- Returns: region number or nil
-local function decode_sws_region_id(sws_id)
-  if sws_id >= SWS_REGION_FLAG then
-    return sws_id - SWS_REGION_FLAG
-  end
-  return nil
+--- Parse all SWS playlists from RPP text (see rpp_scan.lua)
+--- @param text string Project file contents
+--- @return table playlists Array of {name, is_active, sws_rgn_ids, sws_loop_counts, count, malformed, malformed_count}
+function M.parse_sws_playlists(text)
+  return RppScan.parse_sws_playlists(text)
 end
 
--- Find region by number and return ARK region index (1-based count of regions only)
--- Returns: ARK region number (1-based region count) or nil
-local function get_ark_region_number(region_num)
+local decode_sws_region_id = RppScan.decode_sws_region_id
+
+-- Map displayed region number -> ARK region index (1-based count of regions only)
+-- Built once per import (one marker enumeration instead of one per item)
+local function build_region_number_map()
+  local map = {}
   local idx = 0
   local region_count = 0
 
   while true do
-    local retval, isrgn, pos, rgnend, name, markrgnindexnumber = reaper.EnumProjectMarkers(idx)
+    local retval, isrgn, _, _, _, markrgnindexnumber = reaper.EnumProjectMarkers(idx)
     if retval == 0 then
       break  -- No more markers/regions
     end
 
     if isrgn then
       region_count = region_count + 1
-      -- markrgnindexnumber is the displayed region number
-      if markrgnindexnumber == region_num then
-        return region_count
+      -- First region wins for duplicate numbers
+      if not map[markrgnindexnumber] then
+        map[markrgnindexnumber] = region_count
       end
     end
 
     idx = idx + 1
   end
 
-  return nil
+  return map
 end
 
 -- Generate unique item key
@@ -172,7 +97,7 @@ end
 
 -- Convert SWS playlist to ARK format
 -- Returns: ARK playlist table, plus report data
-local function convert_sws_playlist_to_ark(sws_playlist, playlist_num)
+local function convert_sws_playlist_to_ark(sws_playlist, playlist_num, region_map, compact)
   local ark_playlist = {
     id = "SWS_" .. tostring(playlist_num),
     name = SWS_PLAYLIST_NAME_PREFIX .. sws_playlist.name,
@@ -181,30 +106,34 @@ local function convert_sws_playlist_to_ark(sws_playlist, playlist_num)
   }
   
   local report = {
-    total_items = #sws_playlist.items,
+    total_items = sws_playlist.count,
     converted_items = 0,
     skipped_items = 0,
     infinite_loops = 0,
     skipped_rids = {},
+    malformed_lines = sws_playlist.malformed_count,
+    malformed = sws_playlist.malformed,
   }
+
+  local rgn_ids = sws_playlist.sws_rgn_ids
+  local loop_counts = sws_playlist.sws_loop_counts
   
-  for _, sws_item in ipairs(sws_playlist.items) do
+  for i = 1, sws_playlist.count do
+    local sws_rgn_id = rgn_ids[i]
+
     -- Decode SWS region ID to get the REAPER region number
-    local reaper_region_num = decode_sws_region_id(sws_item.sws_rgn_id)
+    local reaper_region_num = decode_sws_region_id(sws_rgn_id)
 
     -- Find the ARK region index (1-based count of regions only)
-    local ark_region_num = nil
-    if reaper_region_num then
-      ark_region_num = get_ark_region_number(reaper_region_num)
-    end
+    local ark_region_num = reaper_region_num and region_map[reaper_region_num]
 
     if ark_region_num then
       -- Convert loop count
-      local reps, is_infinite, is_valid = convert_loop_count(sws_item.sws_loop_count)
+      local reps, is_infinite, is_valid = convert_loop_count(loop_counts[i])
 
       if not is_valid then
         report.skipped_items = report.skipped_items + 1
-        report.skipped_rids[#report.skipped_rids + 1] = sws_item.sws_rgn_id
+        report.skipped_rids[#report.skipped_rids + 1] = sws_rgn_id
         goto continue
       end
 
@@ -224,28 +153,33 @@ local function convert_sws_playlist_to_ark(sws_playlist, playlist_num)
     else
       -- Region not found (deleted or ID mismatch)
       report.skipped_items = report.skipped_items + 1
-      report.skipped_rids[#report.skipped_rids + 1] = sws_item.sws_rgn_id
+      report.skipped_rids[#report.skipped_rids + 1] = sws_rgn_id
     end
     
     ::continue::
   end
-  
+
+  -- SWS playlists often repeat a region as consecutive entries; fold them
+  -- when auto-compaction is on (opt-in, like every other mutation site)
+  report.merged_items = compact and #PlaylistDomain.normalize(ark_playlist.items) or 0
+
   return ark_playlist, report
 end
 
 -- Main import function
+-- `compact`: merge adjacent duplicates (the auto_compact setting)
 -- Returns: success (bool), ark_playlists (table), report (table), error_msg (string)
-function M.import_from_current_project(merge_mode)
+function M.import_from_current_project(merge_mode, compact)
   merge_mode = merge_mode or false -- false = replace, true = merge
   
   -- Read project file
-  local lines, err = read_project_file()
-  if not lines then
+  local text, err = read_project_text()
+  if not text then
     return false, nil, nil, err
   end
   
   -- Parse SWS playlists
-  local sws_playlists = parse_sws_playlists(lines)
+  local sws_playlists = M.parse_sws_playlists(text)
   if #sws_playlists == 0 then
     return false, nil, nil, "No SWS Region Playlists found in project"
   end
@@ -259,12 +193,16 @@ function M.import_from_current_project(merge_mode)
     converted_items = 0,
     skipped_items = 0,
     infinite_loops = 0,
+    malformed_lines = 0,
     active_playlist_idx = nil,
     per_playlist = {},
   }
   
+  local region_map = build_region_number_map()
+
   for i, sws_playlist in ipairs(sws_playlists) do
-    local ark_playlist, report = convert_sws_playlist_to_ark(sws_playlist, i)
+    local ark_playlist, report = convert_sws_playlist_to_ark(sws_playlist, i, region_map, compact)
+    overall_report.malformed_lines = overall_report.malformed_lines + report.malformed_lines
     
     -- Only add if at least one item was converted
     if #ark_playlist.items > 0 then
@@ -297,8 +235,10 @@ function M.import_from_current_project(merge_mode)
 end
 
 -- Execute import and save to project
--- Returns: success (bool), report (table), error_msg (string)
-function M.execute_import(merge_mode, backup)
+-- Returns: success (bool), report (table), error_msg (string), playlists (table)
+-- `playlists` is the full list as saved, so callers can adopt it without
+-- reading it back from the project. `compact`: see import_from_current_project.
+function M.execute_import(merge_mode, backup, compact)
   merge_mode = merge_mode or false
   backup = backup ~= false -- default true
   
@@ -315,12 +255,13 @@ function M.execute_import(merge_mode, backup)
   end
   
   -- Import
-  local success, ark_playlists, report, err = M.import_from_current_project(merge_mode)
+  local success, ark_playlists, report, err = M.import_from_current_project(merge_mode, compact)
   if not success then
     return false, report, err
   end
 
   -- Save to project (nil checks are defensive - data should be valid from parser)
+  local saved
   ---@diagnostic disable: need-check-nil
   if merge_mode then
     -- Merge with existing playlists (prepend SWS playlists to the beginning)
@@ -334,6 +275,7 @@ function M.execute_import(merge_mode, backup)
       end
     end
     RegionState.save_playlists(existing, 0)
+    saved = existing
 
     -- Set active playlist if SWS had one marked
     if report and report.active_playlist_idx then
@@ -345,6 +287,7 @@ function M.execute_import(merge_mode, backup)
   else
     -- Replace all playlists
     RegionState.save_playlists(ark_playlists, 0)
+    saved = ark_playlists
 
     -- Set active playlist
     if report and report.active_playlist_idx and ark_playlists[report.active_playlist_idx] then
@@ -358,7 +301,7 @@ function M.execute_import(merge_mode, backup)
   end
   ---@diagnostic enable: need-check-nil
   
-  return true, report, nil
+  return true, report, nil, saved
 end
 
 -- Format report for display
@@ -383,12 +326,19 @@ function M.format_report(report)
     lines[#lines + 1] = string.format("Infinite loops converted to 999 reps: %d", report.infinite_loops)
   end
 
+  if (report.malformed_lines or 0) > 0 then
+    lines[#lines + 1] = string.format("Malformed lines ignored: %d", report.malformed_lines)
+  end
+
   if report.per_playlist then
     lines[#lines + 1] = ""
     lines[#lines + 1] = "Per Playlist:"
     for i, pl_report in ipairs(report.per_playlist) do
       lines[#lines + 1] = string.format("  %d. \"%s\": %d/%d items",
         i, pl_report.name, pl_report.report.converted_items, pl_report.report.total_items)
+      for _, bad in ipairs(pl_report.report.malformed or {}) do
+        lines[#lines + 1] = string.format("     malformed entry %d: %s", bad.entry, bad.text)
+      end
     end
   end
   
@@ -397,19 +347,12 @@ end
 
 -- Check if project has SWS playlists (quick check)
 function M.has_sws_playlists()
-  local lines, err = read_project_file()
-  if not lines then
+  local text = read_project_text()
+  if not text then
     return false
   end
 
-  for _, line in ipairs(lines) do
-    -- Allow leading whitespace
-    if line:match('<S&M_RGN_PLAYLIST') then
-      return true
-    end
-  end
-
-  return false
+  return find(text, SECTION_TAG, 1, true) ~= nil
 end
 
 return M
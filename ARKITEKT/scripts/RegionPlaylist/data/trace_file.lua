@@ -0,0 +1,137 @@
+-- @noindex
+-- RegionPlaylist/data/trace_file.lua
+-- Fixed-size binary ring file for playback traces (see domain/playback/recorder.lua)
+--
+-- FORMAT (little endian):
+--   header  'ARKTRACE', version u2, slot size u2, capacity u4 (slots), pad to 32
+--   slots   capacity * 32 bytes: tag c1, seq u4, payload (27 bytes, zero padded)
+-- seq counts records from 1 (0 = never written). Slots are written in order
+-- and wrap to the first slot when the file is full, so the newest record is
+-- the one with the highest seq and the oldest is the slot after it. Records
+-- larger than one slot are split by the caller (see recorder 'C' records).
+
+local M = {}
+
+M.MAGIC = 'ARKTRACE'
+M.VERSION = 1
+M.SLOT_SIZE = 32
+M.PAYLOAD_SIZE = M.SLOT_SIZE - 5
+M.DEFAULT_CAPACITY = 65536   -- 2 MB
+M.FILE_NAME = 'trace.bin'
+
+local HEADER_SIZE = 32
+local SLOT_SIZE = M.SLOT_SIZE
+local pack, unpack = string.pack, string.unpack
+local rep = string.rep
+
+local function header(capacity)
+  local h = M.MAGIC .. pack('<I2I2I4', M.VERSION, SLOT_SIZE, capacity)
+  return h .. rep('\0', HEADER_SIZE - #h)
+end
+
+--- Default trace location in the ARKITEKT data folder (REAPER only)
+--- @return string path
+function M.default_path()
+  if ARK and ARK.get_data_dir then
+    local Fs = require('arkitekt.core.fs')
+    return Fs.join(ARK.get_data_dir('RegionPlaylist'), M.FILE_NAME)
+  end
+  return reaper.GetResourcePath() .. '/Scripts/ARKITEKT/data/RegionPlaylist/' .. M.FILE_NAME
+end
+
+local Writer = {}
+Writer.__index = Writer
+
+--- Create (or truncate) a trace file and open it for writing
+--- @param path string|nil Default: default_path()
+--- @param capacity number|nil Slots in the ring (default DEFAULT_CAPACITY)
+--- @return table|nil writer
+--- @return string|nil error
+function M.create(path, capacity)
+  path = path or M.default_path()
+  capacity = capacity or M.DEFAULT_CAPACITY
+  local f, err = io.open(path, 'w+b')
+  if not f then return nil, err end
+
+  f:write(header(capacity))
+  local empty = rep('\0', SLOT_SIZE * 256)
+  local left = capacity
+  while left > 0 do
+    local n = math.min(left, 256)
+    f:write(n == 256 and empty or rep('\0', SLOT_SIZE * n))
+    left = left - n
+  end
+  f:seek('set', HEADER_SIZE)
+
+  return setmetatable({
+    path = path,
+    file = f,
+    capacity = capacity,
+    payload_size = M.PAYLOAD_SIZE,
+    slot = 0,       -- Next slot to write
+    seq = 0,        -- Last seq written
+    wraps = 0,
+  }, Writer)
+end
+
+--- Append one record; payload longer than PAYLOAD_SIZE is an error
+--- @param tag string One character record tag
+--- @param payload string Packed record body
+--- @return number seq
+function Writer:write(tag, payload)
+  assert(#payload <= M.PAYLOAD_SIZE, 'trace record payload too long')
+  if self.slot == self.capacity then
+    self.slot = 0
+    self.wraps = self.wraps + 1
+    self.file:seek('set', HEADER_SIZE)
+  end
+  self.seq = self.seq + 1
+  self.file:write(tag, pack('<I4', self.seq), payload, rep('\0', M.PAYLOAD_SIZE - #payload))
+  self.slot = self.slot + 1
+  return self.seq
+end
+
+--- Push buffered records to disk
+function Writer:flush()
+  if self.file then self.file:flush() end
+end
+
+function Writer:close()
+  if self.file then
+    self.file:close()
+    self.file = nil
+  end
+end
+
+--- Read every record of a trace file, oldest first
+--- @param path string
+--- @return table|nil records Array of {tag, seq, payload}
+--- @return string|nil error
+function M.read(path)
+  local f, err = io.open(path, 'rb')
+  if not f then return nil, err end
+  local data = f:read('a')
+  f:close()
+
+  if #data < HEADER_SIZE or data:sub(1, #M.MAGIC) ~= M.MAGIC then
+    return nil, 'Not a trace file: ' .. path
+  end
+  local version, slot_size, capacity = unpack('<I2I2I4', data, #M.MAGIC + 1)
+  if version ~= M.VERSION or slot_size ~= SLOT_SIZE then
+    return nil, 'Unsupported trace version ' .. version
+  end
+
+  local records = {}
+  for i = 0, capacity - 1 do
+    local pos = HEADER_SIZE + i * SLOT_SIZE + 1
+    if pos + SLOT_SIZE - 1 > #data then break end
+    local seq = unpack('<I4', data, pos + 1)
+    if seq > 0 then
+      records[#records + 1] = { tag = data:sub(pos, pos), seq = seq, payload = data:sub(pos + 5, pos + SLOT_SIZE - 1) }
+    end
+  end
+  table.sort(records, function(a, b) return a.seq < b.seq end)
+  return records
+end
+
+return M
@@ -1,73 +1,118 @@
 -- @noindex
 -- Arkitekt/features/region_playlist/undo_bridge.lua
 -- Bridge between undo manager and playlist state
+--
+-- COPY-ON-WRITE SNAPSHOTS:
+-- A snapshot holds frozen (never mutated) copies of each playlist. Frozen
+-- copies are cached per live playlist table and shared by every snapshot
+-- taken while that playlist is unchanged, so capturing after an edit only
+-- copies the playlists that edit touched. The cache trusts its callers: a
+-- live playlist mutated without mark_dirty(pl) or invalidate_all() keeps
+-- sharing its stale copy, and undo would restore that. Every mutation path
+-- reports its edits:
+--   - Controller: marks each playlist it hands out during an undoable
+--     operation (and all playlists when one is deleted)
+--   - State.cleanup_deleted_regions / reload_project_data: invalidate_all()
+--   - restore_snapshot(): restored playlists are new tables
 
 local M = {}
 
-function M.capture_snapshot(playlists, active_playlist_id)
-  local Regions = require('arkitekt.reaper.regions')
-
-  local snapshot = {
-    playlists = {},
-    active_playlist = active_playlist_id,
-    regions = {},  -- Capture region state (name, color)
-    timestamp = os.time(),
+-- live playlist table -> frozen copy (weak keys: dropped playlists are collected)
+local frozen = setmetatable({}, { __mode = 'k' })
+
+-- Region properties are captured from one marker enumeration and reused while
+-- the project state change count is unchanged
+local region_cache = nil
+local region_cache_count = nil
+
+local function copy_item(item)
+  local item_copy = {
+    type = item.type,
+    rid = item.rid,
+    guid = item.guid,  -- Stable tracking (survives some renumbering)
+    region_name = item.region_name,  -- Fallback for renumbering
+    reps = item.reps,
+    enabled = item.enabled,
+    key = item.key,
   }
+  -- Save playlist_id for playlist items
+  if item.type == 'playlist' then
+    item_copy.playlist_id = item.playlist_id
+  end
+  return item_copy
+end
 
-  -- Collect all unique region IDs referenced in playlists
-  local region_rids = {}
-  for _, pl in ipairs(playlists) do
-    for _, item in ipairs(pl.items) do
-      if item.type == 'region' and item.rid then
-        region_rids[item.rid] = true
-      end
-    end
+local function freeze_playlist(pl)
+  local cached = frozen[pl]
+  if cached then
+    return cached
   end
 
-  -- Snapshot region properties (name, color)
-  for rid in pairs(region_rids) do
-    local region = Regions.get_region_by_rid(0, rid)
-    if region then
-      snapshot.regions[rid] = {
-        name = region.name,
-        color = region.color,
-      }
-    end
+  local items = {}
+  for i, item in ipairs(pl.items) do
+    items[i] = copy_item(item)
   end
+  cached = {
+    id = pl.id,
+    name = pl.name,
+    chip_color = pl.chip_color,
+    items = items,
+  }
+  frozen[pl] = cached
+  return cached
+end
 
-  for _, pl in ipairs(playlists) do
-    local pl_copy = {
-      id = pl.id,
-      name = pl.name,
-      chip_color = pl.chip_color,
-      items = {},
+local function capture_regions()
+  local count = reaper.GetProjectStateChangeCount and reaper.GetProjectStateChangeCount(0)
+  if region_cache and count and count == region_cache_count then
+    return region_cache
+  end
+
+  local Regions = require('arkitekt.reaper.regions')
+  local regions = {}
+  for _, region in ipairs(Regions.scan_project_regions(0)) do
+    regions[region.rid] = {
+      name = region.name,
+      color = region.color,
     }
+  end
 
-    for _, item in ipairs(pl.items) do
-      local item_copy = {
-        type = item.type,
-        rid = item.rid,
-        guid = item.guid,  -- Stable tracking (survives some renumbering)
-        region_name = item.region_name,  -- Fallback for renumbering
-        reps = item.reps,
-        enabled = item.enabled,
-        key = item.key,
-      }
-      -- Save playlist_id for playlist items
-      if item.type == 'playlist' then
-        item_copy.playlist_id = item.playlist_id
-      end
-      pl_copy.items[#pl_copy.items + 1] = item_copy
-    end
+  region_cache = regions
+  region_cache_count = count
+  return regions
+end
 
-    snapshot.playlists[#snapshot.playlists + 1] = pl_copy
+--- Forget the frozen copy of a playlist (call after mutating it)
+--- @param pl table Live playlist
+function M.mark_dirty(pl)
+  if pl then
+    frozen[pl] = nil
+  end
+end
+
+--- Forget all frozen copies (call after bulk edits outside the controller)
+function M.invalidate_all()
+  frozen = setmetatable({}, { __mode = 'k' })
+  region_cache = nil
+  region_cache_count = nil
+end
+
+function M.capture_snapshot(playlists, active_playlist_id)
+  local snapshot = {
+    playlists = {},
+    active_playlist = active_playlist_id,
+    regions = capture_regions(),  -- Capture region state (name, color); shared, read-only
+    timestamp = os.time(),
+  }
+
+  for i, pl in ipairs(playlists) do
+    snapshot.playlists[i] = freeze_playlist(pl)
   end
 
   return snapshot
 end
 
 function M.restore_snapshot(snapshot, region_index)
-  local Regions = require('arkitekt.reaper.regions')
   local restored_playlists = {}
 
   -- Track what was changed for status reporting
@@ -79,11 +124,28 @@ function M.restore_snapshot(snapshot, region_index)
   }
 
   -- Restore region properties (name, color) if snapshot contains region data
+  -- Only regions referenced by the snapshot's playlists are restored.
   -- Use raw versions to avoid creating REAPER undo points (we have our own undo system)
   if snapshot.regions then
-    for rid, region_data in pairs(snapshot.regions) do
-      local current_region = Regions.get_region_by_rid(0, rid)
-      if current_region then
+    local Regions = require('arkitekt.reaper.regions')
+    local referenced = {}
+    for _, pl in ipairs(snapshot.playlists) do
+      for _, item in ipairs(pl.items) do
+        if item.type == 'region' and item.rid then
+          referenced[item.rid] = true
+        end
+      end
+    end
+
+    local current = {}
+    for _, region in ipairs(Regions.scan_project_regions(0)) do
+      current[region.rid] = region
+    end
+
+    for rid in pairs(referenced) do
+      local region_data = snapshot.regions[rid]
+      local current_region = current[rid]
+      if region_data and current_region then
         -- Only restore if properties have changed
         if current_region.name ~= region_data.name then
           Regions.set_region_name_raw(0, rid, region_data.name)
@@ -110,27 +172,21 @@ function M.restore_snapshot(snapshot, region_index)
       items = {},
     }
 
+    local items = pl_copy.items
     for _, item in ipairs(pl.items) do
       -- For region items, verify the region still exists
       -- For playlist items, always restore them
       if item.type == 'playlist' or region_index[item.rid] then
-        local item_copy = {
-          type = item.type,
-          rid = item.rid,
-          guid = item.guid,  -- Restore stable tracking
-          region_name = item.region_name,  -- Restore fallback name
-          reps = item.reps,
-          enabled = item.enabled,
-          key = item.key,
-        }
-        -- Restore playlist_id for playlist items
-        if item.type == 'playlist' then
-          item_copy.playlist_id = item.playlist_id
-        end
-        pl_copy.items[#pl_copy.items + 1] = item_copy
-        changes.items_count = changes.items_count + 1
+        items[#items + 1] = copy_item(item)
       end
     end
+    changes.items_count = changes.items_count + #items
+
+    -- Nothing dropped: the restored playlist matches the frozen copy, so the
+    -- next capture can share it instead of copying again
+    if #items == #pl.items then
+      frozen[pl_copy] = pl
+    end
 
     restored_playlists[#restored_playlists + 1] = pl_copy
     changes.playlists_count = changes.playlists_count + 1
@@ -173,4 +229,4 @@ function M.should_capture(old_playlists, new_playlists)
   return false
 end
 
-return M
\ No newline at end of file
+return M
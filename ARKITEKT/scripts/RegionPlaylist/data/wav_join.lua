@@ -0,0 +1,139 @@
+-- @noindex
+-- RegionPlaylist/data/wav_join.lua
+-- Join WAV files end to end into one continuous file (playlist renders)
+--
+-- Parts must share one sample format (identical 'fmt ' chunks). Sample data
+-- is streamed in blocks, so a long show is never held in memory. Other
+-- chunks (cue, bext, LIST, ...) are dropped. Plain RIFF only: the joined
+-- data must stay under the 4 GB RIFF limit (no RF64).
+
+local M = {}
+
+local BLOCK_SIZE = 1 << 20   -- Bytes copied per read
+local RIFF_LIMIT = 0xFFFFFFFF
+
+local function u32(s, pos)
+  return string.unpack('<I4', s, pos)
+end
+
+--- Build a canonical WAV header (RIFF, fmt, data chunk header)
+--- @param fmt string Raw 'fmt ' chunk body
+--- @param data_size number Bytes of sample data that follow
+--- @return string header
+function M.header(fmt, data_size)
+  -- The RIFF size counts the pad byte written after odd-length data
+  local riff_size = 4 + 8 + #fmt + 8 + data_size + data_size % 2
+  return 'RIFF' .. string.pack('<I4', riff_size) .. 'WAVE'
+    .. 'fmt ' .. string.pack('<I4', #fmt) .. fmt
+    .. 'data' .. string.pack('<I4', data_size)
+end
+
+--- Locate the format and sample data of a WAV file
+--- @param path string
+--- @return table|nil info {fmt, channels, sample_rate, bits, block_align, data_offset, data_size, frames}
+--- @return string|nil error
+function M.read_info(path)
+  local f, err = io.open(path, 'rb')
+  if not f then return nil, err end
+
+  local head = f:read(12)
+  if not head or #head < 12 or head:sub(1, 4) ~= 'RIFF' or head:sub(9, 12) ~= 'WAVE' then
+    f:close()
+    return nil, 'Not a RIFF/WAVE file: ' .. path
+  end
+
+  local info = {}
+  while true do
+    local chunk = f:read(8)
+    if not chunk or #chunk < 8 then break end
+    local id, size = chunk:sub(1, 4), u32(chunk, 5)
+    if id == 'fmt ' then
+      info.fmt = f:read(size)
+      if size % 2 == 1 then f:seek('cur', 1) end
+    elseif id == 'data' then
+      info.data_offset = f:seek()
+      info.data_size = size
+      break
+    else
+      f:seek('cur', size + size % 2)
+    end
+  end
+  f:close()
+
+  if not info.fmt or #info.fmt < 16 then
+    return nil, 'Missing fmt chunk: ' .. path
+  end
+  if not info.data_offset then
+    return nil, 'Missing data chunk: ' .. path
+  end
+  local _, channels, sample_rate, _, block_align, bits = string.unpack('<I2I2I4I4I2I2', info.fmt)
+  info.channels = channels
+  info.sample_rate = sample_rate
+  info.bits = bits
+  info.block_align = block_align
+  info.frames = block_align > 0 and info.data_size // block_align or 0
+  return info
+end
+
+--- Join WAV files in order into one file
+--- @param paths table Array of part paths, in playback order
+--- @param out_path string Output path
+--- @return boolean ok
+--- @return table|string result {frames, sample_rate, channels, parts} or error
+function M.join(paths, out_path)
+  if #paths == 0 then
+    return false, 'Nothing to join'
+  end
+
+  local infos, total = {}, 0
+  for i, path in ipairs(paths) do
+    local info, err = M.read_info(path)
+    if not info then return false, err end
+    if i > 1 and info.fmt ~= infos[1].fmt then
+      return false, 'Sample format differs in part ' .. i .. ': ' .. path
+    end
+    infos[i] = info
+    total = total + info.data_size
+  end
+  if total + total % 2 + 4 + 8 + #infos[1].fmt + 8 > RIFF_LIMIT then
+    return false, 'Joined audio exceeds the 4 GB WAV limit'
+  end
+
+  local out, err = io.open(out_path, 'wb')
+  if not out then return false, err end
+  out:write(M.header(infos[1].fmt, total))
+
+  for i, info in ipairs(infos) do
+    local f, open_err = io.open(paths[i], 'rb')
+    if not f then
+      out:close()
+      return false, open_err
+    end
+    f:seek('set', info.data_offset)
+    local remaining = info.data_size
+    while remaining > 0 do
+      local block = f:read(math.min(BLOCK_SIZE, remaining))
+      if not block or #block == 0 then
+        f:close()
+        out:close()
+        return false, 'Truncated data in part ' .. i .. ': ' .. paths[i]
+      end
+      out:write(block)
+      remaining = remaining - #block
+    end
+    f:close()
+  end
+
+  if total % 2 == 1 then out:write('\0') end  -- RIFF chunks are word aligned
+  out:close()
+
+  local first = infos[1]
+  return true, {
+    frames = first.block_align > 0 and total // first.block_align or 0,
+    sample_rate = first.sample_rate,
+    channels = first.channels,
+    parts = #infos,
+  }
+end
+
+return M
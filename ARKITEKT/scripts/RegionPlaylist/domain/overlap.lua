@@ -13,54 +13,63 @@ local M = {}
 -- Regions that merely touch at boundaries are not considered nested
 local FUDGE_FACTOR = 0.001
 
---- Check if a position falls within a region's boundaries (exclusive of edges)
---- @param pos number Position to check
---- @param region_start number Region start time
---- @param region_end number Region end time
---- @return boolean is_inside True if position is inside (not touching edges)
-local function is_inside(pos, region_start, region_end)
-  return pos >= (region_start + FUDGE_FACTOR) and pos <= (region_end - FUDGE_FACTOR)
-end
-
---- Check if one region is nested inside another
---- A region is nested if its start OR end falls inside the outer region
---- @param inner table Region to check {start, end, rid}
---- @param outer table Potential containing region {start, end, rid}
---- @return boolean is_nested True if inner is nested within outer
-local function is_nested_in(inner, outer)
-  if inner.rid == outer.rid then return false end
-
-  local outer_start = outer.start
-  local outer_end = outer['end']
-
-  -- Check if inner's start or end falls within outer's boundaries
-  return is_inside(inner.start, outer_start, outer_end) or
-         is_inside(inner['end'], outer_start, outer_end)
+-- First index in a sorted region array whose field is >= value
+local function lower_bound(sorted, field, value)
+  local lo, hi = 1, #sorted + 1
+  while lo < hi do
+    local mid = (lo + hi) // 2
+    if sorted[mid][field] < value then lo = mid + 1 else hi = mid end
+  end
+  return lo
 end
 
 --- Find all overlapping regions in the cache
+--- Regions are sorted by start and by end once; each region then finds the
+--- starts and ends inside it by binary search, so the cost is O(n log n)
+--- plus the number of nested pairs instead of testing every pair.
 --- @param region_cache table Map of rid -> region {rid, start, end, name, color}
 --- @return table overlap_map Map of outer_rid -> {inner_rid1, inner_rid2, ...}
 function M.find_overlaps(region_cache)
   local overlap_map = {}
 
-  -- Convert cache to array for iteration
-  local regions = {}
-  for rid, region in pairs(region_cache) do
-    regions[#regions + 1] = region
+  local by_start, by_end = {}, {}
+  for _, region in pairs(region_cache) do
+    by_start[#by_start + 1] = region
+    by_end[#by_end + 1] = region
   end
+  table.sort(by_start, function(a, b) return a.start < b.start end)
+  table.sort(by_end, function(a, b) return a['end'] < b['end'] end)
+
+  for _, outer in ipairs(by_start) do
+    local outer_rid = outer.rid
+    local from = outer.start + FUDGE_FACTOR
+    local limit = outer['end'] - FUDGE_FACTOR
+    local nested, seen
+
+    -- Regions whose start falls inside outer
+    for i = lower_bound(by_start, 'start', from), #by_start do
+      local inner = by_start[i]
+      if inner.start > limit then break end
+      if inner.rid ~= outer_rid then
+        nested, seen = nested or {}, seen or {}
+        seen[inner.rid] = true
+        nested[#nested + 1] = inner.rid
+      end
+    end
 
-  -- For each region, check if any other region is nested inside it
-  for _, outer in ipairs(regions) do
-    for _, inner in ipairs(regions) do
-      if is_nested_in(inner, outer) then
-        local outer_rid = outer.rid
-        if not overlap_map[outer_rid] then
-          overlap_map[outer_rid] = {}
-        end
-        overlap_map[outer_rid][#overlap_map[outer_rid] + 1] = inner.rid
+    -- Regions whose end falls inside outer (once, even if the start did too)
+    for i = lower_bound(by_end, 'end', from), #by_end do
+      local inner = by_end[i]
+      if inner['end'] > limit then break end
+      if inner.rid ~= outer_rid and not (seen and seen[inner.rid]) then
+        nested = nested or {}
+        nested[#nested + 1] = inner.rid
       end
     end
+
+    if nested then
+      overlap_map[outer_rid] = nested
+    end
   end
 
   return overlap_map
@@ -6,6 +6,7 @@ local EngineState = require('RegionPlaylist.domain.playback.state')
 local EngineTransport = require('RegionPlaylist.domain.playback.transport')
 local EngineTransitions = require('RegionPlaylist.domain.playback.transitions')
 local EngineQuantize = require('RegionPlaylist.domain.playback.quantize')
+local Trace = require('arkitekt.debug.trace')
 
 local M = {}
 local Engine = {}
@@ -41,6 +42,9 @@ function M.new(opts)
     transport = self.transport,
   })
   
+  -- Transport inputs of the current update, read once (reused table)
+  self.frame = { time = 0, playpos = 0, play_state = 0 }
+
   self.follow_playhead = (opts.follow_playhead ~= false)
   self.quantize_mode = opts.quantize_mode or 'measure'
   self.on_repeat_cycle = opts.on_repeat_cycle
@@ -95,27 +99,53 @@ function Engine:get_region_by_rid(rid)
   return self.state:get_region_by_rid(rid)
 end
 
+--- Attach a recorder (recorder.lua) to log every step, or nil to stop
+--- @param recorder table|nil
+function Engine:set_recorder(recorder)
+  self.recorder = recorder
+  self.transport.recorder = recorder
+  if recorder then
+    recorder:sync_context(self)
+  end
+end
+
+-- Run a user command through the recorder: logged with the decisions it led to
+function Engine:_recorded(name, key, target, method, ...)
+  self.recorder:begin_command(self, name, key)
+  local result = target[method](target, ...)
+  self.recorder:end_step(self)
+  return result
+end
+
 function Engine:play()
+  if self.recorder then return self:_recorded('play', nil, self.transport, 'play') end
   return self.transport:play()
 end
 
 function Engine:stop()
+  if self.recorder then return self:_recorded('stop', nil, self.transport, 'stop') end
   return self.transport:stop()
 end
 
 function Engine:pause()
+  if self.recorder then return self:_recorded('pause', nil, self.transport, 'pause') end
   return self.transport:pause()
 end
 
 function Engine:next()
+  if self.recorder then return self:_recorded('next', nil, self.transport, 'next') end
   return self.transport:next()
 end
 
 function Engine:prev()
+  if self.recorder then return self:_recorded('prev', nil, self.transport, 'prev') end
   return self.transport:prev()
 end
 
 function Engine:jump_to_next_quantized(lookahead)
+  if self.recorder then
+    return self:_recorded('jump_to_next_quantized', nil, self.quantize, 'jump_to_next_quantized', lookahead)
+  end
   return self.quantize:jump_to_next_quantized(lookahead)
 end
 
@@ -123,6 +153,11 @@ end
 --- @param key string Item key to seek to
 --- @return boolean success
 function Engine:seek_to_item(key)
+  if self.recorder then return self:_recorded('seek_to_item', key, self, '_seek_to_item', key) end
+  return self:_seek_to_item(key)
+end
+
+function Engine:_seek_to_item(key)
   local idx = self.transport:find_index_by_key(key)
   if idx then
     return self.transport:seek_to_index(idx, true)
@@ -135,6 +170,13 @@ end
 --- @param lookahead number|nil Lookahead time in seconds
 --- @return boolean success
 function Engine:schedule_seek_to_item(key, lookahead)
+  if self.recorder then
+    return self:_recorded('schedule_seek_to_item', key, self, '_schedule_seek_to_item', key, lookahead)
+  end
+  return self:_schedule_seek_to_item(key, lookahead)
+end
+
+function Engine:_schedule_seek_to_item(key, lookahead)
   local idx = self.transport:find_index_by_key(key)
   if not idx then return false end
 
@@ -148,6 +190,11 @@ end
 --- @param key string Item key to set as next
 --- @return boolean success
 function Engine:set_next_item(key)
+  if self.recorder then return self:_recorded('set_next_item', key, self, '_set_next_item', key) end
+  return self:_set_next_item(key)
+end
+
+function Engine:_set_next_item(key)
   local idx = self.transport:find_index_by_key(key)
   if not idx then return false end
 
@@ -157,7 +204,28 @@ function Engine:set_next_item(key)
 end
 
 function Engine:update()
+  local span = Trace.begin('engine', 'update')
+  -- Read the transport once: every decision of this update, and the
+  -- recorded frame, see the same time, position and state
+  local proj, frame = self.proj, self.frame
+  frame.time = reaper.time_precise()
+  frame.playpos = reaper.GetPlayPositionEx(proj)
+  frame.play_state = reaper.GetPlayStateEx(proj)
+  self.state.frame = frame
+
+  local recorder = self.recorder
+  if recorder then recorder:begin_frame(self, frame) end
+  self:_update()
+  self.state.frame = nil
+  if recorder then recorder:end_step(self) end
+  Trace.finish(span, 'current_idx', self.state.current_idx, 'next_idx', self.state.next_idx)
+end
+
+function Engine:_update()
   self:check_for_changes()
+  if self.recorder then
+    self.recorder:sync_context(self)
+  end
   
   if self.transport:check_stopped() then
     return
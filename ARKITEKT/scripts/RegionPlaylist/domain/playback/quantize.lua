@@ -4,6 +4,7 @@
 -- MODIFIED: Integrated Logger for debug output
 
 local Logger = require('arkitekt.debug.logger')
+local Recorder = require('RegionPlaylist.domain.playback.recorder')
 
 -- Performance: Use VM operations instead of C function calls
 -- floor(x) = x//1 (5-10% faster in loops)
@@ -15,13 +16,15 @@ Quantize.__index = Quantize
 
 local TRIGGER_REGION_NAME = '__TRANSITION_TRIGGER'
 
-local function _is_playing(proj)
-  proj = proj or 0
-  local st = reaper.GetPlayStateEx(proj)
+-- frame: inputs the engine read for the update in progress (state.frame),
+-- nil outside Engine:update() (user commands read the transport live)
+local function _is_playing(proj, frame)
+  local st = frame and frame.play_state or reaper.GetPlayStateEx(proj or 0)
   return (st & 1) == 1
 end
 
-local function _get_play_pos(proj)
+local function _get_play_pos(proj, frame)
+  if frame then return frame.playpos end
   return reaper.GetPlayPositionEx(proj or 0)
 end
 
@@ -215,7 +218,7 @@ function Quantize:jump_to_next_quantized(lookahead)
     return self.transport:next()
   end
   
-  local playpos = _get_play_pos(self.proj)
+  local playpos = _get_play_pos(self.proj, self.state.frame)
   
   local next_quantize = self:_calculate_next_quantize_point(playpos, 0)
   
@@ -275,6 +278,7 @@ function Quantize:jump_to_next_quantized(lookahead)
   if target_region then
     Logger.debug('QUANTIZE', 'Queuing GoToRegion(%d)', target_region.rid)
     reaper.GoToRegion(self.proj, target_region.rid, false)
+    if self.transport.recorder then self.transport.recorder:seek(target_region.rid, Recorder.SEEK.QUANTIZE) end
   end
   
   reaper.SetEditCurPos2(self.proj, cursor_pos, false, false)
@@ -299,7 +303,7 @@ function Quantize:update()
     return
   end
   
-  local playpos = _get_play_pos(self.proj)
+  local playpos = _get_play_pos(self.proj, self.state.frame)
   
   if self.trigger_region.last_playpos and playpos < self.trigger_region.last_playpos - 0.2 then
     Logger.debug('QUANTIZE', 'Backward seek detected, cleanup')
@@ -337,7 +341,7 @@ function Quantize:update()
         self.state.playlist_pointer = self.trigger_region.target_idx
       end
 
-      self.transport:_seek_to_region(self.trigger_region.target_rid)
+      self.transport:_seek_to_region(self.trigger_region.target_rid, Recorder.SEEK.QUANTIZE)
     end
 
     self:_cleanup_trigger()
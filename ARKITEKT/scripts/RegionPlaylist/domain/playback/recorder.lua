@@ -0,0 +1,221 @@
+-- @noindex
+-- RegionPlaylist/domain/playback/recorder.lua
+-- Record mode: log engine inputs and decisions to a binary ring file
+--
+-- Every engine step is logged with what it saw and what it decided, so a
+-- sync problem caught during a show can be replayed offline (replay.lua,
+-- tools/trace_replay.lua) against a fixed engine.
+--
+-- RECORDS (one 32-byte slot each, see data/trace_file.lua):
+--   'F' frame    - Engine:update() input: time, play position, play state,
+--                  loop playlist / transport override flags
+--   'U' command  - user command (COMMAND ids) with its time and argument
+--   'K' seek     - seek issued during the step: time, region, SEEK method
+--   'D' decision - current/next index, pointer, transport flags and queued
+--                  GoToRegion target after the step (only when changed)
+--   'C' context  - regions, sequence and engine indices, split over slots;
+--                  written when the sequence or regions change, and again
+--                  every context_interval records so a wrapped ring still
+--                  starts with one
+-- Item keys are written as small ids (first use order), so a trace carries
+-- no playlist or region names.
+--
+-- WRITER (passed in; data/trace_file.lua create() in the app):
+--   writer:write(tag, payload) -> seq   writer:flush()   writer:close()
+--   writer.capacity, writer.payload_size, writer.seq
+
+
+local pack = string.pack
+
+local M = {}
+
+-- Seek methods ('K' records)
+M.SEEK = {
+  GOTO = 1,        -- Smooth seek: GoToRegion
+  THROTTLED = 2,   -- GoToRegion dropped by the seek throttle
+  START = 3,       -- Fresh start: edit cursor to region start + play
+  QUANTIZE = 4,    -- Quantized jump fired by the trigger region
+}
+
+-- User commands ('U' records)
+M.COMMAND = {
+  play = 1, stop = 2, pause = 3, next = 4, prev = 5,
+  seek_to_item = 6, set_next_item = 7,
+  jump_to_next_quantized = 8, schedule_seek_to_item = 9,
+}
+
+-- Decision flags ('D' records and contexts)
+M.FLAG_PLAYING = 1
+M.FLAG_PAUSED = 2
+M.FLAG_PLAYLIST_MODE = 4
+M.FLAG_GOTO_QUEUED = 8
+
+-- Frame flags ('F' records)
+M.FRAME_LOOP_PLAYLIST = 1
+M.FRAME_TRANSPORT_OVERRIDE = 2
+
+M.FORMATS = {
+  F = '<ddBB',
+  U = '<dBi4',
+  K = '<di4B',
+  D = '<i4i4i4Bi4',
+  C = '<I4I2I2B',
+  context_head = '<i4i4i4Bi4dd',
+  context_region = '<i4dd',
+  context_entry = '<i4I2I2I4',
+}
+
+local Recorder = {}
+Recorder.__index = Recorder
+
+--- Start recording through a trace writer
+--- @param opts table {writer, context_interval}
+--- @return table recorder
+function M.new(opts)
+  local writer = opts.writer
+  return setmetatable({
+    writer = writer,
+    context_data = writer.payload_size - string.packsize(M.FORMATS.C),  -- Context bytes per 'C' slot
+    context_interval = opts.context_interval or writer.capacity // 8,
+    context_id = 0,
+    context_seq = 0,          -- seq of the last context written
+    sequence_version = nil,
+    region_cache = nil,
+    key_ids = {},
+    next_key_id = 1,
+    last_decision = {},
+    last_flush = 0,
+  }, Recorder)
+end
+
+function Recorder:_key_id(key)
+  if key == nil then return 0 end
+  local id = self.key_ids[key]
+  if not id then
+    id = self.next_key_id
+    self.next_key_id = id + 1
+    self.key_ids[key] = id
+  end
+  return id
+end
+
+local function decision_of(engine)
+  local state, transport = engine.state, engine.transport
+  local flags = (transport.is_playing and M.FLAG_PLAYING or 0)
+    | (transport.is_paused and M.FLAG_PAUSED or 0)
+    | (transport._playlist_mode and M.FLAG_PLAYLIST_MODE or 0)
+    | (state.goto_region_queued and M.FLAG_GOTO_QUEUED or 0)
+  return state.current_idx, state.next_idx, state.playlist_pointer, flags, state.goto_region_target or 0
+end
+
+function Recorder:_write_context(engine)
+  local state = engine.state
+  local current, next_idx, pointer, flags, target = decision_of(engine)
+  local parts = { pack(M.FORMATS.context_head, current, next_idx, pointer, flags, target,
+    state.last_play_pos or -1, engine.transport.last_seek_time or 0) }
+
+  local rids = {}
+  for rid in pairs(state.region_cache) do rids[#rids + 1] = rid end
+  table.sort(rids)
+  parts[#parts + 1] = pack('<I4', #rids)
+  for _, rid in ipairs(rids) do
+    local region = state.region_cache[rid]
+    parts[#parts + 1] = pack(M.FORMATS.context_region, rid, region.start, region['end'])
+  end
+
+  parts[#parts + 1] = pack('<I4', #state.sequence)
+  for _, entry in ipairs(state.sequence) do
+    parts[#parts + 1] = pack(M.FORMATS.context_entry, entry.rid, entry.loop, entry.total_loops, self:_key_id(entry.item_key))
+  end
+
+  local blob = table.concat(parts)
+  local size = self.context_data
+  local count = math.max(1, -(-#blob // size))
+  for part = 1, count do
+    local data = blob:sub((part - 1) * size + 1, part * size)
+    self.writer:write('C', pack(M.FORMATS.C, self.context_id, part, count, #data) .. data)
+  end
+  self.context_seq = self.writer.seq
+  self:_remember_decision(current, next_idx, pointer, flags, target)
+end
+
+-- True if the decision differs from the last one written (and remembers it)
+function Recorder:_remember_decision(...)
+  local last = self.last_decision
+  local changed = false
+  for i = 1, 5 do
+    local v = select(i, ...)
+    if last[i] ~= v then
+      last[i] = v
+      changed = true
+    end
+  end
+  return changed
+end
+
+--- Write a context when the sequence or regions changed since the last one
+--- @param engine table Playback engine (controller.lua)
+function Recorder:sync_context(engine)
+  local state = engine.state
+  if state.sequence_version ~= self.sequence_version or state.region_cache ~= self.region_cache then
+    self.sequence_version = state.sequence_version
+    self.region_cache = state.region_cache
+    self.context_id = self.context_id + 1
+    self:_write_context(engine)
+  end
+end
+
+-- Repeat the current context once enough records went by since the last
+function Recorder:_refresh_context(engine)
+  if self.context_id > 0 and self.writer.seq - self.context_seq >= self.context_interval then
+    self:_write_context(engine)
+  end
+end
+
+--- Log the input of one Engine:update() (call before it runs)
+--- @param engine table
+--- @param frame table {time, playpos, play_state} as read by the engine for this update
+function Recorder:begin_frame(engine, frame)
+  self:_refresh_context(engine)
+  local transport = engine.transport
+  local flags = (transport.loop_playlist and M.FRAME_LOOP_PLAYLIST or 0)
+    | (transport.transport_override and M.FRAME_TRANSPORT_OVERRIDE or 0)
+  self.writer:write('F', pack(M.FORMATS.F, frame.time, frame.playpos, frame.play_state, flags))
+end
+
+--- Log a user command (call before it runs)
+--- @param engine table
+--- @param name string Key of COMMAND
+--- @param key string|nil Item key argument
+function Recorder:begin_command(engine, name, key)
+  self:_refresh_context(engine)
+  self.writer:write('U', pack(M.FORMATS.U, reaper.time_precise(), M.COMMAND[name], self:_key_id(key)))
+  self:sync_context(engine)
+end
+
+--- Log a seek decision
+--- @param rid number Region number
+--- @param method number SEEK method
+function Recorder:seek(rid, method)
+  self.writer:write('K', pack(M.FORMATS.K, reaper.time_precise(), rid, method))
+end
+
+--- Log the engine decision after a frame or command, if it changed
+--- @param engine table
+function Recorder:end_step(engine)
+  if self:_remember_decision(decision_of(engine)) then
+    self.writer:write('D', pack(M.FORMATS.D, decision_of(engine)))
+  end
+
+  local now = reaper.time_precise()
+  if now - self.last_flush > 1 then
+    self.writer:flush()
+    self.last_flush = now
+  end
+end
+
+function Recorder:close()
+  self.writer:close()
+end
+
+return M
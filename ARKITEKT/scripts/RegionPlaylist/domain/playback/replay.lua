@@ -0,0 +1,306 @@
+-- @noindex
+-- RegionPlaylist/domain/playback/replay.lua
+-- Replay a recorded trace (recorder.lua) through the engine offline and diff
+-- its decisions against the recorded ones
+--
+-- Runs without REAPER: a stand-in host answers the engine's transport calls
+-- from the trace (time, play position and state per frame; regions from the
+-- context). Replay starts at the first context in the trace (older records
+-- of a wrapped ring are skipped), then runs every frame and command in order
+-- and compares after each step:
+--   seek  - seeks issued (region, method), in order
+--   state - current/next index, pointer, flags, queued GoToRegion target
+-- With opts.resync (default) the engine adopts the recorded decision after a
+-- difference, so each reported diff is one decision and not its fallout.
+--
+-- Quantized jumps need the tempo map and trigger region, which a trace does
+-- not carry: jump_to_next_quantized and schedule_seek_to_item (a quantized
+-- jump to a chosen item) are counted as unsupported and skipped. The engine
+-- carries on from the state the recording decided after them, but the seek
+-- they queued is not replayed or compared.
+
+local Recorder = require('RegionPlaylist.domain.playback.recorder')
+
+local unpack = string.unpack
+local FORMATS = Recorder.FORMATS
+
+local M = {}
+
+local COMMAND_NAMES = {}
+for name, id in pairs(Recorder.COMMAND) do COMMAND_NAMES[id] = name end
+
+local UNSUPPORTED = {
+  jump_to_next_quantized = true,
+  schedule_seek_to_item = true,
+}
+
+local STATE_FIELDS = { 'current_idx', 'next_idx', 'playlist_pointer', 'flags', 'goto_target' }
+
+-- ============================================================================
+-- TRACE DECODING
+-- ============================================================================
+
+local function key_name(id)
+  return id > 0 and ('k' .. id) or nil
+end
+
+--- Decode trace records into events; 'C' slots are joined into contexts
+--- @param records table Array of {tag, seq, payload} (data/trace_file.lua read())
+--- @return table events Array of {kind, seq, ...}
+function M.decode(records)
+  local events = {}
+  local parts, parts_id = nil, nil
+  for _, rec in ipairs(records) do
+    local tag, payload = rec.tag, rec.payload
+    if tag == 'F' then
+      local time, playpos, play_state, flags = unpack(FORMATS.F, payload)
+      events[#events + 1] = { kind = 'frame', seq = rec.seq, time = time, playpos = playpos,
+        play_state = play_state, flags = flags }
+    elseif tag == 'U' then
+      local time, command, key_id = unpack(FORMATS.U, payload)
+      events[#events + 1] = { kind = 'command', seq = rec.seq, time = time,
+        command = COMMAND_NAMES[command] or tostring(command), key = key_name(key_id) }
+    elseif tag == 'K' then
+      local time, rid, method = unpack(FORMATS.K, payload)
+      events[#events + 1] = { kind = 'seek', seq = rec.seq, time = time, rid = rid, method = method }
+    elseif tag == 'D' then
+      local current, next_idx, pointer, flags, target = unpack(FORMATS.D, payload)
+      events[#events + 1] = { kind = 'decision', seq = rec.seq, state = { current, next_idx, pointer, flags, target } }
+    elseif tag == 'C' then
+      local id, part, count, len, pos = unpack(FORMATS.C, payload)
+      if part == 1 then
+        parts, parts_id = {}, id
+      end
+      -- A context whose first slots were overwritten by the ring is dropped
+      if parts and parts_id == id and #parts == part - 1 then
+        parts[part] = payload:sub(pos, pos + len - 1)
+        if part == count then
+          events[#events + 1] = M.decode_context(id, table.concat(parts), rec.seq)
+          parts = nil
+        end
+      else
+        parts = nil
+      end
+    end
+  end
+  return events
+end
+
+--- Decode a context blob
+function M.decode_context(id, blob, seq)
+  local current, next_idx, pointer, flags, target, last_play_pos, last_seek_time, pos =
+    unpack(FORMATS.context_head, blob)
+  local regions, sequence = {}, {}
+  local count
+  count, pos = unpack('<I4', blob, pos)
+  for i = 1, count do
+    local rid, start_pos, end_pos
+    rid, start_pos, end_pos, pos = unpack(FORMATS.context_region, blob, pos)
+    regions[i] = { rid = rid, start = start_pos, ['end'] = end_pos }
+  end
+  count, pos = unpack('<I4', blob, pos)
+  for i = 1, count do
+    local rid, loop, total_loops, key_id
+    rid, loop, total_loops, key_id, pos = unpack(FORMATS.context_entry, blob, pos)
+    sequence[i] = { rid = rid, loop = loop, total_loops = total_loops, item_key = key_name(key_id) }
+  end
+  return {
+    kind = 'context', id = id, seq = seq,
+    state = { current, next_idx, pointer, flags, target },
+    last_play_pos = last_play_pos, last_seek_time = last_seek_time,
+    regions = regions, sequence = sequence,
+  }
+end
+
+-- ============================================================================
+-- STAND-IN HOST
+-- ============================================================================
+
+-- Just the calls the engine makes while stepping; inputs come from the trace
+local function make_host()
+  local host = { time = 0, play_state = 0, play_position = 0, cursor = 0, regions = {} }
+  local api = {}
+  function api.time_precise() return host.time end
+  function api.GetPlayStateEx() return host.play_state end
+  function api.GetPlayPositionEx() return host.play_position end
+  function api.GetCursorPositionEx() return host.cursor end
+  function api.SetEditCurPos2(_, pos) host.cursor = pos end
+  function api.GoToRegion() end
+  function api.OnPlayButton() host.play_state = 1 end
+  function api.OnStopButton() host.play_state = 0 end
+  function api.OnPauseButton() host.play_state = 2 end
+  function api.PreventUIRefresh() end
+  function api.UpdateTimeline() end
+  function api.GetProjectStateChangeCount() return 0 end
+  function api.GetToggleCommandState() return -1 end
+  function api.Main_OnCommand() end
+  function api.CountProjectMarkers() return #host.regions, 0, #host.regions end
+  function api.EnumProjectMarkers3(_, i)
+    local region = host.regions[i + 1]
+    if not region then return 0 end
+    return i + 1, true, region.start, region['end'], '', region.rid, 0
+  end
+  function api.GetSetProjectInfo_String() return false, '' end
+  function api.ShowConsoleMsg() end
+  host.api = api
+  return host
+end
+
+-- ============================================================================
+-- REPLAY
+-- ============================================================================
+
+local function engine_state(engine)
+  local state, transport = engine.state, engine.transport
+  local flags = (transport.is_playing and Recorder.FLAG_PLAYING or 0)
+    | (transport.is_paused and Recorder.FLAG_PAUSED or 0)
+    | (transport._playlist_mode and Recorder.FLAG_PLAYLIST_MODE or 0)
+    | (state.goto_region_queued and Recorder.FLAG_GOTO_QUEUED or 0)
+  return { state.current_idx, state.next_idx, state.playlist_pointer, flags, state.goto_region_target or 0 }
+end
+
+local function adopt_state(engine, decided)
+  local state, transport = engine.state, engine.transport
+  state.current_idx, state.next_idx, state.playlist_pointer = decided[1], decided[2], decided[3]
+  local flags = decided[4]
+  transport.is_playing = flags & Recorder.FLAG_PLAYING ~= 0
+  transport.is_paused = flags & Recorder.FLAG_PAUSED ~= 0
+  transport._playlist_mode = flags & Recorder.FLAG_PLAYLIST_MODE ~= 0
+  state.goto_region_queued = flags & Recorder.FLAG_GOTO_QUEUED ~= 0
+  state.goto_region_target = decided[5] ~= 0 and decided[5] or nil
+  state:update_bounds()
+end
+
+local function load_context(engine, host, context)
+  host.regions = context.regions
+  engine.state:rescan()
+  engine.state:set_sequence(context.sequence)
+end
+
+--- Replay decoded events through a fresh engine
+--- @param events table From decode()
+--- @param opts table|nil {resync = true}
+--- @return table report {steps, frames, commands, unsupported, skipped, seeks, diffs}
+function M.run(events, opts)
+  opts = opts or {}
+  local resync = opts.resync ~= false
+  local report = { steps = 0, frames = 0, commands = 0, unsupported = 0, skipped = 0, seeks = 0, diffs = {} }
+
+  local host = make_host()
+  local previous = reaper
+  reaper = host.api
+
+  local ok, err = pcall(function()
+    local Controller = require('RegionPlaylist.domain.playback.controller')
+    local engine, context_id
+    local expected_state          -- Last recorded decision
+    local pending                 -- Step waiting for its recorded seeks/decision
+    local seeks = {}
+
+    local collector = {}
+    function collector.seek(_, rid, method)
+      seeks[#seeks + 1] = { rid = rid, method = method }
+    end
+
+    local function diff(step, kind, field, recorded, replayed)
+      report.diffs[#report.diffs + 1] = { seq = step.seq, time = step.time, step = step.kind == 'frame' and 'frame' or step.command,
+        kind = kind, field = field, recorded = recorded, replayed = replayed }
+    end
+
+    local function finish(step)
+      if not step then return end
+      local expected_seeks = step.seeks
+      for i = 1, math.max(#expected_seeks, #seeks) do
+        local a, b = expected_seeks[i], seeks[i]
+        if not a or not b or a.rid ~= b.rid or a.method ~= b.method then
+          diff(step, 'seek', i, a and (a.rid .. '/' .. a.method) or 'none', b and (b.rid .. '/' .. b.method) or 'none')
+        end
+      end
+      if step.decision then expected_state = step.decision end
+
+      local replayed = engine_state(engine)
+      local diverged = false
+      for i, field in ipairs(STATE_FIELDS) do
+        if replayed[i] ~= expected_state[i] then
+          diff(step, 'state', field, expected_state[i], replayed[i])
+          diverged = true
+        end
+      end
+      if diverged and resync then adopt_state(engine, expected_state) end
+    end
+
+    -- Skipped command: carry on from what it decided
+    local function skip(step)
+      if step.decision then
+        expected_state = step.decision
+        adopt_state(engine, expected_state)
+      end
+    end
+
+    local function run(step)
+      for i = #seeks, 1, -1 do seeks[i] = nil end
+      host.time = step.time
+      if step.kind == 'frame' then
+        report.frames = report.frames + 1
+        host.play_position = step.playpos
+        host.play_state = step.play_state
+        engine.transport.loop_playlist = step.flags & Recorder.FRAME_LOOP_PLAYLIST ~= 0
+        engine.transport.transport_override = step.flags & Recorder.FRAME_TRANSPORT_OVERRIDE ~= 0
+        engine:update()
+      else
+        report.commands = report.commands + 1
+        local name = step.command
+        if UNSUPPORTED[name] or not engine[name] then
+          report.unsupported = report.unsupported + 1
+          return false
+        end
+        engine[name](engine, step.key)
+      end
+      report.steps = report.steps + 1
+      report.seeks = report.seeks + #seeks
+      return true
+    end
+
+    for _, event in ipairs(events) do
+      local kind = event.kind
+      if kind == 'context' then
+        if not engine then
+          host.regions = event.regions
+          host.time = 0
+          engine = Controller.new({ proj = 0 })
+          engine.transport.recorder = collector
+          load_context(engine, host, event)
+          adopt_state(engine, event.state)
+          engine.state.last_play_pos = event.last_play_pos
+          engine.transport.last_seek_time = event.last_seek_time
+          expected_state = event.state
+          context_id = event.id
+        elseif event.id ~= context_id then
+          load_context(engine, host, event)
+          context_id = event.id
+        end
+      elseif not engine then
+        report.skipped = report.skipped + 1
+      elseif kind == 'frame' or kind == 'command' then
+        if pending then
+          if run(pending) then finish(pending) else skip(pending) end
+        end
+        pending = event
+        event.seeks = {}
+      elseif pending and kind == 'seek' then
+        pending.seeks[#pending.seeks + 1] = event
+      elseif pending and kind == 'decision' then
+        pending.decision = event.state
+      end
+    end
+    if pending then
+      if run(pending) then finish(pending) else skip(pending) end
+    end
+  end)
+
+  reaper = previous
+  if not ok then error(err, 0) end
+  return report
+end
+
+return M
@@ -5,6 +5,7 @@
 local Regions = require('arkitekt.reaper.regions')
 local Transport = require('arkitekt.reaper.transport')
 local Logger = require('arkitekt.debug.logger')
+local Trace = require('arkitekt.debug.trace')
 
 -- Performance: Localize math and table functions for hot loops (region lookup, shuffling)
 local max = math.max
@@ -13,9 +14,6 @@ local floor = math.floor
 local random = math.random
 local insert = table.insert
 
--- Set to true for verbose sequence building logs
-local DEBUG_SEQUENCE = false
-
 local M = {}
 local State = {}
 State.__index = State
@@ -44,6 +42,7 @@ function M.new(opts)
   self.current_bounds = {start_pos = 0, end_pos = -1}
   self.next_bounds = {start_pos = 0, end_pos = -1}
   self.last_play_pos = -1
+  self.frame = nil          -- {time, playpos, play_state} while Engine:update() runs
 
   self.boundary_epsilon = 0.01
 
@@ -127,6 +126,7 @@ end
 
 function State:set_sequence(sequence)
   sequence = sequence or {}
+  local span = Trace.begin('state', 'set_sequence', 'entries', #sequence)
 
   local previous_pointer_key = nil
   local previous_current = nil
@@ -149,7 +149,7 @@ function State:set_sequence(sequence)
   self.playlist_metadata = {}
   self.sequence_lookup_by_key = {}
 
-  if DEBUG_SEQUENCE then Logger.debug('STATE', 'Building sequence from %d entries...', #sequence) end
+  local dropped = 0
   for _, entry in ipairs(sequence) do
     local rid = entry.rid
     if rid and self.region_cache[rid] then
@@ -164,11 +164,6 @@ function State:set_sequence(sequence)
         normalized.loop = normalized.total_loops
       end
 
-      if DEBUG_SEQUENCE then
-        Logger.debug('STATE', '✓ Entry #%d: rid=%d key=%s loop=%d/%d',
-          #self.sequence + 1, rid, tostring(entry.item_key), normalized.loop, normalized.total_loops)
-      end
-
       self.sequence[#self.sequence + 1] = normalized
       self.playlist_order[#self.playlist_order + 1] = rid
 
@@ -182,9 +177,9 @@ function State:set_sequence(sequence)
 
       if normalized.item_key and not self.sequence_lookup_by_key[normalized.item_key] then
         self.sequence_lookup_by_key[normalized.item_key] = #self.sequence
-        if DEBUG_SEQUENCE then Logger.debug('STATE', "Lookup: '%s' -> idx %d", normalized.item_key, #self.sequence) end
       end
     else
+      dropped = dropped + 1
       Logger.warn('STATE', '✗ DROPPED: rid=%s (not in region_cache) key=%s', tostring(rid), tostring(entry.item_key))
     end
   end
@@ -196,13 +191,6 @@ function State:set_sequence(sequence)
     Logger.info('STATE', 'Shuffle applied to sequence')
   end
 
-  if DEBUG_SEQUENCE then
-    Logger.debug('STATE', 'playlist_order:')
-    for i, rid in ipairs(self.playlist_order) do
-      Logger.debug('STATE', '  [%d] rid=%d', i, rid)
-    end
-  end
-
   local function resolve_index_by_entry(entry)
     if not entry then return nil end
     if entry.item_key and self.sequence_lookup_by_key[entry.item_key] then
@@ -258,6 +246,7 @@ function State:set_sequence(sequence)
 
   self.sequence_version = self.sequence_version + 1
   self:update_bounds()
+  Trace.finish(span, 'items', #self.sequence, 'dropped', dropped)
 end
 
 function State:get_current_rid()
@@ -298,8 +287,6 @@ function State:update_bounds()
 end
 
 function State:find_index_at_position(pos, preferred_key)
-  if DEBUG_SEQUENCE then Logger.debug('STATE', 'find_index_at_position(%.3f, key=%s) scanning %d entries...', pos, tostring(preferred_key), #self.playlist_order) end
-
   -- First: try preferred_key if provided (resolves multi-loop ambiguity)
   if preferred_key then
     local idx = self.sequence_lookup_by_key[preferred_key]
@@ -309,7 +296,6 @@ function State:find_index_at_position(pos, preferred_key)
       if region then
         local in_bounds = pos >= region.start and pos < region['end'] - 1e-9
         if in_bounds then
-          if DEBUG_SEQUENCE then Logger.debug('STATE', 'Preferred key match at idx %d', idx) end
           return idx
         end
       end
@@ -322,17 +308,11 @@ function State:find_index_at_position(pos, preferred_key)
     local region = self:get_region_by_rid(rid)
     if region then
       local in_bounds = pos >= region.start and pos < region['end'] - 1e-9
-      if DEBUG_SEQUENCE then
-        Logger.debug('STATE', '  [%d] rid=%d bounds=[%.3f-%.3f] in_bounds=%s',
-          i, rid, region.start, region['end'], tostring(in_bounds))
-      end
       if in_bounds then
-        if DEBUG_SEQUENCE then Logger.debug('STATE', 'Returning idx %d', i) end
         return i
       end
     end
   end
-  if DEBUG_SEQUENCE then Logger.debug('STATE', 'No index found, returning -1') end
   return -1
 end
 
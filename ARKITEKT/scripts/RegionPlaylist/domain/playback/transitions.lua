@@ -4,6 +4,7 @@
 -- MODIFIED: Integrated Logger for debug output
 
 local Logger = require('arkitekt.debug.logger')
+local Trace = require('arkitekt.debug.trace')
 
 -- Performance: Localize math functions for hot path (runs every frame during playback)
 local max = math.max
@@ -11,20 +12,19 @@ local min = math.min
 local abs = math.abs
 local floor = math.floor
 
--- Set to true for per-frame playback position logging (very verbose!)
-local DEBUG_PLAYPOS = false
-
 local M = {}
 local Transitions = {}
 Transitions.__index = Transitions
 
-local function _is_playing(proj)
-  proj = proj or 0
-  local st = reaper.GetPlayStateEx(proj)
+-- frame: inputs the engine read for the update in progress (state.frame),
+-- nil outside Engine:update() (user commands read the transport live)
+local function _is_playing(proj, frame)
+  local st = frame and frame.play_state or reaper.GetPlayStateEx(proj or 0)
   return (st & 1) == 1
 end
 
-local function _get_play_pos(proj)
+local function _get_play_pos(proj, frame)
+  if frame then return frame.playpos end
   return reaper.GetPlayPositionEx(proj or 0)
 end
 
@@ -41,10 +41,10 @@ function M.new(opts)
 end
 
 function Transitions:handle_smooth_transitions()
-  if not _is_playing(self.proj) then return end
+  if not _is_playing(self.proj, self.state.frame) then return end
   if #self.state.playlist_order == 0 then return end
 
-  local playpos = _get_play_pos(self.proj)
+  local playpos = _get_play_pos(self.proj, self.state.frame)
 
   -- Live slot for playback position (updates in place, doesn't flood console)
   local curr_region = self.state.current_idx >= 1 and self.state:get_region_by_rid(self.state.playlist_order[self.state.current_idx])
@@ -55,13 +55,6 @@ function Transitions:handle_smooth_transitions()
     #self.state.playlist_order,
     region_name)
 
-  if DEBUG_PLAYPOS then
-    Logger.debug('TRANSITIONS', 'playpos=%.3f curr_idx=%d next_idx=%d curr_bounds=[%.3f-%.3f] next_bounds=[%.3f-%.3f]',
-      playpos, self.state.current_idx, self.state.next_idx,
-      self.state.current_bounds.start_pos, self.state.current_bounds.end_pos,
-      self.state.next_bounds.start_pos, self.state.next_bounds.end_pos)
-  end
-
   local curr_rid = self.state.current_idx >= 1 and self.state.playlist_order[self.state.current_idx] or nil
   local next_rid = self.state.next_idx >= 1 and self.state.playlist_order[self.state.next_idx] or nil
   local is_same_region = (curr_rid == next_rid and curr_rid ~= nil)
@@ -70,14 +63,14 @@ function Transitions:handle_smooth_transitions()
      not is_same_region and
      playpos >= self.state.next_bounds.start_pos and 
      playpos < self.state.next_bounds.end_pos + self.state.boundary_epsilon then
-    
-    if DEBUG_PLAYPOS then Logger.debug('TRANSITIONS', 'Branch 1: In next_bounds (different region)') end
-    
+
     local entering_different_region = (self.state.current_idx ~= self.state.next_idx)
     local playhead_went_backward = (playpos < self.state.last_play_pos - 0.1)
     
     if entering_different_region or playhead_went_backward then
       Logger.info('TRANSITIONS', 'TRANSITION FIRING: %d -> %d', self.state.current_idx, self.state.next_idx)
+      Trace.instant('transitions', 'transition', 'from', self.state.current_idx, 'to', self.state.next_idx,
+        'playpos', playpos)
       
       self.state.current_idx = self.state.next_idx
       self.state.playlist_pointer = self.state.current_idx
@@ -127,6 +120,8 @@ function Transitions:handle_smooth_transitions()
       
       if time_to_end <= 0.05 and time_to_end >= -0.01 then
         Logger.info('TRANSITIONS', 'TIME-BASED TRANSITION (same region): %d -> %d', self.state.current_idx, self.state.next_idx)
+        Trace.instant('transitions', 'repeat', 'from', self.state.current_idx, 'to', self.state.next_idx,
+          'playpos', playpos)
         
         self.state.current_idx = self.state.next_idx
         self.state.playlist_pointer = self.state.current_idx
@@ -165,12 +160,12 @@ function Transitions:handle_smooth_transitions()
     end
     
   else
-    if DEBUG_PLAYPOS then Logger.debug('TRANSITIONS', 'Branch 3: Out of bounds, syncing') end
-
+    -- Out of bounds: resync to the entry under the playhead
     -- Use current item_key as hint to resolve multi-loop ambiguity
     local current_key = self.state:get_current_item_key()
+    local span = Trace.begin('transitions', 'resync', 'playpos', playpos, 'key', current_key)
     local found_idx = self.state:find_index_at_position(playpos, current_key)
-    if DEBUG_PLAYPOS then Logger.debug('TRANSITIONS', 'find_index_at_position(%.3f, key=%s) returned: %d', playpos, tostring(current_key), found_idx) end
+    Trace.finish(span, 'found_idx', found_idx)
 
     if found_idx >= 1 then
       local was_uninitialized = (self.state.current_idx == -1)
@@ -3,6 +3,8 @@
 -- Transport control and seeking logic
 
 local Logger = require('arkitekt.debug.logger')
+local Recorder = require('RegionPlaylist.domain.playback.recorder')
+local Trace = require('arkitekt.debug.trace')
 
 local M = {}
 local Transport = {}
@@ -12,13 +14,15 @@ local function _has_sws()
   return (reaper.SNM_GetIntConfigVar ~= nil) and (reaper.SNM_SetIntConfigVar ~= nil)
 end
 
-local function _is_playing(proj)
-  proj = proj or 0
-  local st = reaper.GetPlayStateEx(proj)
+-- frame: inputs the engine read for the update in progress (state.frame),
+-- nil outside Engine:update() (user commands read the transport live)
+local function _is_playing(proj, frame)
+  local st = frame and frame.play_state or reaper.GetPlayStateEx(proj or 0)
   return (st & 1) == 1
 end
 
-local function _get_play_pos(proj)
+local function _get_play_pos(proj, frame)
+  if frame then return frame.playpos end
   return reaper.GetPlayPositionEx(proj or 0)
 end
 
@@ -113,18 +117,25 @@ function Transport:_leave_playlist_mode_if_needed()
   self._playlist_mode = false
 end
 
-function Transport:_seek_to_region(region_num)
-  local now = reaper.time_precise()
+--- @param region_num number Region number
+--- @param method number|nil Recorder.SEEK method for record mode (default GOTO)
+function Transport:_seek_to_region(region_num, method)
+  local frame = self.state.frame
+  local now = frame and frame.time or reaper.time_precise()
   if now - self.last_seek_time < self.seek_throttle then
+    if self.recorder then self.recorder:seek(region_num, Recorder.SEEK.THROTTLED) end
+    Trace.instant('transport', 'seek_throttled', 'rid', region_num)
     return false
   end
-  
+
+  local span = Trace.begin('transport', 'seek_region', 'rid', region_num)
   local cursor_pos = reaper.GetCursorPositionEx(self.proj)
   
   reaper.PreventUIRefresh(1)
   reaper.GoToRegion(self.proj, region_num, false)
+  if self.recorder then self.recorder:seek(region_num, method or Recorder.SEEK.GOTO) end
   
-  if not _is_playing(self.proj) then
+  if not _is_playing(self.proj, self.state.frame) then
     reaper.OnPlayButton()
   end
   
@@ -132,6 +143,7 @@ function Transport:_seek_to_region(region_num)
   reaper.PreventUIRefresh(-1)
   
   self.last_seek_time = now
+  Trace.finish(span)
   return true
 end
 
@@ -153,7 +165,7 @@ function Transport:play()
   -- Detect pause/resume: if is_paused flag is set, we're resuming
   local is_resuming = self.is_paused
 
-  if _is_playing(self.proj) then
+  if _is_playing(self.proj, self.state.frame) then
     Logger.info('TRANSPORT', "SEEK to region '%s' (RID %d) at %.2fs", region.name or '?', region.rid, region.start)
     local region_num = region.rid
     self:_seek_to_region(region_num)
@@ -168,6 +180,8 @@ function Transport:play()
       Logger.info('TRANSPORT', "PLAY '%s' (RID %d) from %.2fs", region.name or '?', region.rid, region.start)
       reaper.SetEditCurPos2(self.proj, region.start, false, false)
       reaper.OnPlayButton()
+      if self.recorder then self.recorder:seek(region.rid, Recorder.SEEK.START) end
+      Trace.instant('transport', 'seek_start', 'rid', region.rid)
       self.state.current_idx = -1
       self.state.next_idx = self.state.playlist_pointer
     end
@@ -222,7 +236,7 @@ function Transport:next()
   end
   self.state:update_bounds()
 
-  if _is_playing(self.proj) then
+  if _is_playing(self.proj, self.state.frame) then
     local rid = self.state:get_current_rid()
     local region = self.state:get_region_by_rid(rid)
     if region then
@@ -256,7 +270,7 @@ function Transport:prev()
   end
   self.state:update_bounds()
 
-  if _is_playing(self.proj) then
+  if _is_playing(self.proj, self.state.frame) then
     local rid = self.state:get_current_rid()
     local region = self.state:get_region_by_rid(rid)
     if region then
@@ -280,6 +294,13 @@ function Transport:seek_to_index(target_idx, immediate)
     return false
   end
 
+  local span = Trace.begin('transport', 'seek_item', 'idx', target_idx)
+  local ok = self:_seek_to_index(target_idx, immediate)
+  Trace.finish(span, 'ok', ok)
+  return ok
+end
+
+function Transport:_seek_to_index(target_idx, immediate)
   Logger.info('TRANSPORT', 'SEEK_TO_INDEX -> idx %d/%d (immediate=%s)', target_idx, #self.state.playlist_order, tostring(immediate))
 
   -- Update playlist pointer and sync indices
@@ -300,7 +321,7 @@ function Transport:seek_to_index(target_idx, immediate)
     meta.current_loop = 1
   end
 
-  if _is_playing(self.proj) then
+  if _is_playing(self.proj, self.state.frame) then
     local rid = self.state:get_current_rid()
     local region = self.state:get_region_by_rid(rid)
     if region then
@@ -314,27 +335,20 @@ function Transport:seek_to_index(target_idx, immediate)
 end
 
 --- Find playlist index by item key
+--- Uses the state's key -> index lookup (built with the sequence) instead of scanning
 --- @param key string Item key to find
 --- @return number|nil index Playlist index (1-based), or nil if not found
 function Transport:find_index_by_key(key)
   if not key then return nil end
-
-  -- Check sequence for key mapping
-  for i, entry in ipairs(self.state.sequence or {}) do
-    if entry.item_key == key then
-      return i
-    end
-  end
-
-  return nil
+  return self.state:find_index_by_key(key)
 end
 
 function Transport:poll_transport_sync()
   if not self.transport_override then return end
   if self.is_playing then return end
-  if not _is_playing(self.proj) then return end
+  if not _is_playing(self.proj, self.state.frame) then return end
   
-  local playpos = _get_play_pos(self.proj)
+  local playpos = _get_play_pos(self.proj, self.state.frame)
   
   for i, rid in ipairs(self.state.playlist_order) do
     local region = self.state:get_region_by_rid(rid)
@@ -441,7 +455,7 @@ function Transport:get_loop_playlist()
 end
 
 function Transport:check_stopped()
-  if not _is_playing(self.proj) then
+  if not _is_playing(self.proj, self.state.frame) then
     -- Don't treat pause as a stop - only clear state if we're not paused
     if self.is_playing and not self.is_paused then
       self.is_playing = false
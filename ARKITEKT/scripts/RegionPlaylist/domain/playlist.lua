@@ -9,6 +9,462 @@ local M = {}
 -- Set to true for verbose domain logging
 local DEBUG_DOMAIN = false
 
+-- ============================================================================
+-- ITEM POSITIONS
+-- ============================================================================
+-- Item arrays are mutated in place all over the controller (insert, remove,
+-- reorder), so positions are cached per items table and self-validated on
+-- lookup: a hit is O(1), a stale entry triggers one O(n) rebuild. A key the
+-- index does not have is only looked for again if the item count changed
+-- since the index was built; in-place removals call forget_index(), so the
+-- same count also means the same members (only their order can differ).
+
+local _positions = setmetatable({}, { __mode = 'k' })  -- items table -> {key -> index}
+local _indexed_count = setmetatable({}, { __mode = 'k' })  -- items table -> #items at build
+
+--- Build key -> index map for an items array
+--- @param items table Array of playlist items
+--- @return table positions Map of item key -> 1-based index
+function M.index_items(items)
+  local positions = {}
+  for i = 1, #items do
+    local key = items[i].key
+    if key then positions[key] = i end
+  end
+  _positions[items] = positions
+  _indexed_count[items] = #items
+  return positions
+end
+
+--- Drop the cached positions of an items array (call after removing items
+--- in place; appends, inserts and reorders are detected on lookup)
+--- @param items table Array of playlist items
+function M.forget_index(items)
+  _positions[items] = nil
+  _indexed_count[items] = nil
+end
+
+--- Get position of an item by key (O(1) amortized)
+--- @param items table Array of playlist items
+--- @param key string Item key
+--- @return number|nil index 1-based index, or nil if not present
+function M.find_item_index(items, key)
+  if not items or not key then return nil end
+  local positions = _positions[items]
+  local idx = positions and positions[key]
+  local item = idx and items[idx]
+  if item and item.key == key then
+    return idx
+  end
+  -- Not in an index built for the same members: not in the array
+  if positions and not idx and _indexed_count[items] == #items then
+    return nil
+  end
+  -- Missing or stale: rebuild once and retry
+  idx = M.index_items(items)[key]
+  return idx
+end
+
+--- Get positions for several keys in one pass
+--- @param items table Array of playlist items
+--- @param keys table Array of item keys
+--- @return table indices Array of 1-based indices (missing keys skipped), ascending
+function M.find_item_indices(items, keys)
+  local positions = M.index_items(items)
+  local indices = {}
+  for _, key in ipairs(keys) do
+    local idx = positions[key]
+    if idx then indices[#indices + 1] = idx end
+  end
+  table.sort(indices)
+  return indices
+end
+
+--- Compute the order after moving a set of items as one block
+--- Stable splice: moved items keep the order given in keys, everything else
+--- keeps its relative order. One O(n) pass regardless of selection size.
+--- @param items table Array of playlist items
+--- @param keys table Array of item keys to move (drag order)
+--- @param before_key string|nil Insert before this key (nil = append at end)
+--- @return table|nil new_items New array, or nil if the order would not change
+--- @return table|nil touched Items with new neighbours: the moved block and
+---   the item after each gap it leaves (for compact_around)
+function M.plan_move(items, keys, before_key)
+  local positions = M.index_items(items)
+
+  local moving = {}
+  local moved = {}
+  for _, key in ipairs(keys) do
+    local idx = positions[key]
+    if idx and not moving[key] then
+      moving[key] = true
+      moved[#moved + 1] = items[idx]
+    end
+  end
+  if #moved == 0 then return nil end
+
+  local out = {}
+  local touched = table.move(moved, 1, #moved, 1, {})
+  local inserted = false
+  local prev_moving = false
+  for i = 1, #items do
+    local item = items[i]
+    if not inserted and item.key == before_key then
+      for j = 1, #moved do out[#out + 1] = moved[j] end
+      inserted = true
+    end
+    if not moving[item.key] then
+      out[#out + 1] = item
+      if prev_moving then touched[#touched + 1] = item end
+      prev_moving = false
+    else
+      prev_moving = true
+    end
+  end
+  if not inserted then
+    for j = 1, #moved do out[#out + 1] = moved[j] end
+  end
+
+  for i = 1, #items do
+    if out[i] ~= items[i] then return out, touched end
+  end
+  return nil
+end
+
+--- Overwrite items in place with a planned order (keeps table identity)
+--- @param items table Array of playlist items (mutated)
+--- @param new_items table Array from plan_move
+function M.apply_order(items, new_items)
+  for i = 1, #new_items do
+    items[i] = new_items[i]
+  end
+  for i = #items, #new_items + 1, -1 do
+    items[i] = nil
+  end
+  M.index_items(items)
+end
+
+-- ============================================================================
+-- COMPACTION
+-- ============================================================================
+-- Adjacent items that play the same region back to back are equivalent to a
+-- single item with summed repeats. Compaction is applied locally: callers
+-- pass the touched range (or the touched items, see compact_around) and only
+-- their neighbours are inspected. If a playlist
+-- is kept compact, a local pass is all that is ever needed; normalize() is the
+-- bulk pass for data that arrives from outside (imports). Infinite loops
+-- (INFINITE_REPS) are never merged, and a merge never sums up to that count.
+
+M.INFINITE_REPS = 999  -- Infinite loop (SWS import); not a count to add to
+
+local function can_merge(a, b)
+  local a_reps, b_reps = a.reps or 1, b.reps or 1
+  return a.type == 'region' and b.type == 'region'
+     and a.rid == b.rid
+     and (a.enabled ~= false) == (b.enabled ~= false)
+     and a_reps > 0 and b_reps > 0
+     and a_reps + b_reps < M.INFINITE_REPS
+end
+
+--- Merge adjacent duplicates in and around [first, last]
+--- The first item of each run survives (keeps its key); reps are summed.
+--- @param items table Array of playlist items (mutated in place)
+--- @param first number|nil First touched index (default 1)
+--- @param last number|nil Last touched index (default #items)
+--- @return table removed_keys Keys of items merged away
+function M.compact_range(items, first, last)
+  local removed = {}
+  local n = #items
+  if n < 2 then return removed end
+
+  local lo = math.max(1, (first or 1) - 1)
+  local hi = math.min(n, (last or n) + 1)
+  if lo >= hi then return removed end
+
+  local w = lo
+  for r = lo + 1, hi do
+    local cur, item = items[w], items[r]
+    if can_merge(cur, item) then
+      cur.reps = (cur.reps or 1) + (item.reps or 1)
+      removed[#removed + 1] = item.key
+    else
+      w = w + 1
+      items[w] = item
+    end
+  end
+
+  local merged = #removed
+  if merged > 0 then
+    -- Shift the untouched tail once instead of per removal
+    table.move(items, hi + 1, n, w + 1)
+    for i = n, n - merged + 1, -1 do
+      items[i] = nil
+    end
+    M.forget_index(items)
+  end
+  return removed
+end
+
+--- Bulk compaction pass over a whole playlist (single O(n) pass)
+--- @param items table Array of playlist items (mutated in place)
+--- @return table removed_keys Keys of items merged away
+function M.normalize(items)
+  return M.compact_range(items, 1, #items)
+end
+
+--- Compact around the items an edit touched, wherever they ended up
+--- Touched positions are sorted and grouped into runs; each run is compacted
+--- with compact_range, last run first so earlier positions stay valid.
+--- @param items table Array of playlist items (mutated in place, index current)
+--- @param touched table Array of items whose neighbours changed (items no
+---   longer in the array are skipped)
+--- @return table removed_keys Keys of items merged away
+function M.compact_around(items, touched)
+  local positions = _positions[items] or M.index_items(items)
+  local at = {}
+  for _, item in ipairs(touched) do
+    local idx = positions[item.key]
+    if idx and items[idx] == item then at[#at + 1] = idx end
+  end
+  table.sort(at)
+
+  local runs = {}  -- first, last pairs
+  for _, idx in ipairs(at) do
+    local last = runs[#runs]
+    if last and idx <= last + 1 then
+      runs[#runs] = idx
+    else
+      runs[#runs + 1] = idx
+      runs[#runs + 1] = idx
+    end
+  end
+
+  local removed = {}
+  for r = #runs - 1, 1, -2 do
+    for _, key in ipairs(M.compact_range(items, runs[r], runs[r + 1])) do
+      removed[#removed + 1] = key
+    end
+  end
+  return removed
+end
+
+-- ============================================================================
+-- BATCH EDITS
+-- ============================================================================
+-- A batch is an ordered list of edit operations applied to one playlist as a
+-- single transaction. All edits are validated before anything is touched, so
+-- a rejected batch leaves the playlist unchanged; apply_edits works on a copy
+-- of the array and defers field writes, so an error part way through leaves
+-- it unchanged too. Callers wrap the apply in a single undo snapshot +
+-- persist + resync.
+--
+-- OPERATIONS:
+--   { op = 'clear' }
+--   { op = 'insert', items = { {rid=N} | {type='playlist', playlist_id=ID}, ... },
+--     index = N|nil }                       -- reps/enabled optional per item
+--   { op = 'remove', keys = {...} }
+--   { op = 'set_reps', keys = {...}|nil, reps = N }     -- nil keys = all items
+--   { op = 'set_enabled', keys = {...}|nil, enabled = bool }
+--   { op = 'move', keys = {...}, before = key|nil }
+
+local function is_integer(value)
+  return math.type(value) == 'integer' or (type(value) == 'number' and value % 1 == 0)
+end
+
+local EDIT_OPS = {
+  clear = true, insert = true, remove = true,
+  set_reps = true, set_enabled = true, move = true,
+}
+
+--- Validate a batch without applying it
+--- @param edits table Array of edit operations
+--- @return boolean ok
+--- @return string|nil error Description of the first invalid edit
+function M.validate_edits(edits)
+  if type(edits) ~= 'table' then return false, 'edits must be an array' end
+  for i, edit in ipairs(edits) do
+    local op = type(edit) == 'table' and edit.op
+    if not EDIT_OPS[op] then
+      return false, string.format('edit %d: unknown op %s', i, tostring(op))
+    end
+    if op == 'insert' then
+      if type(edit.items) ~= 'table' then
+        return false, string.format('edit %d: insert needs items', i)
+      end
+      if edit.index ~= nil and not is_integer(edit.index) then
+        return false, string.format('edit %d: index must be an integer', i)
+      end
+      for j, spec in ipairs(edit.items) do
+        if type(spec) ~= 'table' then
+          return false, string.format('edit %d item %d: item must be a table', i, j)
+        end
+        if spec.type == 'playlist' then
+          if not spec.playlist_id then
+            return false, string.format('edit %d item %d: playlist_id required', i, j)
+          end
+        elseif type(spec.rid) ~= 'number' then
+          return false, string.format('edit %d item %d: rid required', i, j)
+        end
+        local reps = spec.reps
+        if reps ~= nil and not (is_integer(reps) and reps >= 1) then
+          return false, string.format('edit %d item %d: reps must be a positive integer', i, j)
+        end
+        if spec.enabled ~= nil and type(spec.enabled) ~= 'boolean' then
+          return false, string.format('edit %d item %d: enabled must be a boolean', i, j)
+        end
+      end
+    elseif op == 'remove' or op == 'move' then
+      if type(edit.keys) ~= 'table' then
+        return false, string.format('edit %d: %s needs keys', i, op)
+      end
+    elseif op == 'set_reps' then
+      if not (is_integer(edit.reps) and edit.reps >= 0) then
+        return false, string.format('edit %d: reps must be an integer >= 0', i)
+      end
+    elseif op == 'set_enabled' then
+      if edit.enabled ~= nil and type(edit.enabled) ~= 'boolean' then
+        return false, string.format('edit %d: enabled must be a boolean', i)
+      end
+    end
+    if (op == 'set_reps' or op == 'set_enabled') and edit.keys ~= nil and type(edit.keys) ~= 'table' then
+      return false, string.format('edit %d: keys must be an array', i)
+    end
+  end
+  return true
+end
+
+--- Check the nested playlists a batch inserts: each must exist and must
+--- not make the edited playlist (directly or through others) contain itself
+--- @param playlist_id string Playlist the batch edits
+--- @param edits table Validated edits
+--- @param has_playlist function fn(id) -> boolean
+--- @param detect_cycle function fn(target_id, added_id) -> boolean
+--- @return boolean ok
+--- @return string|nil error
+function M.validate_nested(playlist_id, edits, has_playlist, detect_cycle)
+  for _, edit in ipairs(edits) do
+    if edit.op == 'insert' then
+      for _, spec in ipairs(edit.items) do
+        if spec.type == 'playlist' then
+          if not has_playlist(spec.playlist_id) then
+            return false, 'Playlist not found: ' .. tostring(spec.playlist_id)
+          end
+          if detect_cycle(playlist_id, spec.playlist_id) then
+            return false, 'Circular dependency: ' .. tostring(spec.playlist_id)
+          end
+        end
+      end
+    end
+  end
+  return true
+end
+
+local function key_set(keys)
+  if not keys then return nil end
+  local set = {}
+  for _, k in ipairs(keys) do set[k] = true end
+  return set
+end
+
+--- Apply a validated batch to an items array in place
+--- @param items table Array of playlist items (mutated, identity kept)
+--- @param edits table Array of edit operations (see above)
+--- @param opts table {new_key = fn() -> string, describe_region = fn(rid) -> guid, name}
+--- @return table inserted_keys Keys of all inserted items, in insertion order
+--- @return table touched Items with new neighbours or new values (for compact_around)
+function M.apply_edits(items, edits, opts)
+  local target = items
+  items = table.move(target, 1, #target, 1, {})
+  local writes = {}   -- Deferred item field writes: item, field, value
+  local inserted_keys = {}
+  local touched = {}
+
+  for _, edit in ipairs(edits) do
+    local op = edit.op
+
+    if op == 'clear' then
+      for i = #items, 1, -1 do items[i] = nil end
+
+    elseif op == 'insert' then
+      local specs = edit.items
+      local k = #specs
+      local n = #items
+      local at = math.max(1, math.min(edit.index or (n + 1), n + 1))
+      -- Open the gap once, then fill it (no per-item shifting)
+      if at <= n then
+        table.move(items, at, n, at + k)
+      end
+      for j = 1, k do
+        local spec = specs[j]
+        local item = {
+          type = spec.type == 'playlist' and 'playlist' or 'region',
+          reps = spec.reps or 1,
+          enabled = spec.enabled ~= false,
+          key = opts.new_key(),
+        }
+        if item.type == 'playlist' then
+          item.playlist_id = spec.playlist_id
+        else
+          item.rid = spec.rid
+          if opts.describe_region then
+            item.guid, item.region_name = opts.describe_region(spec.rid)
+          end
+        end
+        items[at + j - 1] = item
+        inserted_keys[#inserted_keys + 1] = item.key
+        touched[#touched + 1] = item
+      end
+
+    elseif op == 'remove' then
+      local remove = key_set(edit.keys)
+      local n = #items
+      local w = 0
+      local prev_removed = false
+      for r = 1, n do
+        local item = items[r]
+        if not remove[item.key] then
+          w = w + 1
+          items[w] = item
+          -- Seam: the survivor after a removed run meets a new neighbour
+          if prev_removed then touched[#touched + 1] = item end
+          prev_removed = false
+        else
+          prev_removed = true
+        end
+      end
+      for i = n, w + 1, -1 do items[i] = nil end
+
+    elseif op == 'set_reps' or op == 'set_enabled' then
+      local only = key_set(edit.keys)
+      local field = op == 'set_reps' and 'reps' or 'enabled'
+      local value = op == 'set_reps' and edit.reps or (edit.enabled ~= false)
+      for i = 1, #items do
+        local item = items[i]
+        if not only or only[item.key] then
+          writes[#writes + 1] = item
+          writes[#writes + 1] = field
+          writes[#writes + 1] = value
+          touched[#touched + 1] = item
+        end
+      end
+
+    elseif op == 'move' then
+      local new_items, moved = M.plan_move(items, edit.keys, edit.before)
+      if new_items then
+        M.apply_order(items, new_items)
+        table.move(moved, 1, #moved, #touched + 1, touched)
+      end
+    end
+  end
+
+  -- Every edit applied: commit the field writes and the new order
+  for w = 1, #writes, 3 do
+    writes[w][writes[w + 1]] = writes[w + 2]
+  end
+  M.apply_order(target, items)
+  return inserted_keys, touched
+end
+
 --- Create a new playlist domain
 --- @return table domain The playlist domain instance
 function M.new()
@@ -171,6 +627,15 @@ function M.new()
     return region_count, playlist_count
   end
 
+  --- Get position of an item within a playlist
+  --- @param playlist_id string Playlist UUID
+  --- @param key string Item key
+  --- @return number|nil index 1-based index, or nil if not found
+  function domain:find_item_index(playlist_id, key)
+    local playlist = self.playlist_lookup[playlist_id]
+    return playlist and M.find_item_index(playlist.items, key)
+  end
+
   --- Notify that playlists changed (rebuilds lookup)
   function domain:mark_changed()
     rebuild_lookup()
@@ -0,0 +1,135 @@
+-- @noindex
+-- RegionPlaylist/domain/playlist_audit.lua
+-- Preflight audit of SWS region playlists against project regions/markers
+-- (business logic, no REAPER API; used by tools/rpp_analyzer.lua, which
+-- parses the project with data/rpp_scan.lua)
+--
+-- Mirrors the SWS RegionPlaylist semantics:
+--   length   - GetLength(): sum of (region length * loop count) over items
+--              with a positive loop count and an existing region
+--   infinite - IsInfinite(): any item with a negative (infinite) loop count
+-- and the PlaylistPlay() preflight warnings:
+--   nested         - another region starts/ends inside a played region
+--   short          - played region shorter than opts.min_length
+--   unsafe_markers - markers inside a played region (smooth seek stops there)
+--   missing        - item refers to a region that does not exist
+
+local Overlap = require('RegionPlaylist.domain.overlap')
+local Trace = require('arkitekt.debug.trace')
+
+local M = {}
+
+M.DEFAULT_MIN_LENGTH = 0.5  -- Seconds
+
+-- Same tolerance as overlap.lua: touching edges are not "inside"
+local FUDGE_FACTOR = 0.001
+
+--- Index project regions/markers for repeated playlist audits
+--- @param regions table Array of {rid, name, start, end}
+--- @param markers table Array of {number, name, pos}
+--- @return table project
+function M.build_project(regions, markers)
+  local by_number = {}
+  for _, region in ipairs(regions) do
+    if not by_number[region.rid] then
+      by_number[region.rid] = region
+    end
+  end
+
+  local sorted = {}
+  for i, marker in ipairs(markers) do sorted[i] = marker end
+  table.sort(sorted, function(a, b) return a.pos < b.pos end)
+
+  local span = Trace.begin('preflight', 'overlaps', 'regions', #regions)
+  local overlap_map = Overlap.find_overlaps(by_number)
+  Trace.finish(span)
+
+  return {
+    by_number = by_number,
+    overlap_map = overlap_map,
+    markers = sorted,
+  }
+end
+
+-- Markers strictly inside (start, end), via binary search on position
+local function markers_inside(markers, start_pos, end_pos)
+  local lo, hi = 1, #markers + 1
+  local from = start_pos + FUDGE_FACTOR
+  while lo < hi do
+    local mid = (lo + hi) // 2
+    if markers[mid].pos < from then lo = mid + 1 else hi = mid end
+  end
+
+  local found
+  local limit = end_pos - FUDGE_FACTOR
+  for i = lo, #markers do
+    local marker = markers[i]
+    if marker.pos > limit then break end
+    found = found or {}
+    found[#found + 1] = marker.number
+  end
+  return found
+end
+
+--- Audit one parsed SWS playlist (see rpp_scan.parse_sws_playlists)
+--- @param pl table Parsed playlist {name, is_active, sws_rgn_ids, region_numbers, sws_loop_counts,
+---   count, malformed_count}
+--- @param project table From build_project()
+--- @param opts table|nil {min_length = seconds}
+--- @return table result
+function M.analyze_playlist(pl, project, opts)
+  local min_length = opts and opts.min_length or M.DEFAULT_MIN_LENGTH
+  local by_number = project.by_number
+  local span = Trace.begin('preflight', 'analyze_playlist', 'items', pl.count)
+
+  local result = {
+    name = pl.name,
+    active = pl.is_active,
+    items = pl.count,
+    length = 0,
+    infinite = false,
+    malformed_lines = pl.malformed_count or 0,
+    findings = { missing = {}, nested = {}, short = {}, unsafe_markers = {} },
+  }
+  local findings = result.findings
+  local checked = {}
+
+  local ids, numbers, loops = pl.sws_rgn_ids, pl.region_numbers, pl.sws_loop_counts
+  for i = 1, pl.count do
+    local count = loops[i]
+    if count < 0 then
+      result.infinite = true
+    end
+
+    local number = numbers[i]
+    local region = number and by_number[number]
+    if not region then
+      findings.missing[#findings.missing + 1] = { entry = i, sws_id = ids[i] }
+    else
+      local region_length = region['end'] - region.start
+      if count > 0 then
+        result.length = result.length + region_length * count
+      end
+
+      if not checked[number] then
+        checked[number] = true
+        local nested = project.overlap_map[number]
+        if nested and #nested > 0 then
+          findings.nested[#findings.nested + 1] = { region = number, name = region.name, contains = nested }
+        end
+        if region_length < min_length then
+          findings.short[#findings.short + 1] = { region = number, name = region.name, length = region_length }
+        end
+        local inside = markers_inside(project.markers, region.start, region['end'])
+        if inside then
+          findings.unsafe_markers[#findings.unsafe_markers + 1] = { region = number, name = region.name, markers = inside }
+        end
+      end
+    end
+  end
+
+  Trace.finish(span, 'missing', #findings.missing, 'nested', #findings.nested)
+  return result
+end
+
+return M
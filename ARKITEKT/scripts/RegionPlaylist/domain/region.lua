@@ -3,6 +3,7 @@
 -- Manages region data cache and pool ordering
 
 local Logger = require('arkitekt.debug.logger')
+local RegionSearch = require('RegionPlaylist.domain.region_search')
 
 local M = {}
 
@@ -17,6 +18,8 @@ function M.new()
     guid_index = {},    -- Map: GUID (string) -> region object (for stable lookups)
     name_index = {},    -- Map: name (string) -> region object (fallback for renumbering)
     pool_order = {},    -- Array of RIDs defining custom pool order
+    regions = {},       -- Array of region objects in project order
+    search_index = nil, -- Lazy RegionSearch index (rebuilt after refresh)
   }
 
   if DEBUG_DOMAIN then
@@ -98,6 +101,8 @@ function M.new()
     self.guid_index = {}
     self.name_index = {}
     self.pool_order = {}
+    self.regions = regions
+    self.search_index = nil
 
     -- Rebuild from bridge data
     for _, region in ipairs(regions) do
@@ -118,6 +123,18 @@ function M.new()
     end
   end
 
+  --- Search regions by name substring or number prefix
+  --- @param query string Search text
+  --- @param limit number|nil Maximum number of matches
+  --- @return table matches Set of rid -> true
+  --- @return number count Number of matches
+  function domain:search(query, limit)
+    if not self.search_index then
+      self.search_index = RegionSearch.build(self.regions)
+    end
+    return RegionSearch.query(self.search_index, query, limit)
+  end
+
   --- Count regions
   --- @return number count Number of regions in index
   function domain:count()
@@ -0,0 +1,136 @@
+-- @noindex
+-- RegionPlaylist/domain/region_search.lua
+-- Search index over region names and numbers (pool search, active filter)
+--
+-- NAMES (substring):
+-- All lowercased names are joined into one haystack string, separated by
+-- '\n', with each region's start offset recorded. A query is a plain
+-- string.find over the haystack (C-speed scan), and each hit is mapped back
+-- to its region by binary search over the offsets. After a hit the scan
+-- resumes at the next region, so each region is reported at most once.
+-- Lowercasing happens once per refresh instead of once per region per query.
+--
+-- NUMBERS (prefix):
+-- A query of digits (optionally '#'-prefixed) also matches regions whose
+-- number starts with those digits. Number strings are kept sorted, so the
+-- matching block is found with two binary searches.
+--
+-- The index is immutable; rebuild it when the region list changes.
+
+local M = {}
+
+-- Performance: Localize string functions for hot path
+local find = string.find
+local lower = string.lower
+
+--- Build a search index
+--- @param regions table Array of region objects {rid, name, ...}
+--- @return table index
+function M.build(regions)
+  local rids = {}
+  local offsets = {}
+  local parts = {}
+  local pos = 1
+
+  for i, region in ipairs(regions) do
+    local name = lower(region.name or '')
+    rids[i] = region.rid
+    offsets[i] = pos
+    parts[i] = name
+    pos = pos + #name + 1  -- '\n' separator
+  end
+
+  -- Sorted number strings for prefix lookup
+  local numbers = {}
+  for i, region in ipairs(regions) do
+    numbers[i] = { text = tostring(region.rid), rid = region.rid }
+  end
+  table.sort(numbers, function(a, b) return a.text < b.text end)
+
+  return {
+    haystack = table.concat(parts, '\n'),
+    offsets = offsets,
+    rids = rids,
+    numbers = numbers,
+    count = #regions,
+  }
+end
+
+-- Index of the region whose name contains haystack position pos
+local function region_at(offsets, pos)
+  local lo, hi = 1, #offsets
+  while lo < hi do
+    local mid = (lo + hi + 1) // 2
+    if offsets[mid] <= pos then
+      lo = mid
+    else
+      hi = mid - 1
+    end
+  end
+  return lo
+end
+
+-- First index in sorted numbers whose text is >= prefix
+local function lower_bound(numbers, prefix)
+  local lo, hi = 1, #numbers + 1
+  while lo < hi do
+    local mid = (lo + hi) // 2
+    if numbers[mid].text < prefix then
+      lo = mid + 1
+    else
+      hi = mid
+    end
+  end
+  return lo
+end
+
+--- Find regions matching a query
+--- @param index table Index from M.build
+--- @param query string Search text (case-insensitive substring, or number prefix)
+--- @param limit number|nil Stop after this many matches
+--- @return table matches Set of rid -> true
+--- @return number count Number of matches
+function M.query(index, query, limit)
+  local matches = {}
+  local count = 0
+  limit = limit or math.huge
+  query = lower(query or '')
+  if query == '' or index.count == 0 then
+    return matches, 0
+  end
+
+  -- Number prefix
+  local digits = query:match('^#?(%d+)$')
+  if digits then
+    local numbers = index.numbers
+    for i = lower_bound(numbers, digits), #numbers do
+      local entry = numbers[i]
+      if entry.text:sub(1, #digits) ~= digits or count >= limit then break end
+      matches[entry.rid] = true
+      count = count + 1
+    end
+  end
+
+  -- Name substring ('\n' never occurs in a query that came from a text field)
+  if not find(query, '\n', 1, true) then
+    local haystack, offsets, rids = index.haystack, index.offsets, index.rids
+    local n = #offsets
+    local pos = 1
+    while count < limit do
+      local s = find(haystack, query, pos, true)
+      if not s then break end
+      local i = region_at(offsets, s)
+      local rid = rids[i]
+      if not matches[rid] then
+        matches[rid] = true
+        count = count + 1
+      end
+      if i >= n then break end
+      pos = offsets[i + 1]
+    end
+  end
+
+  return matches, count
+end
+
+return M
@@ -0,0 +1,89 @@
+-- @noindex
+-- RegionPlaylist/domain/render_job.lua
+-- Render a playlist into one continuous file without changing the project
+-- (business logic, no REAPER API; the render backend and the WAV join are
+-- passed in)
+--
+-- The resolved sequence (playback/expander.lua: nested playlists expanded,
+-- disabled items skipped, one entry per loop pass) becomes an ordered list
+-- of time ranges. Every range is queued with the backend, the queue renders
+-- in order, and the parts are joined end to end by join (data/wav_join.lua
+-- join() in the app).
+--
+-- BACKEND:
+--   backend:queue(range, part_path)   range = {index, rid, name, loop, start, end, position}
+--   backend:render() -> ok, err       renders the queued ranges in queue order
+-- arkitekt/reaper/render_queue.lua uses REAPER's render queue; the tests use
+-- a stand-in that writes synthetic WAVs.
+
+local M = {}
+
+--- Build the ordered render ranges of a resolved sequence
+--- @param sequence table From SequenceExpander.expand_playlist()
+--- @param get_region_by_rid function rid -> region {name, start, end} or nil
+--- @return table job {ranges, length, missing}
+function M.build(sequence, get_region_by_rid)
+  local ranges, position, missing = {}, 0, 0
+  for _, entry in ipairs(sequence) do
+    local region = get_region_by_rid(entry.rid)
+    if region and region['end'] > region.start then
+      ranges[#ranges + 1] = {
+        index = #ranges + 1,
+        rid = entry.rid,
+        name = region.name,
+        loop = entry.loop,
+        start = region.start,
+        ['end'] = region['end'],
+        position = position,   -- Where the range lands in the output
+      }
+      position = position + region['end'] - region.start
+    else
+      missing = missing + 1
+    end
+  end
+  return { ranges = ranges, length = position, missing = missing }
+end
+
+--- Part file for a range, next to the output
+local function part_path(out_path, index)
+  return string.format('%s.part%04d.wav', (out_path:gsub('%.[wW][aA][vV]$', '')), index)
+end
+
+--- Render a job through a backend and join the parts into one WAV
+--- @param job table From build()
+--- @param backend table See BACKEND above
+--- @param out_path string Output WAV path
+--- @param join function (part_paths, out_path) -> ok, {frames, sample_rate, channels} or error
+--- @return boolean ok
+--- @return table|string result {ranges, length, frames, sample_rate, channels} or error
+function M.run(job, backend, out_path, join)
+  if #job.ranges == 0 then
+    return false, 'Nothing to render'
+  end
+
+  local parts = {}
+  for i, range in ipairs(job.ranges) do
+    parts[i] = part_path(out_path, i)
+    local queued, err = backend:queue(range, parts[i])
+    if not queued then
+      return false, err
+    end
+  end
+
+  local ok, result = backend:render()
+  if ok then
+    ok, result = join(parts, out_path)
+  end
+  for _, path in ipairs(parts) do
+    os.remove(path)
+  end
+  if not ok then
+    return false, result
+  end
+
+  result.ranges = #job.ranges
+  result.length = job.length
+  return true, result
+end
+
+return M
@@ -0,0 +1,903 @@
+-- @noindex
+-- RegionPlaylist/tests/benchmarks.lua
+-- Performance benchmarks for playlist hot paths (pure Lua, no project needed)
+--
+-- Registered as a TestRunner suite so they run from the debug console:
+--   TestRunner.run('RegionPlaylist.benchmarks')
+-- Each benchmark logs its timings; assertions only check correctness, never
+-- wall-clock thresholds (machines differ too much for that).
+
+local TestRunner = require('arkitekt.debug.test_runner')
+local Logger = require('arkitekt.debug.logger')
+local PlaylistDomain = require('RegionPlaylist.domain.playlist')
+local Fixtures = require('RegionPlaylist.tests.fixtures')
+local assert = TestRunner.assert
+
+local time_precise = reaper.time_precise
+
+local M = {}
+
+-- ============================================================================
+-- HARNESS
+-- ============================================================================
+
+--- Time fn over several runs and log the best/median
+--- @param label string Benchmark label
+--- @param runs number Number of timed runs
+--- @param fn function Function to time (receives run index)
+--- @return number best_ms Best run in milliseconds
+function M.measure(label, runs, fn)
+  local times = {}
+  for r = 1, runs do
+    local t0 = time_precise()
+    fn(r)
+    times[r] = (time_precise() - t0) * 1000
+  end
+  table.sort(times)
+  local best, median = times[1], times[(#times + 1) // 2]
+  Logger.info('BENCH', '%-40s best %8.3fms  median %8.3fms  (%d runs)', label, best, median, runs)
+  return best
+end
+
+--- Run fn ops times and log ns/op and bytes allocated per op
+--- The collector is stopped while timing, so the heap growth read from
+--- collectgarbage('count') is exactly what the ops allocated.
+--- @param label string Benchmark label
+--- @param ops number Number of calls
+--- @param fn function Function to call (receives op index)
+--- @return number ns_per_op
+--- @return number bytes_per_op
+function M.measure_ops(label, ops, fn)
+  collectgarbage('collect')
+  collectgarbage('stop')
+  local kb0 = collectgarbage('count')
+  local t0 = time_precise()
+  for i = 1, ops do
+    fn(i)
+  end
+  local elapsed = time_precise() - t0
+  local kb = collectgarbage('count') - kb0
+  collectgarbage('restart')
+  local ns, bytes = elapsed * 1e9 / ops, kb * 1024 / ops
+  Logger.info('BENCH', '%-40s %12.0f ns/op %11.1f B/op  (%d ops)', label, ns, bytes, ops)
+  return ns, bytes
+end
+
+--- Time fn against a fresh stand-in session per run
+--- Sessions are built before timing starts; fn runs inside stub:run().
+--- @param label string Benchmark label
+--- @param runs number Number of timed runs
+--- @param session table|function Options for Fixtures.make_session, or a builder returning a stub
+--- @param fn function Function to time (receives stub, run index)
+--- @return table stubs The sessions after their run (stubs[r] for run r)
+function M.measure_sessions(label, runs, session, fn)
+  local stubs = {}
+  for r = 1, runs do
+    stubs[r] = type(session) == 'function' and session() or Fixtures.make_session(session)
+  end
+  M.measure(label, runs, function(r)
+    local stub = stubs[r]
+    stub:run(function() fn(stub, r) end)
+  end)
+  return stubs
+end
+
+--- Build a synthetic playlist item array
+--- @param n number Item count
+--- @return table items
+function M.make_items(n)
+  local items = {}
+  for i = 1, n do
+    items[i] = {
+      type = 'region',
+      rid = (i - 1) % 500 + 1,
+      reps = 1,
+      enabled = true,
+      key = 'item_' .. i,
+    }
+  end
+  return items
+end
+
+-- ============================================================================
+-- PLAYBACK ENGINE: UPDATE
+-- ============================================================================
+-- The engine's update() runs every frame while the app is open; item
+-- lookups by key (set_next_item, seek_to_item, drag colors) go through the
+-- position index instead of scanning the playlist. Timed on the stand-in
+-- project with the transport playing through a 1k/10k item playlist.
+
+local benchmarks = {}
+
+function benchmarks.bench_engine_update()
+  local Controller = require('RegionPlaylist.domain.playback.controller')
+
+  for _, n in ipairs({ 1000, 10000 }) do
+    local project = Fixtures.make_marker_project(n)
+    local stub, items = project.stub, project.playlists[1].items
+    local engine = stub:run(function()
+      local engine = Controller.new({ proj = 0 })
+      engine:set_order(items)
+      engine:play()
+      return engine
+    end)
+
+    stub:run(function()
+      -- One frame of playback per op (30ms steps through 2s regions)
+      M.measure_ops(string.format('engine update() n=%d', n), 2000, function()
+        stub.play_position = stub.play_position + 0.03
+        engine:update()
+      end)
+      M.measure_ops(string.format('set_next_item (key lookup) n=%d', n), 2000, function(i)
+        engine:set_next_item(items[(i * 7919) % n + 1].key)
+      end)
+    end)
+  end
+end
+
+-- ============================================================================
+-- DRAG REORDER: BATCH MOVE
+-- ============================================================================
+-- Moving a selection one item at a time (remove + insert) is O(k*n);
+-- the batch move is a single O(n) splice.
+
+function benchmarks.bench_batch_move()
+  local n, k = 5000, 200
+  local keys = {}
+  for i = 1, k do keys[i] = 'item_' .. (i * 20) end
+
+  -- Fresh playlist per run (built outside the timed section)
+  local fresh = {}
+  for r = 1, 3 do fresh[r] = M.make_items(n) end
+  M.measure(string.format('move %d of %d (one at a time)', k, n), 3, function(r)
+    local items = fresh[r]
+    PlaylistDomain.index_items(items)
+    for _, key in ipairs(keys) do
+      local idx = PlaylistDomain.find_item_index(items, key)
+      local item = table.remove(items, idx)
+      table.insert(items, 1, item)
+    end
+  end)
+
+  local items = M.make_items(n)
+  M.measure(string.format('move %d of %d (single splice)', k, n), 3, function()
+    local new_items = PlaylistDomain.plan_move(items, keys, items[1].key)
+    if new_items then PlaylistDomain.apply_order(items, new_items) end
+  end)
+  assert.equals(n, #items)
+end
+
+-- ============================================================================
+-- REGION SEARCH
+-- ============================================================================
+-- Pool search used to lowercase and scan every region name per query; the
+-- search index lowercases once per refresh and scans one joined string.
+
+function benchmarks.bench_region_search()
+  local n = 20000
+  local words = { 'intro', 'verse', 'chorus', 'bridge', 'outro', 'drop', 'fill' }
+  local regions = {}
+  for i = 1, n do
+    regions[i] = { rid = i, name = string.format('%s %s %d', words[i % #words + 1], words[(i * 7) % #words + 1], i) }
+  end
+  local Region = require('RegionPlaylist.domain.region')
+  local domain = Region.new()
+  domain:refresh_from_bridge(regions)
+
+  M.measure(string.format('search build n=%d', n), 1, function()
+    domain:search('warmup')
+  end)
+
+  local expected
+  M.measure(string.format('search (linear lower/find) n=%d', n), 5, function()
+    local count = 0
+    for _, region in ipairs(regions) do
+      if region.name:lower():find('1999', 1, true) then count = count + 1 end
+    end
+    expected = count
+  end)
+
+  M.measure(string.format('search (index, rare) n=%d', n), 5, function()
+    local _, count = domain:search('1999')
+    assert.equals(expected, count)
+  end)
+
+  M.measure(string.format('search (index, common) n=%d', n), 5, function()
+    domain:search('chorus')
+  end)
+
+  M.measure(string.format('search (number prefix) n=%d', n), 5, function()
+    local _, count = domain:search('#1999')
+    assert.equals(11, count)  -- 1999 and 19990..19999
+  end)
+end
+
+-- ============================================================================
+-- PROJECT LOAD / IMPORT REFRESH
+-- ============================================================================
+-- Cost of the one refresh a project reload or an SWS import now does
+-- (State.begin_load()/end_load() defer persist and resync to it). An import
+-- adopts the list it just saved instead of decoding it back.
+
+--- Build a synthetic project: playlists with region items and some nesting
+--- @param playlist_count number Number of playlists
+--- @param items_per number Items per playlist
+--- @return table playlists
+function M.make_project(playlist_count, items_per)
+  local playlists = {}
+  for p = 1, playlist_count do
+    local items = M.make_items(items_per)
+    for _, item in ipairs(items) do item.key = p .. '_' .. item.key end
+    if p > 1 then
+      items[1] = { type = 'playlist', playlist_id = 'pl_' .. (p - 1), reps = 1, enabled = true, key = p .. '_nested' }
+    end
+    playlists[p] = { id = 'pl_' .. p, name = 'Playlist ' .. p, items = items, chip_color = 0xFF0000FF }
+  end
+  return playlists
+end
+
+function benchmarks.bench_project_load_refresh()
+  local JSON = require('arkitekt.core.json')
+  local Playlist = require('RegionPlaylist.domain.playlist')
+  local Dependency = require('RegionPlaylist.domain.dependency')
+
+  local playlist_count, items_per = 100, 50
+  local project = M.make_project(playlist_count, items_per)
+  local payload = JSON.encode(project)
+
+  local function refresh(domain, graph, playlists)
+    domain:load_playlists(playlists)
+    graph:rebuild(playlists)
+    domain:get_tabs()
+    return JSON.encode(playlists)  -- persist
+  end
+
+  -- Project reload: decode, then one refresh for the whole list
+  M.measure(string.format('load %dx%d (single refresh)', playlist_count, items_per), 3, function()
+    local playlists = JSON.decode(payload)
+    local domain, graph = Playlist.new(), Dependency.new()
+    refresh(domain, graph, playlists)
+    assert.equals(playlist_count, #domain:get_all())
+  end)
+
+  -- Import: the saved list is adopted as is (no decode, no re-save)
+  M.measure(string.format('import %dx%d (adopt saved list)', playlist_count, items_per), 3, function()
+    local domain, graph = Playlist.new(), Dependency.new()
+    domain:load_playlists(project)
+    graph:rebuild(project)
+    domain:get_tabs()
+  end)
+end
+
+-- ============================================================================
+-- SWS IMPORT: PLAYLIST CHUNK PARSING
+-- ============================================================================
+-- The previous importer split the whole RPP into a lines table, pattern-
+-- matched every line for the section tag, and built one table per item.
+-- The streaming parser jumps between tags with a plain find and parses item
+-- lines in place into two integer arrays.
+
+--- Build synthetic RPP text with SWS playlist chunks among filler lines
+--- @param playlist_count number Number of <S&M_RGN_PLAYLIST> chunks
+--- @param items_per number Items per chunk
+--- @param filler number Unrelated RPP lines before the chunks
+--- @return string text
+function M.make_rpp(playlist_count, items_per, filler)
+  local out = { '<REAPER_PROJECT 0.1 "7.0" 1700000000' }
+  for i = 1, filler do
+    out[#out + 1] = string.format('  <TRACK {%08X-0000-0000-0000-000000000000}\n    NAME "Track %d"\n    VOLPAN 1 0 -1 -1 1\n  >', i, i)
+  end
+  for p = 1, playlist_count do
+    out[#out + 1] = string.format('  <S&M_RGN_PLAYLIST "List %d" %d', p, p == 1 and 1 or 0)
+    for i = 1, items_per do
+      out[#out + 1] = string.format('    %d %d', 0x40000000 + (i % 300) + 1, (i % 5 == 0) and -1 or (i % 4) + 1)
+    end
+    out[#out + 1] = '  >'
+  end
+  out[#out + 1] = '>'
+  return table.concat(out, '\n')
+end
+
+-- Reference: the previous line-based parser (kept here for comparison)
+local function parse_sws_lines_legacy(text)
+  local lines = {}
+  for line in text:gmatch('[^\n]*') do lines[#lines + 1] = line end
+
+  local playlists = {}
+  local idx = 1
+  while idx <= #lines do
+    if lines[idx]:match('<S&M_RGN_PLAYLIST') then
+      local playlist = { items = {} }
+      idx = idx + 1
+      while idx <= #lines do
+        local line = lines[idx]
+        if line:match('^%s*>%s*$') then break end
+        local rgn_id, loop_count = line:match('^%s*(%d+)%s+(-?%d+)%s*$')
+        if rgn_id and loop_count then
+          playlist.items[#playlist.items + 1] = {
+            sws_rgn_id = tonumber(rgn_id),
+            sws_loop_count = tonumber(loop_count),
+          }
+        end
+        idx = idx + 1
+      end
+      playlists[#playlists + 1] = playlist
+    end
+    idx = idx + 1
+  end
+  return playlists
+end
+
+function benchmarks.bench_sws_parse()
+  local SWSImport = require('RegionPlaylist.data.sws_import')
+  local playlist_count, items_per = 100, 1000
+  local text = M.make_rpp(playlist_count, items_per, 20000)
+
+  local legacy
+  M.measure(string.format('sws parse %dk items (line tables)', playlist_count * items_per // 1000), 3, function()
+    legacy = parse_sws_lines_legacy(text)
+  end)
+
+  local streamed
+  M.measure(string.format('sws parse %dk items (streaming)', playlist_count * items_per // 1000), 3, function()
+    streamed = SWSImport.parse_sws_playlists(text)
+  end)
+
+  assert.equals(#legacy, #streamed)
+  local total = 0
+  for i, pl in ipairs(streamed) do
+    assert.equals(#legacy[i].items, pl.count)
+    assert.equals(legacy[i].items[pl.count].sws_loop_count, pl.sws_loop_counts[pl.count])
+    total = total + pl.count
+  end
+  assert.equals(playlist_count * items_per, total)
+end
+
+-- ============================================================================
+-- UNDO: SNAPSHOT CAPTURE
+-- ============================================================================
+-- Every undoable edit captures a snapshot first. Snapshots used to deep-copy
+-- every playlist; now unchanged playlists share one frozen copy, so a capture
+-- after a single-playlist edit only copies that playlist.
+
+function benchmarks.bench_undo_capture()
+  local UndoBridge = require('RegionPlaylist.data.undo')
+  local playlist_count, items_per, edits = 100, 200, 50
+  local project = M.make_project(playlist_count, items_per)
+
+  -- Reference: the previous full copy
+  local function full_copy(playlists)
+    local copy = {}
+    for i, pl in ipairs(playlists) do
+      local items = {}
+      for j, item in ipairs(pl.items) do
+        items[j] = { type = item.type, rid = item.rid, guid = item.guid, region_name = item.region_name,
+          reps = item.reps, enabled = item.enabled, key = item.key, playlist_id = item.playlist_id }
+      end
+      copy[i] = { id = pl.id, name = pl.name, chip_color = pl.chip_color, items = items }
+    end
+    return copy
+  end
+
+  M.measure(string.format('%d edits, full copy (%dx%d)', edits, playlist_count, items_per), 3, function()
+    for e = 1, edits do
+      full_copy(project)
+      project[e % playlist_count + 1].items[1].reps = e
+    end
+  end)
+
+  UndoBridge.invalidate_all()
+  M.measure(string.format('%d edits, copy-on-write (%dx%d)', edits, playlist_count, items_per), 3, function()
+    for e = 1, edits do
+      UndoBridge.capture_snapshot(project, 'pl_1')
+      local pl = project[e % playlist_count + 1]
+      pl.items[1].reps = e
+      UndoBridge.mark_dirty(pl)
+    end
+  end)
+end
+
+-- ============================================================================
+-- STORAGE: JSON VS COMPACT ENCODING
+-- ============================================================================
+-- Saved playlists go into the project (and REAPER's undo states) on every
+-- edit. The compact block (playlist_codec.lua) replaces per-item JSON objects
+-- with varint runs, a shared string table and packed UUID keys.
+
+function benchmarks.bench_storage_encoding()
+  local JSON = require('arkitekt.core.json')
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+
+  local playlist_count, items_per = 50, 400
+  local project = M.make_project(playlist_count, items_per)
+  for p, pl in ipairs(project) do
+    for i, item in ipairs(pl.items) do
+      item.key = string.format('%08x-0000-4000-8000-%012x', p, i)
+      if item.type == 'region' then
+        item.guid = string.format('{%08X-0000-0000-0000-000000000000}', item.rid)
+        item.region_name = 'Region ' .. item.rid
+      end
+    end
+  end
+
+  local json_text, compact_text
+  M.measure('save JSON', 3, function() json_text = JSON.encode(project) end)
+  M.measure('save compact', 3, function() compact_text = PlaylistCodec.encode(project) end)
+  assert.not_nil(compact_text)
+  Logger.info('BENCH', 'size %dx%d: JSON %d bytes, compact %d bytes (%.1f%%)', playlist_count, items_per,
+    #json_text, #compact_text, #compact_text * 100 / #json_text)
+
+  M.measure('load JSON', 3, function() JSON.decode(json_text) end)
+  M.measure('load compact', 3, function() PlaylistCodec.decode(compact_text) end)
+end
+
+-- ============================================================================
+-- PLAYLIST LIBRARY: LAZY OPEN
+-- ============================================================================
+-- Library files carry an index header; opening reads only the header and
+-- each playlist is decoded on first access.
+
+function benchmarks.bench_library_open()
+  local PlaylistLibrary = require('RegionPlaylist.data.playlist_library')
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+
+  local playlist_count, items_per = 1000, 100
+  local project = M.make_project(playlist_count, items_per)
+  local region_index = {}
+  for rid = 1, 500 do
+    region_index[rid] = { rid = rid, name = 'Region ' .. rid, start = rid * 10.0, ['end'] = rid * 10.0 + 8 }
+  end
+
+  local path = os.tmpname()
+  M.measure(string.format('library write %dx%d', playlist_count, items_per), 1, function()
+    assert.truthy(PlaylistLibrary.write(path, project, region_index))
+  end)
+
+  -- Reference: one blob decoded up front
+  local blob = PlaylistCodec.encode_text(project, true)
+  M.measure('open (decode everything)', 3, function()
+    PlaylistCodec.decode_text(blob)
+  end)
+
+  local library
+  M.measure('open (index only)', 3, function()
+    if library then library:close() end
+    library = PlaylistLibrary.open(path)
+  end)
+
+  M.measure('get one playlist', 3, function()
+    library.cache = {}
+    library:get(500)
+  end)
+  library:close()
+  os.remove(path)
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: LOOPED DUPLICATION
+-- ============================================================================
+-- Append/paste/crop used to split, read and copy a region's items, tempo
+-- markers and envelope points once per loop count. The layout pass reads
+-- each source once and writes all repetitions from it. Runs against the
+-- in-memory stand-in project (tests/reaper_stub.lua, tests/fixtures.lua);
+-- what the operations write is covered by the region operation tests in
+-- tests/domain_tests.lua.
+
+-- Reference: the previous per-repetition append (kept here for comparison)
+local function append_per_rep_legacy(playlist_items)
+  local Regions = require('arkitekt.reaper.regions')
+  local proj = 0
+  local current_position = 0
+  for i = 0, reaper.CountMediaItems(proj) - 1 do
+    local it = reaper.GetMediaItem(proj, i)
+    local item_end = reaper.GetMediaItemInfo_Value(it, 'D_POSITION') + reaper.GetMediaItemInfo_Value(it, 'D_LENGTH')
+    current_position = math.max(current_position, item_end)
+  end
+
+  for _, pl_item in ipairs(playlist_items) do
+    local region = Regions.get_region_by_rid(proj, pl_item.rid)
+    if region then
+      local region_length = region['end'] - region.start
+      local items = {}
+      for i = 0, reaper.CountMediaItems(proj) - 1 do
+        local it = reaper.GetMediaItem(proj, i)
+        local pos = reaper.GetMediaItemInfo_Value(it, 'D_POSITION')
+        local item_end = pos + reaper.GetMediaItemInfo_Value(it, 'D_LENGTH')
+        if pos >= region.start and item_end <= region['end'] then items[#items + 1] = it end
+      end
+      for _ = 1, pl_item.reps or 1 do
+        local offset = current_position - region.start
+        for _, it in ipairs(items) do
+          local track = reaper.GetMediaItem_Track(it)
+          local _, chunk = reaper.GetItemStateChunk(it, '', false)
+          local new_item = reaper.AddMediaItemToTrack(track)
+          reaper.SetItemStateChunk(new_item, chunk, false)
+          reaper.SetMediaItemInfo_Value(new_item, 'D_POSITION', reaper.GetMediaItemInfo_Value(it, 'D_POSITION') + offset)
+        end
+        for i = 0, reaper.CountTempoTimeSigMarkers(proj) - 1 do
+          local _, t, _, _, bpm, num, denom, linear = reaper.GetTempoTimeSigMarker(proj, i)
+          if t >= region.start and t <= region['end'] then
+            reaper.SetTempoTimeSigMarker(proj, -1, t + offset, -1, -1, bpm, num, denom, linear)
+          end
+        end
+        for i = 0, reaper.CountTracks(proj) - 1 do
+          local track = reaper.GetTrack(proj, i)
+          for j = 0, reaper.CountTrackEnvelopes(track) - 1 do
+            local env = reaper.GetTrackEnvelope(track, j)
+            local points = {}
+            for k = 0, reaper.CountEnvelopePoints(env) - 1 do
+              local _, time, value, shape, tension = reaper.GetEnvelopePoint(env, k)
+              if time >= region.start and time <= region['end'] then
+                points[#points + 1] = { time + offset, value, shape, tension }
+              end
+            end
+            for _, p in ipairs(points) do
+              reaper.InsertEnvelopePoint(env, p[1], p[2], p[3], p[4], false, true)
+            end
+          end
+        end
+        reaper.AddProjectMarker2(proj, true, current_position, current_position + region_length, region.name, -1, 0)
+        current_position = current_position + region_length
+      end
+    end
+  end
+end
+
+function benchmarks.bench_loop_duplication()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 16, regions = 8, payload = 4000, points_per_region = 8 }
+  local runs = 3
+
+  for _, reps in ipairs({ 4, 32 }) do
+    local playlist = {}
+    for r = 1, session.regions do
+      playlist[r] = { rid = r, reps = reps }
+    end
+
+    local legacy = M.measure_sessions(string.format('append x%d, per repetition', reps), runs, session,
+      function() append_per_rep_legacy(playlist) end)
+    local bulk = M.measure_sessions(string.format('append x%d, single pass', reps), runs, session,
+      function() RegionOps.append_playlist_to_project(playlist) end)
+    Logger.info('BENCH', '  API calls: per repetition %d, single pass %d',
+      legacy[1]:call_count(), bulk[1]:call_count())
+  end
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: ENVELOPE RANGES
+-- ============================================================================
+-- Automation is copied point by point with edge points at the range bounds;
+-- on a large template this is one read per envelope and region.
+
+function benchmarks.bench_envelope_ranges()
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local track_count = 300
+
+  local function automated_session()
+    local stub = ReaperStub.new()
+    stub:add_region(1, 2, 6, 'Middle')
+    stub:add_region(2, 0, 8, 'All')
+    for _ = 1, track_count do
+      local track = stub:add_track()
+      stub:add_item(track, 0, 8)
+      -- Linear ramp 0 -> 1 over 0..8, no point on the region bounds
+      stub:add_envelope(track, { { 0, 0 }, { 8, 1 } })
+    end
+    return stub
+  end
+
+  M.measure_sessions(string.format('append region, %d automated tracks', track_count), 3, automated_session,
+    function() RegionOps.append_playlist_to_project({ { rid = 1, reps = 2 } }) end)
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: SPLIT / UNSPLIT
+-- ============================================================================
+-- Append and paste put split source items back afterwards. Restoring a full
+-- chunk snapshot reserializes and reparses every MIDI event; restoring the
+-- handful of fields a split changes does not.
+
+function benchmarks.bench_unsplit()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 32, regions = 16, payload = 20000, item_offset = 2 }
+  local runs = 3
+
+  -- Reference: chunk snapshot before the split, SetItemStateChunk after
+  local function split_restore_chunks(stub)
+    for _, region in ipairs(stub:regions()) do
+      local s, e = region.pos, region.rgnend
+      local snapshots = {}
+      for i = 0, reaper.CountMediaItems(0) - 1 do
+        local item = reaper.GetMediaItem(0, i)
+        local pos = reaper.GetMediaItemInfo_Value(item, 'D_POSITION')
+        local item_end = pos + reaper.GetMediaItemInfo_Value(item, 'D_LENGTH')
+        if pos < e and item_end > s then
+          local _, chunk = reaper.GetItemStateChunk(item, '', false)
+          snapshots[#snapshots + 1] = { item = item, chunk = chunk, pos = pos, item_end = item_end }
+        end
+      end
+      for _, snap in ipairs(snapshots) do
+        local right = snap.pos < s and reaper.SplitMediaItem(snap.item, s)
+        local tail = snap.item_end > e and reaper.SplitMediaItem(right or snap.item, e)
+        for _, piece in ipairs({ right or false, tail or false }) do
+          if piece then reaper.DeleteTrackMediaItem(reaper.GetMediaItem_Track(piece), piece) end
+        end
+        reaper.SetItemStateChunk(snap.item, snap.chunk, false)
+      end
+    end
+  end
+
+  local function split_restore_fields(stub)
+    for _, region in ipairs(stub:regions()) do
+      local splits = {}
+      RegionOps.split_items_in_region(0, region.pos, region.rgnend, splits)
+      RegionOps.unsplit_items(splits)
+    end
+  end
+
+  local label = string.format('%dx%d MIDI items', session.tracks, session.regions)
+  M.measure_sessions('split/restore, chunk snapshots ' .. label, runs, session, split_restore_chunks)
+  M.measure_sessions('split/restore, split fields ' .. label, runs, session, split_restore_fields)
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: CROP TO NEW TAB
+-- ============================================================================
+-- Crop to a new tab writes track, item, region and tempo state straight into
+-- the new tab instead of crop + copy tracks + undo + paste via clipboard.
+
+function benchmarks.bench_crop_new_tab()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 32, regions = 16, payload = 4000, points_per_region = 8 }
+  local playlist = { { rid = 3, reps = 2 }, { rid = 7, reps = 1 }, { rid = 3, reps = 1 } }
+
+  M.measure_sessions(string.format('crop to new tab, %dx%d session', session.tracks, session.regions), 3, session,
+    function() RegionOps.crop_to_playlist_new_tab(playlist) end)
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: OFFLINE FLATTEN TO RPP
+-- ============================================================================
+-- The flattened timeline is streamed to a new .RPP with read-only calls;
+-- items crossing region bounds are trimmed in their chunk text.
+
+function benchmarks.bench_flatten_rpp()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 16, regions = 8, payload = 4000, points_per_region = 8, item_offset = 2 }
+  local reps = 8
+  local playlist = {}
+  for r = 1, session.regions do
+    playlist[r] = { rid = r, reps = reps }
+  end
+
+  local path = os.tmpname()
+  M.measure_sessions(string.format('flatten to RPP, %dx%d x%d', session.tracks, session.regions, reps), 3, session,
+    function() RegionOps.write_playlist_rpp(playlist, path) end)
+  os.remove(path)
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: PLANNED, CHUNKED PASTE
+-- ============================================================================
+-- Planning is read-only and applying can run as one step or one unit per
+-- step; this times the plan, the one-shot apply and the slowest step.
+
+function benchmarks.bench_paste_plan()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 16, regions = 8, payload = 2000, points_per_region = 8, item_offset = 2 }
+  local playlist = { { rid = 2, reps = 4 }, { rid = 5, reps = 4 }, { rid = 3, reps = 4 }, { rid = 8, reps = 4 } }
+  local function new_session()
+    local stub = Fixtures.make_session(session)
+    stub.cursor = 8
+    return stub
+  end
+
+  local plan
+  M.measure_sessions('paste plan (snapshot + layout)', 5, new_session,
+    function() plan = RegionOps.plan_playlist('paste', playlist) end)
+  M.measure_sessions('paste apply, one shot', 3, new_session,
+    function() RegionOps.apply_plan(plan):step() end)
+
+  local stub = new_session()
+  local steps, slowest = 0, 0
+  stub:run(function()
+    local job = RegionOps.apply_plan(plan)
+    repeat
+      local t0 = os.clock()
+      local finished = job:step(0)
+      slowest = math.max(slowest, os.clock() - t0)
+      steps = steps + 1
+    until finished
+  end)
+  Logger.info('BENCH', '%-40s %d steps, slowest %.3fms', 'paste apply, stepped', steps, slowest * 1000)
+end
+
+-- ============================================================================
+-- REGION OPERATIONS: TEMPO BATCH
+-- ============================================================================
+-- Dense tempo maps used to cost one SetTempoTimeSigMarker (and one tempo
+-- map rebuild in REAPER) per marker per copy; now every copy goes into the
+-- tempo envelope with a single state chunk.
+
+local function copy_tempo_per_marker_legacy(playlist_items, start_position)
+  local Regions = require('arkitekt.reaper.regions')
+  local position = start_position
+  for _, pl_item in ipairs(playlist_items) do
+    local region = Regions.get_region_by_rid(0, pl_item.rid)
+    local length = region['end'] - region.start
+    for _ = 1, pl_item.reps do
+      local offset = position - region.start
+      for i = 0, reaper.CountTempoTimeSigMarkers(0) - 1 do
+        local _, t, _, _, bpm, num, denom, linear = reaper.GetTempoTimeSigMarker(0, i)
+        if t > region['end'] then break end
+        if t >= region.start then
+          reaper.SetTempoTimeSigMarker(0, -1, t + offset, -1, -1, bpm, num, denom, linear)
+        end
+      end
+      position = position + length
+    end
+  end
+end
+
+function benchmarks.bench_tempo_batch()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 2, regions = 16 }
+  local per_region, reps = 32, 8
+  local playlist = {}
+  for r = 1, session.regions do
+    playlist[r] = { rid = r, reps = reps }
+  end
+  local function dense_session()
+    local stub = Fixtures.make_session(session)
+    for r = 1, session.regions do
+      for k = 1, per_region - 1 do
+        stub:add_tempo((r - 1) * 4 + k * 4 / per_region, 100 + r + k, 0, 0)
+      end
+    end
+    return stub
+  end
+
+  local project_end = session.regions * 4
+  local legacy = M.measure_sessions(
+    string.format('tempo copy, per marker (%d markers x%d)', session.regions * per_region, reps), 3, dense_session,
+    function() copy_tempo_per_marker_legacy(playlist, project_end) end)
+  local batch = M.measure_sessions(
+    string.format('append, tempo batch (%d markers x%d)', session.regions * per_region, reps), 3, dense_session,
+    function() RegionOps.append_playlist_to_project(playlist) end)
+  Logger.info('BENCH', '  tempo writes: per marker %d SetTempoTimeSigMarker, batch %d + %d SetEnvelopeStateChunk',
+    legacy[1].calls.SetTempoTimeSigMarker, batch[1].calls.SetTempoTimeSigMarker or 0,
+    batch[1].calls.SetEnvelopeStateChunk)
+end
+
+-- ============================================================================
+-- CORE OPERATIONS: NS/OP AND ALLOCATIONS BY PROJECT SIZE
+-- ============================================================================
+-- Baseline for the per-call cost of the operations SWS RegionPlaylist users
+-- know by name, on synthetic projects of 10 to 100k regions kept in the
+-- stand-in marker store (tests/fixtures.lua). Equivalents in this tree:
+--   IsInPlaylist(s)     - scan of playlist items for a region (no rid index)
+--   GetLength           - pool_queries.calculate_playlist_duration
+--   GetNestedRegion     - overlap.find_overlaps, rebuilt on region changes
+--   PlaylistPlay        - playlist_audit build_project + analyze_playlist
+--   GetNext/PrevValid   - playback transport next()/prev() while playing;
+--                         invalid items are dropped by state:set_order()
+--   UpdateCompact       - playlist.compact_range / normalize
+--   Save/ProcessExtLine - playlist_codec encode_text/decode_text round trip
+--   GetMonitoringInfo   - monitor_feed collect + serialize
+-- Ops are 'const', 'linear' or 'sort' (n log n) in the region count; the op
+-- count scales down with cost so every size runs in about the same time.
+
+local CORE_SIZES = { 10, 100, 1000, 10000, 100000 }
+
+local function core_op_count(cost, n)
+  if cost == 'const' then return 2000 end
+  if cost == 'linear' then return math.max(2, math.min(2000, 200000 // n)) end
+  return math.max(2, math.min(2000, 20000 // n))
+end
+
+local function playlist_has_region(playlist, rid)
+  for _, item in ipairs(playlist.items) do
+    if item.rid == rid and item.type == 'region' then return true end
+  end
+  return false
+end
+
+function benchmarks.bench_core_ops()
+  local Overlap = require('RegionPlaylist.domain.overlap')
+  local PlaylistAudit = require('RegionPlaylist.domain.playlist_audit')
+  local PoolQueries = require('RegionPlaylist.app.pool_queries')
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+  local RppScan = require('RegionPlaylist.data.rpp_scan')
+  local MonitorFeed = require('RegionPlaylist.data.monitor_feed')
+  local PlaybackState = require('RegionPlaylist.domain.playback.state')
+  local PlaybackTransport = require('RegionPlaylist.domain.playback.transport')
+
+  for _, n in ipairs(CORE_SIZES) do
+    local project = Fixtures.make_marker_project(n)
+    local stub, playlists = project.stub, project.playlists
+    local active = playlists[1]
+    local by_id, region_index = {}, {}
+    for _, pl in ipairs(playlists) do by_id[pl.id] = pl end
+    for _, region in ipairs(project.regions) do region_index[region.rid] = region end
+    local function get_playlist_by_id(id) return by_id[id] end
+
+    -- SWS-shaped copy of the active playlist for the preflight audit
+    local sws = { name = active.name, is_active = true, sws_rgn_ids = {}, region_numbers = {}, sws_loop_counts = {},
+      count = #active.items }
+    for i, item in ipairs(active.items) do
+      sws.sws_rgn_ids[i] = RppScan.SWS_REGION_FLAG + item.rid
+      sws.region_numbers[i] = item.rid
+      sws.sws_loop_counts[i] = item.reps
+    end
+
+    -- Playback engine pieces over the stand-in project, transport playing
+    local engine = stub:run(function()
+      local state = PlaybackState.new({ proj = 0 })
+      state:set_order(active.items)
+      local transport = PlaybackTransport.new({ proj = 0, state = state })
+      transport.is_playing = true
+      transport.seek_throttle = 0
+      return { proj = 0, state = state, transport = transport }
+    end)
+    stub.play_state = 1
+
+    local feed = MonitorFeed.new({ use_file = false, use_extstate = false })
+
+    local core_ops = {
+      { 'is_in_playlist', 'linear', function(i)
+        playlist_has_region(active, i % 2 == 0 and (i * 7919) % n + 1 or n + 1)
+      end },
+      { 'is_in_playlists', 'linear', function(i)
+        local rid = i % 2 == 0 and (i * 7919) % n + 1 or n + 1
+        for _, pl in ipairs(playlists) do
+          if playlist_has_region(pl, rid) then break end
+        end
+      end },
+      { 'get_length (nested playlist)', 'linear', function()
+        PoolQueries.calculate_playlist_duration(playlists[4], region_index, get_playlist_by_id)
+      end },
+      { 'get_nested_region (map rebuild)', 'sort', function()
+        Overlap.find_overlaps(engine.state.region_cache)
+      end },
+      { 'playlist_play preflight', 'sort', function()
+        PlaylistAudit.analyze_playlist(sws, PlaylistAudit.build_project(project.regions, project.markers))
+      end },
+      { 'next/prev valid item', 'const', function(i)
+        if i % 2 == 1 then engine.transport:next() else engine.transport:prev() end
+      end },
+      { 'sequence build (set_order)', 'linear', function()
+        engine.state:set_order(active.items)
+      end },
+      { 'update_compact (one edit)', 'const', function(i)
+        PlaylistDomain.compact_range(active.items, i % n + 1, i % n + 1)
+      end },
+      { 'update_compact (normalize)', 'linear', function()
+        PlaylistDomain.normalize(active.items)
+      end },
+      { 'save/load round trip (compact)', 'linear', function()
+        PlaylistCodec.decode_text(PlaylistCodec.encode_text(playlists, true))
+      end },
+      { 'save/load round trip (JSON)', 'linear', function()
+        PlaylistCodec.decode_text(PlaylistCodec.encode_text(playlists, false))
+      end },
+      { 'get_monitoring_info', 'const', function(i)
+        stub.play_position = (i % n) * 2 + 0.5
+        feed:_collect(engine)
+        feed:_serialize(i)
+      end },
+    }
+
+    stub:run(function()
+      for _, op in ipairs(core_ops) do
+        local name, cost, fn = op[1], op[2], op[3]
+        M.measure_ops(string.format('%s n=%d', name, n), core_op_count(cost, n), fn)
+      end
+    end)
+  end
+end
+
+TestRunner.register('RegionPlaylist.benchmarks', benchmarks)
+
+M.benchmarks = benchmarks
+return M
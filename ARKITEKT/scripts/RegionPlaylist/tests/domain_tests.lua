@@ -101,6 +101,37 @@ function region_tests.test_set_pool_order()
   assert.equals(2, order[3], 'Third should be RID 2')
 end
 
+function region_tests.test_search_names_and_numbers()
+  local Region = require('RegionPlaylist.domain.region')
+  local domain = Region.new()
+
+  domain:refresh_from_bridge({
+    { rid = 1, name = 'Intro' },
+    { rid = 2, name = 'Verse' },
+    { rid = 12, name = 'Verse Intro' },
+    { rid = 21, name = '' },
+  })
+
+  local matches, count = domain:search('INTRO')
+  assert.equals(2, count, 'Case-insensitive substring')
+  assert.truthy(matches[1] and matches[12], 'Intro and Verse Intro')
+
+  matches, count = domain:search('1')
+  assert.equals(2, count, 'Number prefix: 1 and 12, not 21')
+  assert.truthy(matches[1] and matches[12], 'Prefix matches')
+
+  matches, count = domain:search('o\nv')
+  assert.equals(0, count, 'Matches never span two names')
+
+  matches, count = domain:search('verse', 1)
+  assert.equals(1, count, 'Limit stops the scan')
+
+  -- Index follows refresh
+  domain:refresh_from_bridge({ { rid = 5, name = 'Outro' } })
+  matches, count = domain:search('intro')
+  assert.equals(0, count, 'Stale index dropped on refresh')
+end
+
 -- ============================================================================
 -- PLAYLIST DOMAIN TESTS
 -- ============================================================================
@@ -258,6 +289,286 @@ function playlist_tests.test_get_tabs()
   assert.equals(0xFF0000, tabs[1].chip_color, 'First tab color should match')
 end
 
+function playlist_tests.test_find_item_index_tracks_mutation()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+  local domain = Playlist.new()
+
+  local items = {
+    { type = 'region', rid = 1, key = 'a' },
+    { type = 'region', rid = 2, key = 'b' },
+    { type = 'region', rid = 3, key = 'c' },
+  }
+  domain:load_playlists({ { id = 'uuid-1', name = 'A', items = items } })
+
+  assert.equals(2, domain:find_item_index('uuid-1', 'b'), 'b should be at 2')
+
+  -- In-place mutation must not return stale positions
+  table.remove(items, 1)
+  assert.equals(1, domain:find_item_index('uuid-1', 'b'), 'b should move to 1')
+  assert.is_nil(domain:find_item_index('uuid-1', 'a'), 'Removed key should be nil')
+  assert.is_nil(domain:find_item_index('missing', 'b'), 'Unknown playlist should be nil')
+end
+
+function playlist_tests.test_find_item_index_missing_key_rebuilds_once()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+  local items = {
+    { type = 'region', rid = 1, key = 'a' },
+    { type = 'region', rid = 2, key = 'b' },
+    { type = 'region', rid = 3, key = 'c' },
+  }
+
+  local index_items, builds = Playlist.index_items, 0
+  Playlist.index_items = function(...) builds = builds + 1 return index_items(...) end
+  local ok, err = pcall(function()
+    assert.equals(2, Playlist.find_item_index(items, 'b'))
+    assert.equals(1, builds, 'First lookup builds the index')
+
+    -- Stale keys (e.g. an old drag payload) do not rebuild again
+    for _ = 1, 5 do assert.is_nil(Playlist.find_item_index(items, 'gone')) end
+    assert.equals(1, builds, 'Missing key answered from the index')
+
+    -- Appended and reordered items are still found
+    items[4] = { type = 'region', rid = 4, key = 'd' }
+    assert.equals(4, Playlist.find_item_index(items, 'd'), 'Append changes the count')
+    items[1], items[2] = items[2], items[1]
+    assert.equals(1, Playlist.find_item_index(items, 'b'), 'Stale hit rebuilds')
+
+    -- Merge away one item, insert another: same count, new member
+    items[3].rid = 1
+    assert.equals(1, #Playlist.compact_range(items, 2, 3))
+    items[4] = { type = 'region', rid = 5, key = 'e' }
+    assert.equals(4, Playlist.find_item_index(items, 'e'), 'Removal drops the index')
+  end)
+  Playlist.index_items = index_items
+  if not ok then error(err, 0) end
+end
+
+function playlist_tests.test_plan_move_is_stable_splice()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+
+  local items = {}
+  for i, key in ipairs({ 'a', 'b', 'c', 'd', 'e' }) do
+    items[i] = { type = 'region', rid = i, key = key }
+  end
+
+  -- Move d, b (drag order) before a
+  local moved = Playlist.plan_move(items, { 'd', 'b' }, 'a')
+  assert.not_nil(moved, 'Order should change')
+  local keys = {}
+  for i, item in ipairs(moved) do keys[i] = item.key end
+  assert.equals('d,b,a,c,e', table.concat(keys, ','), 'Moved block keeps drag order')
+
+  -- Append at end
+  moved = Playlist.plan_move(items, { 'a' }, nil)
+  keys = {}
+  for i, item in ipairs(moved) do keys[i] = item.key end
+  assert.equals('b,c,d,e,a', table.concat(keys, ','), 'nil anchor appends')
+
+  -- Dropping in place is a no-op
+  assert.is_nil(Playlist.plan_move(items, { 'b', 'c' }, 'd'), 'In-place drop should be nil')
+
+  -- apply_order keeps table identity
+  local ref = items
+  Playlist.apply_order(items, Playlist.plan_move(items, { 'e' }, 'a'))
+  assert.equals(ref, items, 'Items table should be reused')
+  assert.equals('e', items[1].key, 'e should be first')
+  assert.equals(5, #items, 'Length should be unchanged')
+end
+
+function playlist_tests.test_compact_range_merges_neighbours_only()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+
+  local function build(spec)
+    local items = {}
+    for i, s in ipairs(spec) do
+      items[i] = { type = 'region', rid = s[1], reps = s[2] or 1, enabled = s[3] ~= false, key = 'k' .. i }
+    end
+    return items
+  end
+  local function rids(items)
+    local out = {}
+    for i, item in ipairs(items) do out[i] = item.rid .. 'x' .. item.reps end
+    return table.concat(out, ',')
+  end
+
+  -- Duplicates outside the touched range are left alone
+  local items = build({ { 1 }, { 1 }, { 2 }, { 3 }, { 3, 2 }, { 4 } })
+  local removed = Playlist.compact_range(items, 4, 4)
+  assert.equals('k5', removed[1], 'Second 3 merged into first')
+  assert.equals('1x1,1x1,2x1,3x3,4x1', rids(items), 'Only the touched seam is compacted')
+
+  -- Infinite (0) and disabled items never merge
+  items = build({ { 5, 0 }, { 5 }, { 5, 1, false }, { 5 } })
+  assert.equals(0, #Playlist.normalize(items), 'Nothing mergeable')
+
+  -- Infinite loop sentinel is never summed, and no merge reaches it
+  local inf = Playlist.INFINITE_REPS
+  items = build({ { 6, inf }, { 6, inf }, { 6 }, { 7, inf - 2 }, { 7 }, { 7 } })
+  assert.equals(1, #Playlist.normalize(items), 'Only 7x(inf-2) + 7x1 merges')
+  assert.equals('6x' .. inf .. ',6x' .. inf .. ',6x1,7x' .. (inf - 1) .. ',7x1', rids(items))
+
+  -- Normalize folds whole runs and keeps the first key
+  items = build({ { 1 }, { 1 }, { 1 }, { 2 }, { 2 } })
+  removed = Playlist.normalize(items)
+  assert.equals(3, #removed, 'Three items merged away')
+  assert.equals('1x3,2x2', rids(items), 'Runs folded')
+  assert.equals('k1', items[1].key, 'First key survives')
+  assert.is_nil(items[3], 'Array shrunk')
+end
+
+function playlist_tests.test_compact_around_matches_normalize()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+
+  -- Compact playlist where moves, removals and inserts create duplicates
+  local RIDS = { 1, 2, 1, 2, 3, 1, 3, 2 }
+  local function build()
+    local items = {}
+    for i, rid in ipairs(RIDS) do
+      items[i] = { type = 'region', rid = rid, reps = i == 5 and 0 or 1, enabled = true, key = 'k' .. i }
+    end
+    return items
+  end
+  local function dump(items)
+    local out = {}
+    for i, item in ipairs(items) do out[i] = item.key .. '=' .. item.rid .. 'x' .. item.reps end
+    return table.concat(out, ',')
+  end
+  local counter = 0
+  local opts = { new_key = function() counter = counter + 1; return 'n' .. counter end }
+
+  -- Local pass after the edit vs a full normalize of the same result
+  local function check(label, edit)
+    local items = build()
+    local touched = edit(items)
+    local removed = Playlist.compact_around(items, touched)
+    local expected = build()
+    edit(expected)
+    local expected_removed = Playlist.normalize(expected)
+    assert.equals(dump(expected), dump(items), label)
+    assert.equals(#expected_removed, #removed, label)
+  end
+
+  for a = 1, #RIDS do
+    for b = a, #RIDS do
+      for before = 0, #RIDS do
+        local keys = a == b and { 'k' .. a } or { 'k' .. b, 'k' .. a }
+        local before_key = before > 0 and 'k' .. before or nil
+        check(string.format('move %s before %s', table.concat(keys, '+'), tostring(before_key)), function(items)
+          local new_items, touched = Playlist.plan_move(items, keys, before_key)
+          if not new_items then return {} end
+          Playlist.apply_order(items, new_items)
+          return touched
+        end)
+      end
+      check(string.format('remove k%d+k%d', a, b), function(items)
+        counter = 0
+        local _, touched = Playlist.apply_edits(items, { { op = 'remove', keys = { 'k' .. a, 'k' .. b } } }, opts)
+        return touched
+      end)
+    end
+    for rid = 1, 3 do
+      check(string.format('insert %d at %d, reps of k5', rid, a), function(items)
+        counter = 0
+        local _, touched = Playlist.apply_edits(items, {
+          { op = 'insert', index = a, items = { { rid = rid }, { rid = rid } } },
+          { op = 'set_reps', keys = { 'k5' }, reps = 1 },
+          { op = 'move', keys = { 'k' .. a }, before = 'k1' },
+        }, opts)
+        return touched
+      end)
+    end
+  end
+end
+
+function playlist_tests.test_apply_edits_batch()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+
+  local counter = 0
+  local opts = { new_key = function() counter = counter + 1; return 'n' .. counter end }
+  local items = { { type = 'region', rid = 9, reps = 1, enabled = true, key = 'old' } }
+
+  -- Invalid batches are rejected up front
+  assert.falsy(Playlist.validate_edits({ { op = 'clear' }, { op = 'explode' } }), 'Unknown op')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', items = { { name = 'x' } } } }), 'rid required')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', items = { { rid = 1, reps = 0 } } } }), 'reps >= 1')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', items = { { rid = 1, reps = 1.5 } } } }), 'integer reps')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', items = { { rid = 1, reps = '2' } } } }), 'numeric reps')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', items = { { rid = 1, enabled = 0 } } } }), 'boolean enabled')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', index = '2', items = { { rid = 1 } } } }), 'numeric index')
+  assert.falsy(Playlist.validate_edits({ { op = 'insert', index = 1.5, items = { { rid = 1 } } } }), 'integer index')
+  assert.falsy(Playlist.validate_edits({ { op = 'set_reps', reps = 2.5 } }), 'integer set_reps')
+  assert.truthy(Playlist.validate_edits({ { op = 'set_reps', reps = 0 } }), 'set_reps 0 allowed')
+
+  local edits = {
+    { op = 'clear' },
+    { op = 'insert', items = { { rid = 1 }, { rid = 2 }, { rid = 3 } } },
+    { op = 'insert', index = 2, items = { { rid = 4, reps = 3 } } },
+    { op = 'remove', keys = { 'n2' } },
+    { op = 'set_enabled', keys = { 'n3' }, enabled = false },
+    { op = 'move', keys = { 'n1' }, before = nil },
+  }
+  assert.truthy(Playlist.validate_edits(edits), 'Batch should validate')
+
+  local keys = Playlist.apply_edits(items, edits, opts)
+  assert.equals(4, #keys, 'Four inserted keys')
+
+  local order = {}
+  for i, item in ipairs(items) do order[i] = item.key end
+  assert.equals('n4,n3,n1', table.concat(order, ','), 'Edits applied in order')
+  assert.equals(3, items[1].reps, 'Insert keeps reps')
+  assert.falsy(items[2].enabled, 'set_enabled applied')
+  assert.equals(3, Playlist.find_item_index(items, 'n1'), 'Positions reindexed')
+end
+
+function playlist_tests.test_failed_apply_edits_changes_nothing()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+  local counter = 0
+  local opts = { new_key = function() counter = counter + 1; return 'n' .. counter end }
+  local items = {
+    { type = 'region', rid = 1, reps = 1, enabled = true, key = 'a' },
+    { type = 'region', rid = 2, reps = 1, enabled = true, key = 'b' },
+  }
+
+  -- Unvalidated batch that fails after a clear and a set_reps
+  local ok = pcall(Playlist.apply_edits, items, {
+    { op = 'set_reps', reps = 4 },
+    { op = 'clear' },
+    { op = 'insert', items = { { rid = 3 } } },
+    { op = 'insert', index = '2', items = { { rid = 4 } } },
+  }, opts)
+  assert.falsy(ok)
+  assert.equals(2, #items, 'Clear not applied')
+  assert.equals('a', items[1].key)
+  assert.equals(1, items[1].reps, 'set_reps not applied')
+  assert.equals(2, Playlist.find_item_index(items, 'b'))
+end
+
+function playlist_tests.test_validate_nested_rejects_missing_and_cycles()
+  local Playlist = require('RegionPlaylist.domain.playlist')
+  local Dependency = require('RegionPlaylist.domain.dependency')
+
+  -- A contains B; B contains C
+  local playlists = {
+    { id = 'A', items = { { type = 'playlist', playlist_id = 'B', key = 'a1' } } },
+    { id = 'B', items = { { type = 'playlist', playlist_id = 'C', key = 'b1' } } },
+    { id = 'C', items = {} },
+  }
+  local graph = Dependency.new()
+  graph:rebuild(playlists)
+  local function has(id) return id == 'A' or id == 'B' or id == 'C' end
+  local function cycle(target, added) return graph:detect_circular_reference(target, added) end
+  local function insert(id) return { { op = 'insert', items = { { type = 'playlist', playlist_id = id } } } } end
+
+  assert.truthy(Playlist.validate_nested('A', insert('C'), has, cycle), 'No cycle')
+  local ok, err = Playlist.validate_nested('C', insert('A'), has, cycle)
+  assert.falsy(ok, 'C -> A -> B -> C')
+  assert.equals('Circular dependency: A', err)
+  assert.falsy(Playlist.validate_nested('B', insert('B'), has, cycle), 'Self reference')
+  ok, err = Playlist.validate_nested('A', insert('Z'), has, cycle)
+  assert.falsy(ok)
+  assert.equals('Playlist not found: Z', err)
+end
+
 -- ============================================================================
 -- UI PREFERENCES DOMAIN TESTS
 -- ============================================================================
@@ -554,6 +865,1315 @@ function dependency_tests.test_ensure_fresh()
   assert.falsy(domain.dirty, 'Should remain clean')
 end
 
+-- ============================================================================
+-- PLAYLIST AUDIT TESTS
+-- ============================================================================
+
+local audit_tests = {}
+
+function audit_tests.test_length_infinite_and_preflight_findings()
+  local PlaylistAudit = require('RegionPlaylist.domain.playlist_audit')
+  local RppScan = require('RegionPlaylist.data.rpp_scan')
+
+  local rpp = table.concat({
+    '<REAPER_PROJECT 0.1 "7.0" 1700000000',
+    '  MARKER 1 0 Intro 1 0 1 R {A} 0',
+    '  MARKER 1 10 "" 1',
+    '  MARKER 2 10 "Verse A" 1 0 1 R {B} 0',
+    '  MARKER 2 30 "" 1',
+    '  MARKER 3 12 Inner 1',
+    '  MARKER 3 14 "" 1',
+    '  MARKER 4 40 Blip 1',
+    '  MARKER 4 40.2 "" 1',
+    '  MARKER 5 20 cue 0',
+    '  <S&M_RGN_PLAYLIST "Show" 1',
+    '    1073741825 2',
+    '    1073741826 1',
+    '    1073741828 -1',
+    '    1073741833 1',
+    '  >',
+    '>',
+  }, '\n')
+
+  local regions, markers = RppScan.parse_markers(rpp)
+  local playlists = RppScan.parse_sws_playlists(rpp)
+  assert.equals(1, #playlists)
+  local show = PlaylistAudit.analyze_playlist(playlists[1], PlaylistAudit.build_project(regions, markers))
+  assert.equals(40, show.length, 'Infinite and missing items do not count')
+  assert.truthy(show.infinite)
+  assert.equals(4, show.items)
+  assert.equals(9, show.findings.missing[1].sws_id - 0x40000000)
+  assert.equals(2, show.findings.nested[1].region)
+  assert.equals(3, show.findings.nested[1].contains[1])
+  assert.equals(4, show.findings.short[1].region)
+  assert.equals(5, show.findings.unsafe_markers[1].markers[1])
+end
+
+function audit_tests.test_find_overlaps_matches_pairwise_check()
+  local Overlap = require('RegionPlaylist.domain.overlap')
+
+  -- Overlapping, touching and identical-edge regions (deterministic LCG)
+  local cache, seed = {}, 12345
+  local function rand(m)
+    seed = (seed * 1103515245 + 12345) % 2147483648
+    return seed % m
+  end
+  for rid = 1, 200 do
+    local start = rand(400) / 2
+    cache[rid] = { rid = rid, start = start, ['end'] = start + 0.5 + rand(20) / 4 }
+  end
+  cache[201] = { rid = 201, start = 10, ['end'] = 12 }
+  cache[202] = { rid = 202, start = 12, ['end'] = 14 }  -- Touches 201 only
+
+  local function inside(pos, outer)
+    return pos >= outer.start + 0.001 and pos <= outer['end'] - 0.001
+  end
+  local map = Overlap.find_overlaps(cache)
+  for outer_rid, outer in pairs(cache) do
+    local expected = {}
+    for inner_rid, inner in pairs(cache) do
+      if inner_rid ~= outer_rid and (inside(inner.start, outer) or inside(inner['end'], outer)) then
+        expected[#expected + 1] = inner_rid
+      end
+    end
+    local got = {}
+    for i, rid in ipairs(map[outer_rid] or {}) do got[i] = rid end
+    table.sort(expected)
+    table.sort(got)
+    assert.equals(table.concat(expected, ','), table.concat(got, ','), 'Nested regions of ' .. outer_rid)
+  end
+end
+
+function audit_tests.test_preflight_on_synthetic_marker_project()
+  local PlaylistAudit = require('RegionPlaylist.domain.playlist_audit')
+  local RppScan = require('RegionPlaylist.data.rpp_scan')
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local n = 1000
+  local project = Fixtures.make_marker_project(n)
+
+  local active = project.playlists[1]
+  local sws = { name = active.name, is_active = true, sws_rgn_ids = {}, region_numbers = {}, sws_loop_counts = {},
+    count = #active.items }
+  for i, item in ipairs(active.items) do
+    sws.sws_rgn_ids[i] = RppScan.SWS_REGION_FLAG + item.rid
+    sws.region_numbers[i] = item.rid
+    sws.sws_loop_counts[i] = item.reps
+  end
+
+  local audit = PlaylistAudit.analyze_playlist(sws, PlaylistAudit.build_project(project.regions, project.markers))
+  assert.equals(2 * ((n - 1) // 100), #audit.findings.nested)  -- Outer and the region it reaches into
+  assert.equals(#project.markers, #audit.findings.unsafe_markers)
+  assert.equals(n * 2 + n // 100, audit.length)
+end
+
+-- ============================================================================
+-- RENDER JOB TESTS
+-- ============================================================================
+
+local render_tests = {}
+
+-- Stand-in render backend: each queued range becomes a 16-bit mono WAV
+-- whose samples count project frames (project frame n holds n % 32768)
+local function make_render_backend(rate, fail)
+  local WavJoin = require('RegionPlaylist.data.wav_join')
+  local fmt = string.pack('<I2I2I4I4I2I2', 1, 1, rate, rate * 2, 2, 16)
+  local backend = { queued = {}, rendered = {} }
+
+  function backend:queue(range, path)
+    self.queued[#self.queued + 1] = { range = range, path = path }
+    return true
+  end
+
+  function backend:render()
+    if fail then return false, 'Render cancelled' end
+    for _, entry in ipairs(self.queued) do
+      local first = math.floor(entry.range.start * rate + 0.5)
+      local last = math.floor(entry.range['end'] * rate + 0.5)
+      local samples = {}
+      for n = first, last - 1 do
+        samples[#samples + 1] = string.pack('<i2', n % 32768)
+      end
+      local data = table.concat(samples)
+      local f = io.open(entry.path, 'wb')
+      f:write(WavJoin.header(fmt, #data), data)
+      f:close()
+      self.rendered[#self.rendered + 1] = entry.range.index
+    end
+    return true
+  end
+
+  return backend
+end
+
+local function make_render_sequence()
+  local SequenceExpander = require('RegionPlaylist.domain.playback.expander')
+  local regions = {
+    [1] = { rid = 1, name = 'Intro', start = 0, ['end'] = 0.5 },
+    [2] = { rid = 2, name = 'Verse', start = 1, ['end'] = 1.25 },
+    [3] = { rid = 3, name = 'Chorus', start = 0.25, ['end'] = 0.75 },  -- Overlaps Intro
+  }
+  local nested = { id = 'B', items = {
+    { type = 'region', rid = 3, reps = 2, key = 'b1' },
+    { type = 'region', rid = 9, reps = 1, key = 'b2' },               -- Region gone
+  } }
+  local show = { id = 'A', items = {
+    { type = 'region', rid = 2, reps = 1, key = 'a1' },
+    { type = 'playlist', playlist_id = 'B', reps = 1, key = 'a2' },
+    { type = 'region', rid = 1, reps = 1, key = 'a3', enabled = false },
+    { type = 'region', rid = 1, reps = 2, key = 'a4' },
+  } }
+  local sequence = SequenceExpander.expand_playlist(show, function(id) return id == 'B' and nested or nil end)
+  return sequence, function(rid) return regions[rid] end
+end
+
+function render_tests.test_ranges_follow_resolved_sequence()
+  local RenderJob = require('RegionPlaylist.domain.render_job')
+  local sequence, get_region = make_render_sequence()
+  local job = RenderJob.build(sequence, get_region)
+
+  -- Nested loops expanded, disabled item skipped, missing region counted
+  local order = {}
+  for i, range in ipairs(job.ranges) do
+    order[i] = range.rid .. '/' .. range.loop
+    assert.equals(i, range.index)
+  end
+  assert.equals('2/1 3/1 3/2 1/1 1/2', table.concat(order, ' '))
+  assert.equals(1, job.missing)
+  assert.equals(0.25 + 0.5 * 2 + 0.5 * 2, job.length)
+  assert.equals(0, job.ranges[1].position)
+  assert.equals(0.25, job.ranges[2].position)
+  assert.equals(1.25, job.ranges[4].position)
+end
+
+function render_tests.test_parts_render_in_order_and_join_gapless()
+  local RenderJob = require('RegionPlaylist.domain.render_job')
+  local WavJoin = require('RegionPlaylist.data.wav_join')
+  local rate = 8000
+  local sequence, get_region = make_render_sequence()
+  local job = RenderJob.build(sequence, get_region)
+  local backend = make_render_backend(rate)
+  local out_path = os.tmpname()
+
+  local ok, result = RenderJob.run(job, backend, out_path, WavJoin.join)
+  assert.truthy(ok, tostring(result))
+  assert.equals('1 2 3 4 5', table.concat(backend.rendered, ' '))
+  for _, entry in ipairs(backend.queued) do
+    assert.falsy(io.open(entry.path, 'rb'), 'Part files are removed')
+  end
+
+  -- One sample stream: every range's frames back to back, nothing between
+  local info = WavJoin.read_info(out_path)
+  assert.equals(math.floor(job.length * rate + 0.5), info.frames)
+  assert.equals(info.frames, result.frames)
+  local f = io.open(out_path, 'rb')
+  f:seek('set', info.data_offset)
+  local data = f:read(info.data_size)
+  f:close()
+  os.remove(out_path)
+
+  local pos = 1
+  for _, range in ipairs(job.ranges) do
+    for n = math.floor(range.start * rate + 0.5), math.floor(range['end'] * rate + 0.5) - 1 do
+      local value
+      value, pos = string.unpack('<i2', data, pos)
+      if value ~= n % 32768 then
+        assert.equals(n % 32768, value, 'Sample mismatch in range ' .. range.index)
+      end
+    end
+  end
+  assert.equals(#data + 1, pos)
+end
+
+function render_tests.test_failed_render_leaves_no_output()
+  local RenderJob = require('RegionPlaylist.domain.render_job')
+  local WavJoin = require('RegionPlaylist.data.wav_join')
+  local sequence, get_region = make_render_sequence()
+  local out_path = os.tmpname()
+  os.remove(out_path)
+
+  local ok, err = RenderJob.run(RenderJob.build(sequence, get_region), make_render_backend(8000, true), out_path,
+    WavJoin.join)
+  assert.falsy(ok)
+  assert.equals('Render cancelled', err)
+  assert.falsy(io.open(out_path, 'rb'))
+end
+
+function render_tests.test_queue_refuses_when_user_renders_are_pending()
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local RenderQueue = require('arkitekt.reaper.render_queue')
+  local RenderJob = require('RegionPlaylist.domain.render_job')
+  local stub = ReaperStub.new()
+  stub.api.GetResourcePath = function() return '/stub' end
+  local sequence, get_region = make_render_sequence()
+  local job = RenderJob.build(sequence, get_region)
+
+  stub:run(function()
+    -- A render the user queued earlier would be rendered by 41207 as well
+    stub.host.files['/stub/QueuedRenders'] = { 'qrender_user.rpp' }
+    local ok, err = RenderJob.run(job, RenderQueue.new(0), '/stub/out.wav', function() return false, 'not reached' end)
+    assert.falsy(ok)
+    assert.truthy(err:find('already holds 1 render', 1, true), err)
+    assert.equals(0, #stub.commands, 'Nothing queued or rendered')
+
+    -- Empty queue: every range is queued, then rendered once
+    stub.host.files['/stub/QueuedRenders'] = nil
+    local queue = RenderQueue.new(0)
+    for i, range in ipairs(job.ranges) do
+      assert.truthy(queue:queue(range, '/stub/part' .. i .. '.wav'))
+    end
+    assert.equals(#job.ranges, RenderQueue.pending_count())
+    assert.truthy(queue:render())
+    assert.equals(0, RenderQueue.pending_count())
+    assert.equals(41207, stub.commands[#stub.commands])
+  end)
+end
+
+function render_tests.test_riff_size_counts_odd_pad_byte()
+  local WavJoin = require('RegionPlaylist.data.wav_join')
+  local fmt = string.pack('<I2I2I4I4I2I2', 1, 1, 8000, 8000, 1, 8)   -- 8-bit mono
+  local part = os.tmpname()
+  local f = io.open(part, 'wb')
+  f:write(WavJoin.header(fmt, 3), 'abc', '\0')
+  f:close()
+
+  local out_path = os.tmpname()
+  local ok, result = WavJoin.join({ part }, out_path)
+  assert.truthy(ok, tostring(result))
+  f = io.open(out_path, 'rb')
+  local bytes = f:read('a')
+  f:close()
+  os.remove(part)
+  os.remove(out_path)
+
+  -- RIFF size = file size - 8, pad byte included
+  assert.equals(#bytes - 8, string.unpack('<I4', bytes, 5))
+  assert.equals(44 + 3 + 1, #bytes)
+end
+
+-- ============================================================================
+-- PLAYBACK TRACE TESTS
+-- ============================================================================
+
+local trace_tests = {}
+
+-- Record a scripted show on the stand-in project: region 1 twice, then 3,
+-- then 2. The playhead moves 30 ms per frame; a queued GoToRegion jumps
+-- when the playhead reaches the end of the region it is in (smooth seek).
+local function record_show(capacity, context_interval)
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local Controller = require('RegionPlaylist.domain.playback.controller')
+  local Recorder = require('RegionPlaylist.domain.playback.recorder')
+  local TraceFile = require('RegionPlaylist.data.trace_file')
+
+  local stub = ReaperStub.new()
+  for r = 1, 3 do stub:add_region(r, (r - 1) * 4, r * 4, 'Region ' .. r) end
+  local clock, pending = 100, nil
+  stub.api.time_precise = function() return clock end
+  stub.api.GoToRegion = function(_, number) pending = number end
+
+  local path = os.tmpname()
+  local recorder = Recorder.new({ writer = TraceFile.create(path, capacity), context_interval = context_interval })
+  stub:run(function()
+    local engine = Controller.new({ proj = 0 })
+    engine:set_sequence({
+      { rid = 1, item_key = 'a', loop = 1, total_loops = 2 },
+      { rid = 1, item_key = 'a', loop = 2, total_loops = 2 },
+      { rid = 3, item_key = 'b', loop = 1, total_loops = 1 },
+      { rid = 2, item_key = 'c', loop = 1, total_loops = 1 },
+    })
+    engine:set_recorder(recorder)
+    engine:play()
+    stub.play_position = stub.cursor
+
+    for _ = 1, 560 do
+      clock = clock + 0.03
+      local pos = stub.play_position
+      local region_end = (pos // 4 + 1) * 4
+      pos = pos + 0.03
+      if pending and pos >= region_end then
+        pos = (pending - 1) * 4 + (pos - region_end)
+        pending = nil
+      end
+      stub.play_position = pos
+      engine:update()
+    end
+    engine:stop()
+  end)
+  recorder:close()
+  return path
+end
+
+function trace_tests.test_replay_of_recorded_show_matches()
+  local Replay = require('RegionPlaylist.domain.playback.replay')
+  local Recorder = require('RegionPlaylist.domain.playback.recorder')
+  local TraceFile = require('RegionPlaylist.data.trace_file')
+  local path = record_show(4096)
+
+  local records = TraceFile.read(path)
+  assert.not_nil(records)
+  local events = Replay.decode(records)
+  local methods = {}
+  for _, event in ipairs(events) do
+    if event.kind == 'seek' then methods[#methods + 1] = event.rid .. '/' .. event.method end
+  end
+  -- Fresh start on region 1, then smooth seeks for the repeat, 3 and 2
+  assert.equals('1/' .. Recorder.SEEK.START, methods[1])
+  assert.truthy(#methods >= 4)
+
+  local report = Replay.run(Replay.decode(TraceFile.read(path)))
+  os.remove(path)
+  assert.equals(560, report.frames)
+  assert.equals(2, report.commands)
+  assert.equals(0, report.skipped)
+  assert.equals(#methods, report.seeks)
+  assert.equals(0, #report.diffs)
+end
+
+function trace_tests.test_frame_records_the_inputs_the_engine_read()
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local Controller = require('RegionPlaylist.domain.playback.controller')
+  local Recorder = require('RegionPlaylist.domain.playback.recorder')
+  local Replay = require('RegionPlaylist.domain.playback.replay')
+  local TraceFile = require('RegionPlaylist.data.trace_file')
+
+  local stub = ReaperStub.new()
+  for r = 1, 2 do stub:add_region(r, (r - 1) * 4, r * 4, 'Region ' .. r) end
+  -- The playhead moves between reads: every read sees a later position
+  local reads = 0
+  stub.api.GetPlayPositionEx = function()
+    reads = reads + 1
+    return 3.5 + reads * 0.25
+  end
+
+  local path = os.tmpname()
+  local recorder = Recorder.new({ writer = TraceFile.create(path) })
+  local seen
+  stub:run(function()
+    local engine = Controller.new({ proj = 0 })
+    engine:set_sequence({
+      { rid = 1, item_key = 'a', loop = 1, total_loops = 1 },
+      { rid = 2, item_key = 'b', loop = 1, total_loops = 1 },
+    })
+    engine:set_recorder(recorder)
+    engine:play()
+    reads = 0
+    engine:update()
+    seen = reads
+    engine:stop()
+  end)
+  recorder:close()
+
+  -- One read per update, and that value is the one recorded
+  assert.equals(1, seen)
+  local frame
+  for _, event in ipairs(Replay.decode(TraceFile.read(path))) do
+    if event.kind == 'frame' then frame = event end
+  end
+  os.remove(path)
+  assert.equals(3.75, frame.playpos)
+end
+
+function trace_tests.test_changed_decision_is_reported_once()
+  local Replay = require('RegionPlaylist.domain.playback.replay')
+  local TraceFile = require('RegionPlaylist.data.trace_file')
+  local path = record_show(4096)
+  local events = Replay.decode(TraceFile.read(path))
+  os.remove(path)
+
+  -- The recording claims a different seek target than the engine picks
+  for _, event in ipairs(events) do
+    if event.kind == 'seek' and event.method == 1 then
+      event.rid = 99
+      break
+    end
+  end
+  local report = Replay.run(events)
+  assert.equals(1, #report.diffs)
+  assert.equals('seek', report.diffs[1].kind)
+  assert.equals('frame', report.diffs[1].step)
+end
+
+function trace_tests.test_wrapped_ring_replays_from_a_context()
+  local Replay = require('RegionPlaylist.domain.playback.replay')
+  local TraceFile = require('RegionPlaylist.data.trace_file')
+  local path = record_show(128, 32)
+  local report = Replay.run(Replay.decode(TraceFile.read(path)))
+  os.remove(path)
+
+  -- Oldest records were overwritten; replay starts at a repeated context
+  assert.truthy(report.frames > 0 and report.frames < 560)
+  assert.equals(0, #report.diffs)
+end
+
+function trace_tests.test_trace_spans_dump_as_chrome_json()
+  local Trace = require('arkitekt.debug.trace')
+  local JSON = require('arkitekt.core.json')
+  local was_enabled = Trace.enabled
+  Trace.enable(200)
+  os.remove(record_show(4096))
+  local events = Trace.events()
+  local path = os.tmpname()
+  local ok = Trace.dump(path)
+  if was_enabled then Trace.enable() else Trace.disable() end
+  assert.truthy(ok)
+
+  -- Only the newest 200 events are kept, every span finished
+  assert.truthy(#events > 0 and #events <= 200)
+  local names = {}
+  for _, event in ipairs(events) do
+    names[event.name] = true
+    if event.ph == 'X' then assert.not_nil(event.dur) end
+  end
+  assert.truthy(names['update'])
+  assert.truthy(names['seek_region'])
+
+  local f = io.open(path, 'r')
+  local doc = JSON.decode(f:read('a'))
+  f:close()
+  os.remove(path)
+  assert.equals(#events + 1, #doc.traceEvents)   -- Plus the thread name
+  assert.equals('M', doc.traceEvents[1].ph)
+end
+
+function trace_tests.test_disabled_trace_records_nothing()
+  local Trace = require('arkitekt.debug.trace')
+  local was_enabled = Trace.enabled
+  Trace.enable(16)
+  Trace.disable()
+  assert.is_nil(Trace.begin('engine', 'update'))
+  Trace.instant('engine', 'seek', 'rid', 1)
+  assert.equals(0, #Trace.events())
+  if was_enabled then Trace.enable() end
+end
+
+-- ============================================================================
+-- REGION OPERATION TESTS
+-- ============================================================================
+-- arkitekt/reaper/region_operations.lua against the stand-in project
+-- (tests/reaper_stub.lua, tests/fixtures.lua)
+
+local region_ops_tests = {}
+
+local function envelope_values(env)
+  local values = {}
+  for _, p in ipairs(env.points) do
+    values[#values + 1] = string.format('%g=%g', p.time, p.value)
+  end
+  return values
+end
+
+function region_ops_tests.test_looped_append_writes_every_repetition()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 2, regions = 3, points_per_region = 4 }
+  local reps = 2
+  local playlist = {}
+  for r = 1, session.regions do
+    playlist[r] = { rid = r, reps = reps }
+  end
+
+  local stub = Fixtures.make_session(session)
+  stub:run(function()
+    assert.truthy(RegionOps.append_playlist_to_project(playlist))
+  end)
+
+  local copies = session.regions * reps
+  assert.equals(session.tracks * (session.regions + copies), #stub:all_items())
+  assert.equals(session.regions + copies, #stub:regions())
+  -- Each copy carries its own tempo marker; the next region's marker on
+  -- its end boundary gives way to the following copy's start marker
+  assert.equals(session.regions + copies, #stub.tempo)
+
+  -- Copies go back to back from the project end
+  local positions = {}
+  for _, item in ipairs(stub.tracks[1].items) do positions[#positions + 1] = item.position end
+  table.sort(positions)
+  assert.equals('0 4 8 12 16 20 24 28 32', table.concat(positions, ' '))
+
+  -- Envelope copies add one trailing edge point each (they start on a
+  -- point) and are sorted once after the pass
+  local points = stub.tracks[1].envelopes[1].points
+  assert.equals(session.points_per_region * (session.regions + copies) + copies, #points)
+  for k = 2, #points do
+    assert.truthy(points[k - 1].time <= points[k].time)
+  end
+end
+
+function region_ops_tests.test_envelope_copies_start_and_end_on_source_values()
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+
+  local stub = ReaperStub.new()
+  stub:add_region(1, 2, 6, 'Middle')
+  stub:add_region(2, 0, 8, 'All')
+  local track = stub:add_track()
+  stub:add_item(track, 0, 8)
+  -- Linear ramp 0 -> 1 over 0..8, no point on the region bounds
+  local env = stub:add_envelope(track, { { 0, 0 }, { 8, 1 } })
+  stub:run(function()
+    assert.truthy(RegionOps.append_playlist_to_project({ { rid = 1, reps = 2 } }))
+  end)
+
+  local values = envelope_values(env)
+  assert.equals(6, #values)
+  table.sort(values)
+  assert.equals('0=0 12=0.25 12=0.75 16=0.75 8=0.25 8=1', table.concat(values, ' '))
+end
+
+function region_ops_tests.test_paste_opens_gap_on_master_envelope()
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+
+  local stub = ReaperStub.new()
+  stub:add_region(1, 0, 4, 'First')
+  stub:add_item(stub:add_track(), 0, 8)
+  local master_env = stub:add_envelope(stub.master, { { 1, 0.5 }, { 6, 1 } })
+  stub.cursor = 5
+  stub:run(function()
+    assert.truthy(RegionOps.paste_playlist_at_cursor({ { rid = 1, reps = 1 } }))
+  end)
+  -- Source 0..4 copied to 5..9 (edge values 0.5 and 0.8), old point at 6 moved to 10
+  assert.equals('1=0.5 5=0.5 6=0.5 9=0.8 10=1', table.concat(envelope_values(master_env), ' '))
+end
+
+function region_ops_tests.test_unsplit_restores_source_items()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 2, regions = 4, item_offset = 2 }
+
+  local stub = Fixtures.make_session(session)
+  stub:run(function()
+    for _, region in ipairs(stub:regions()) do
+      local splits = {}
+      RegionOps.split_items_in_region(0, region.pos, region.rgnend, splits)
+      RegionOps.unsplit_items(splits)
+    end
+  end)
+
+  assert.equals(session.tracks * session.regions, #stub:all_items())
+  for _, item in ipairs(stub.tracks[1].items) do
+    assert.equals(4, item.length)
+    assert.equals(0, item.takes[1].startoffs)
+  end
+end
+
+function region_ops_tests.test_append_copies_in_region_pieces_of_straddling_items()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+
+  local stub = Fixtures.make_session({ tracks = 1, regions = 2, item_offset = 2 })
+  stub:run(function()
+    assert.truthy(RegionOps.append_playlist_to_project({ { rid = 2, reps = 1 } }))
+  end)
+
+  local items = stub.tracks[1].items
+  assert.equals(4, #items)
+  assert.equals(4, items[1].length)
+  assert.equals(4, items[2].length)
+  assert.equals(10, items[3].position)  -- Project end (10) + piece offset (0)
+  assert.equals(2, items[3].length)
+  assert.equals(2, items[3].takes[1].startoffs)
+  assert.equals(12, items[4].position)
+  assert.equals(2, items[4].length)
+end
+
+function region_ops_tests.test_crop_to_new_tab_leaves_source_untouched()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 4, regions = 16, points_per_region = 8 }
+  local playlist = { { rid = 3, reps = 2 }, { rid = 7, reps = 1 }, { rid = 3, reps = 1 } }
+
+  local stub = Fixtures.make_session(session)
+  local new_proj
+  stub:run(function()
+    new_proj = RegionOps.crop_to_playlist_new_tab(playlist)
+  end)
+
+  -- Clipboard and undo are never used; the source project is untouched
+  for _, cmd in ipairs(stub.commands) do
+    assert.equals(41929, cmd)
+  end
+  assert.equals(session.tracks * session.regions, #stub:all_items())
+  assert.equals(session.regions, #stub:regions())
+
+  local tab = stub:current()
+  assert.equals(new_proj, tab)
+  assert.equals(session.tracks, #tab.tracks)
+  assert.equals(session.tracks * 4, #tab:all_items())
+  local regions = tab:regions()
+  assert.equals(4, #regions)
+  assert.equals(3, regions[1].number)
+  assert.equals(7, regions[3].number)
+  assert.equals(8, regions[3].pos)
+  assert.equals(16, regions[4].rgnend)
+  -- Envelopes start empty in the new tab and get the copied ranges only
+  assert.equals(4 * (session.points_per_region + 1), #tab.tracks[1].envelopes[1].points)
+  -- Tempo: one marker creates the tempo envelope, one chunk writes the rest
+  -- (4 start markers + the end marker of the last copy)
+  assert.equals(5, #tab.tempo)
+  assert.equals(1, stub.calls.SetTempoTimeSigMarker)
+  assert.equals(1, stub.calls.SetEnvelopeStateChunk)
+end
+
+function region_ops_tests.test_flatten_to_rpp_is_read_only_and_trims_items()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 2, regions = 8, points_per_region = 8, item_offset = 2 }
+  local reps = 8
+  local playlist = {}
+  for r = 1, session.regions do
+    playlist[r] = { rid = r, reps = reps }
+  end
+
+  local stub = Fixtures.make_session(session)
+  local path = os.tmpname()
+  local ok, stats
+  stub:run(function()
+    ok, stats = RegionOps.write_playlist_rpp(playlist, path)
+  end)
+  assert.truthy(ok)
+
+  -- Read-only: nothing in the open project was created or changed
+  for _, name in ipairs({ 'SplitMediaItem', 'AddMediaItemToTrack', 'SetItemStateChunk', 'SetMediaItemInfo_Value',
+      'SetTempoTimeSigMarker', 'InsertEnvelopePoint', 'AddProjectMarker2', 'SetTrackStateChunk' }) do
+    assert.is_nil(stub.calls[name])
+  end
+  assert.equals(session.tracks * session.regions, #stub:all_items())
+
+  local f = io.open(path, 'rb')
+  local text = f:read('a')
+  f:close()
+  os.remove(path)
+
+  local copies = session.regions * reps
+  assert.equals(copies, stats.regions)
+  assert.equals(copies * 2, select(2, text:gsub('\n  MARKER ', '')))
+  -- Region 1 holds the first half of one item, the others two halves each
+  assert.equals(session.tracks * (2 * copies - reps), stats.items)
+  assert.equals(stats.items, select(2, text:gsub('\n<ITEM', '')))
+  assert.is_nil(text:find('IGUID', 1, true))
+
+  -- Trimmed pieces parse back with the right position/length/offset
+  local check = ReaperStub.new()
+  local track = check:add_track()
+  check:_apply_track_chunk(track, text:match('\n(<TRACK.-)\n<TRACK'))
+  local items = track.items
+  assert.equals(2 * copies - reps, #items)
+  assert.equals(2, items[1].position)
+  assert.equals(2, items[1].length)
+  assert.equals(0, items[1].takes[1].startoffs)
+  -- Second copy of region 1 at 4, then region 2's copies from 32
+  assert.equals(6, items[2].position)
+  assert.equals(32, items[reps + 1].position)
+  assert.equals(2, items[reps + 1].takes[1].startoffs)
+  assert.equals(34, items[reps + 2].position)
+  assert.equals(0, items[reps + 2].takes[1].startoffs)
+  assert.equals(stats.points, select(2, text:gsub('\nPT ', '')))
+end
+
+-- Paste session: 8 regions with straddling items, cursor at 8, four items
+-- of four loops each
+local PASTE_SESSION = { tracks = 2, regions = 8, points_per_region = 8, item_offset = 2 }
+local PASTE_PLAYLIST = { { rid = 2, reps = 4 }, { rid = 5, reps = 4 }, { rid = 3, reps = 4 }, { rid = 8, reps = 4 } }
+
+local function new_paste_session()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local stub = Fixtures.make_session(PASTE_SESSION)
+  stub.cursor = 8
+  return stub
+end
+
+local function plan_paste()
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local stub = new_paste_session()
+  local plan = stub:run(function()
+    return RegionOps.plan_playlist('paste', PASTE_PLAYLIST)
+  end)
+  return plan, stub
+end
+
+-- Apply a plan to a fresh paste session in one step
+local function paste_one_shot(plan)
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local stub = new_paste_session()
+  stub:run(function()
+    RegionOps.apply_plan(plan):step()
+  end)
+  return stub
+end
+
+function region_ops_tests.test_paste_plan_is_read_only_with_summary()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local tracks = PASTE_SESSION.tracks
+
+  local plan, stub = plan_paste()
+  assert.equals(Fixtures.session_signature(new_paste_session()), Fixtures.session_signature(stub))
+  for _, name in ipairs({ 'SplitMediaItem', 'AddMediaItemToTrack', 'ApplyNudge', 'InsertEnvelopePoint',
+      'SetTempoTimeSigMarker', 'AddProjectMarker2' }) do
+    assert.is_nil(stub.calls[name])
+  end
+
+  local summary = plan.summary
+  assert.equals(16, summary.copies)
+  assert.equals(16, #plan.regions)
+  assert.equals(4, #plan.sources)
+  assert.equals(8, plan.silence.position)
+  assert.equals(64, plan.silence.length)
+  assert.equals(tracks * 2 * 16, summary.items)         -- Each region cuts two items per track
+  assert.equals(tracks * 9 * 16, summary.points)        -- 8 points + trailing edge
+  assert.equals(16, summary.tempo)                      -- One start marker per copy
+  assert.equals(tracks * 6, summary.moved_items)
+  assert.truthy(RegionOps.describe_plan(plan):find('16 copies', 1, true))
+  -- Destination ranges per item and loop
+  assert.equals(8, plan.copies[1].start)
+  assert.equals(12, plan.copies[2].start)
+  assert.equals(5, plan.copies[5].block.region.rid)
+  assert.equals(24, plan.copies[5].start)
+end
+
+function region_ops_tests.test_paste_apply_matches_summary()
+  local session = PASTE_SESSION
+  local plan = plan_paste()
+  local summary = plan.summary
+
+  local stub = paste_one_shot(plan)
+  assert.equals(-1, stub.host.undo_flags)   -- Undo point covers tempo, envelopes and regions
+  assert.equals(summary.items, stub.calls.AddMediaItemToTrack)
+  assert.equals(session.tracks * session.regions + summary.items, #stub:all_items())
+  assert.equals(session.regions * session.points_per_region + 9 * 16, #stub.tracks[1].envelopes[1].points)
+  assert.equals(session.regions + summary.tempo, #stub.tempo)
+  assert.equals(session.regions + summary.regions, #stub:regions())
+end
+
+function region_ops_tests.test_stepped_paste_matches_one_shot()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local plan = plan_paste()
+  local after = Fixtures.session_signature(paste_one_shot(plan))
+
+  -- One unit per step, same result
+  local stub = new_paste_session()
+  local job, steps = nil, 0
+  stub:run(function()
+    job = RegionOps.apply_plan(plan)
+    repeat
+      steps = steps + 1
+    until job:step(0)
+  end)
+  assert.equals(job.units_total, steps)
+  assert.equals(1, job:progress())
+  assert.equals('done', job.state)
+  assert.equals(after, Fixtures.session_signature(stub))
+
+  -- Switching tabs mid-job: the job keeps writing to its own project
+  stub = new_paste_session()
+  local other
+  stub:run(function()
+    job = RegionOps.apply_plan(plan)
+    job:step(0)
+    reaper.Main_OnCommand(41929, 0)  -- New project tab becomes current
+    other = stub.host.current
+    repeat until job:step(0)
+  end)
+  assert.equals('done', job.state)
+  assert.equals(after, Fixtures.session_signature(stub))
+  assert.equals(0, #other.tracks)
+  assert.equals(0, #other.markers)
+end
+
+function region_ops_tests.test_cancelled_paste_rolls_back()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local plan = plan_paste()
+  local before = Fixtures.session_signature(new_paste_session())
+
+  -- Cancel part way (before and after the gap opened)
+  for _, stop_after in ipairs({ 2, #plan.sources + 6 }) do
+    local stub = new_paste_session()
+    local job
+    stub:run(function()
+      job = RegionOps.apply_plan(plan)
+      for _ = 1, stop_after do job:step(0) end
+      job:cancel()
+    end)
+    assert.equals('cancelled', job.state)
+    assert.equals(before, Fixtures.session_signature(stub))
+  end
+
+  -- An item the job wrote is deleted between steps: roll back and stop
+  local stub = new_paste_session()
+  local job
+  stub:run(function()
+    job = RegionOps.apply_plan(plan)
+    for _ = 1, #plan.sources + 3 do job:step(0) end
+    local item = job.dest.created.items[1]
+    reaper.DeleteTrackMediaItem(reaper.GetMediaItem_Track(item), item)
+    assert.truthy(job:step(0))
+  end)
+  assert.equals('cancelled', job.state)
+  assert.not_nil(job.error)
+  assert.equals(before, Fixtures.session_signature(stub))
+end
+
+function region_ops_tests.test_tempo_copies_go_in_one_chunk()
+  local Fixtures = require('RegionPlaylist.tests.fixtures')
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local session = { tracks = 1, regions = 4 }
+  local per_region, reps = 4, 3
+  local playlist = {}
+  for r = 1, session.regions do
+    playlist[r] = { rid = r, reps = reps }
+  end
+
+  local stub = Fixtures.make_session(session)
+  for r = 1, session.regions do
+    for k = 1, per_region - 1 do
+      stub:add_tempo((r - 1) * 4 + k * 4 / per_region, 100 + r + k, 0, 0)
+    end
+  end
+  stub:run(function()
+    assert.truthy(RegionOps.append_playlist_to_project(playlist))
+  end)
+
+  assert.is_nil(stub.calls.SetTempoTimeSigMarker)
+  assert.equals(1, stub.calls.SetEnvelopeStateChunk)
+  local copies = session.regions * reps
+  assert.equals(session.regions * per_region + copies * per_region, #stub.tempo)
+  -- Junction markers: the next copy's start wins (region 1 copy 2, not region 2)
+  local project_end = session.regions * 4
+  local at = {}
+  for _, m in ipairs(stub.tempo) do at[m.time] = m end
+  assert.equals(101, at[project_end + 4].bpm)
+  assert.equals(4, at[project_end + 4].num)
+  assert.equals(4, at[project_end + 4].denom)
+  assert.equals(102, at[project_end + 4 * reps].bpm)
+  for k = 2, #stub.tempo do
+    assert.truthy(stub.tempo[k - 1].time < stub.tempo[k].time)
+  end
+end
+
+-- ============================================================================
+-- PLAYLIST CODEC TESTS
+-- ============================================================================
+
+local codec_tests = {}
+
+-- Two playlists covering every item shape: UUID and plain keys, runs that
+-- share everything but the key, nil reps/enabled and a nested playlist
+local function make_codec_playlists()
+  local items = {}
+  for i = 1, 6 do
+    items[i] = {
+      type = 'region', rid = i <= 3 and 7 or 2 + i, reps = 1, enabled = true,
+      guid = '{00000007-0000-0000-0000-000000000000}', region_name = 'Verse',
+      key = string.format('%08x-0000-4000-8000-%012x', 1, i),
+    }
+  end
+  items[7] = { type = 'region', rid = 1, enabled = false, key = 'item_7' }
+  items[8] = { type = 'playlist', playlist_id = 'pl_2', reps = 0, key = 'item_8' }
+  return {
+    { id = 'pl_1', name = 'Main', chip_color = -16776961, items = items },
+    { id = 'pl_2', name = 'Intro', items = {} },
+  }
+end
+
+function codec_tests.test_round_trip_is_lossless()
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+  local playlists = make_codec_playlists()
+
+  local text = PlaylistCodec.encode(playlists)
+  assert.not_nil(text)
+  local decoded = PlaylistCodec.decode(text)
+  assert.equals(#playlists, #decoded)
+  for p, pl in ipairs(playlists) do
+    local out = decoded[p]
+    assert.equals(pl.id, out.id)
+    assert.equals(pl.name, out.name)
+    assert.equals(pl.chip_color, out.chip_color)
+    assert.equals(#pl.items, #out.items)
+    for i, item in ipairs(pl.items) do
+      for _, field in ipairs({ 'type', 'rid', 'playlist_id', 'guid', 'region_name', 'reps', 'enabled', 'key' }) do
+        assert.equals(item[field], out.items[i][field])
+      end
+    end
+  end
+end
+
+function codec_tests.test_is_compact_detects_prefix()
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+  assert.truthy(PlaylistCodec.is_compact(PlaylistCodec.encode(make_codec_playlists())))
+  assert.falsy(PlaylistCodec.is_compact('[{"id":"pl_1","items":[]}]'))
+  assert.falsy(PlaylistCodec.is_compact(''))
+  assert.falsy(PlaylistCodec.is_compact(nil))
+end
+
+function codec_tests.test_unknown_fields_are_declined()
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+  local playlists = make_codec_playlists()
+  playlists[2].shuffle = true
+  local text, err = PlaylistCodec.encode(playlists)
+  assert.is_nil(text)
+  assert.not_nil(err)
+
+  playlists = make_codec_playlists()
+  playlists[1].items[3].fade = 0.5
+  assert.is_nil(PlaylistCodec.encode(playlists))
+end
+
+function codec_tests.test_non_integer_reps_fall_back_to_json()
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+  local playlists = make_codec_playlists()
+  playlists[1].items[2].reps = 1.5
+
+  assert.is_nil(PlaylistCodec.encode(playlists))
+  local text, reason = PlaylistCodec.encode_text(playlists, true)
+  assert.falsy(PlaylistCodec.is_compact(text))
+  assert.not_nil(reason)
+  assert.equals(1.5, PlaylistCodec.decode_text(text)[1].items[2].reps)
+end
+
+function codec_tests.test_corrupted_blocks_are_rejected()
+  local PlaylistCodec = require('RegionPlaylist.data.playlist_codec')
+  local Base64 = require('arkitekt.core.base64')
+  local text = PlaylistCodec.encode(make_codec_playlists())
+  local prefix = text:match('^[^:]+:')
+  local data = Base64.decode(text:sub(#prefix + 1))
+
+  -- Every truncation fails cleanly instead of returning partial playlists
+  for cut = 0, #data - 1 do
+    local playlists, err = PlaylistCodec.decode(prefix .. Base64.encode(data:sub(1, cut)))
+    assert.is_nil(playlists)
+    assert.not_nil(err)
+  end
+
+  local playlists, err = PlaylistCodec.decode(prefix .. '!!not base64!!')
+  assert.is_nil(playlists)
+  assert.not_nil(err)
+
+  -- Unknown version
+  playlists, err = PlaylistCodec.decode(prefix .. Base64.encode(string.char(99) .. data:sub(2)))
+  assert.is_nil(playlists)
+  assert.not_nil(err)
+
+  -- decode_text reports the failure too
+  assert.is_nil(PlaylistCodec.decode_text(prefix .. Base64.encode(data:sub(1, #data // 2))))
+end
+
+-- ============================================================================
+-- PLAYLIST LIBRARY TESTS
+-- ============================================================================
+
+local library_tests = {}
+
+-- Regions of the exporting project and of the project importing into:
+-- renumbered, renamed, moved and missing regions
+local LIBRARY_SOURCE = {
+  { rid = 1, name = 'Intro', start = 50, ['end'] = 60 },
+  { rid = 2, name = 'Bridge', start = 20, ['end'] = 28 },
+  { rid = 3, name = 'Outro', start = 70, ['end'] = 80 },
+  { rid = 4, name = 'Verse', start = 30, ['end'] = 38 },
+  { rid = 9, name = 'Gone', start = 300, ['end'] = 310 },
+}
+local LIBRARY_TARGET = {
+  { rid = 7, name = 'Intro', start = 0, ['end'] = 10, guid = '{G7}' },       -- same name, new number
+  { rid = 2, name = 'Bridge 2', start = 20, ['end'] = 28, guid = '{G2}' },   -- renamed, same position
+  { rid = 3, name = 'Other', start = 99, ['end'] = 100, guid = '{G3}' },     -- number only
+  { rid = 5, name = 'Verse', start = 40, ['end'] = 48, guid = '{G5}' },      -- name taken twice
+  { rid = 4, name = 'Verse', start = 0, ['end'] = 1, guid = '{G4}' },        -- name and number
+}
+
+function library_tests.test_match_regions_prefers_exact_then_name_position_number()
+  local PlaylistLibrary = require('RegionPlaylist.data.playlist_library')
+  local map, matched = PlaylistLibrary.match_regions(LIBRARY_SOURCE, LIBRARY_TARGET)
+
+  assert.equals(7, map[1].rid)
+  assert.equals(2, map[2].rid)
+  assert.equals(3, map[3].rid)
+  assert.equals(4, map[4].rid)
+  assert.is_nil(map[9])
+  assert.equals(1, matched.exact)
+  assert.equals(1, matched.name)
+  assert.equals(1, matched.position)
+  assert.equals(1, matched.number)
+end
+
+function library_tests.test_match_regions_name_beats_position()
+  local PlaylistLibrary = require('RegionPlaylist.data.playlist_library')
+  local map, matched = PlaylistLibrary.match_regions(
+    { { rid = 8, name = 'Bridge 2', start = 0, ['end'] = 10 } }, LIBRARY_TARGET)
+  assert.equals(2, map[8].rid)
+  assert.equals(1, matched.name)
+
+  -- Position match within tolerance, number ignored when the position matches
+  map, matched = PlaylistLibrary.match_regions(
+    { { rid = 3, name = '', start = 20.0004, ['end'] = 27.9996 } }, LIBRARY_TARGET)
+  assert.equals(2, map[3].rid)
+  assert.equals(1, matched.position)
+end
+
+function library_tests.test_prepare_import_remaps_ids_and_keys()
+  local PlaylistLibrary = require('RegionPlaylist.data.playlist_library')
+  local n = 0
+  local function counter() n = n + 1 return 'new_' .. n end
+  local source_items = {
+    { type = 'region', rid = 1, reps = 2, enabled = true, key = 'k1' },
+    { type = 'region', rid = 9, reps = 1, enabled = true, key = 'k2' },
+    { type = 'playlist', playlist_id = 'b', reps = 1, enabled = false, key = 'k3' },
+    { type = 'playlist', playlist_id = 'missing', reps = 1, enabled = true, key = 'k4' },
+    { type = 'playlist', playlist_id = 'kept', key = 'k5' },
+  }
+  local imported, report = PlaylistLibrary.prepare_import({
+    { playlist = { id = 'a', name = 'A', chip_color = 42, items = source_items }, regions = LIBRARY_SOURCE },
+    { playlist = { id = 'b', name = 'B', items = {} }, regions = {} },
+  }, LIBRARY_TARGET, { new_id = counter, new_key = counter, existing_ids = { kept = true } })
+
+  assert.equals(2, #imported)
+  assert.equals('new_1', imported[1].id)
+  assert.equals('new_2', imported[2].id)
+  assert.equals('A', imported[1].name)
+  assert.equals(42, imported[1].chip_color)
+
+  local items = imported[1].items
+  assert.equals(3, #items)
+  assert.equals(7, items[1].rid)
+  assert.equals('{G7}', items[1].guid)
+  assert.equals('Intro', items[1].region_name)
+  assert.equals(2, items[1].reps)
+  assert.equals(imported[2].id, items[2].playlist_id)
+  assert.falsy(items[2].enabled)
+  assert.equals('kept', items[3].playlist_id)
+  assert.equals(1, items[3].reps)
+  assert.truthy(items[3].enabled)
+
+  -- Every item gets a fresh key; the library entry is left alone
+  local seen = {}
+  for _, item in ipairs(items) do
+    assert.equals('new_', item.key:sub(1, 4))
+    assert.falsy(seen[item.key])
+    seen[item.key] = true
+  end
+  assert.equals('k1', source_items[1].key)
+  assert.equals(1, source_items[1].rid)
+
+  assert.equals(2, report.playlists)
+  assert.equals(3, report.items)
+  assert.equals(1, report.dropped_regions)
+  assert.equals(1, report.dropped_nested)
+  assert.equals(1, report.matched.name)
+end
+
+function library_tests.test_write_then_open_reads_entries_lazily()
+  local PlaylistLibrary = require('RegionPlaylist.data.playlist_library')
+  local playlists = {
+    { id = 'pl_1', name = 'Main set', items = {
+      { type = 'region', rid = 2, reps = 1, enabled = true, key = 'a' },
+      { type = 'playlist', playlist_id = 'pl_2', reps = 3, enabled = true, key = 'b' },
+    } },
+    { id = 'pl_2', name = 'Encore', items = {} },
+  }
+  local region_index = { [2] = { rid = 2, name = 'Bridge', start = 20, ['end'] = 28 } }
+
+  local path = os.tmpname()
+  assert.truthy(PlaylistLibrary.write(path, playlists, region_index))
+  local library = PlaylistLibrary.open(path)
+  assert.not_nil(library)
+  assert.equals(2, library:count())
+  assert.equals('Main set', library:info(1).name)
+  assert.equals(2, library:info(1).item_count)
+  assert.is_nil(next(library.cache))
+
+  local entry = library:get(1)
+  assert.equals(3, entry.playlist.items[2].reps)
+  assert.equals('Bridge', entry.regions[1].name)
+  assert.equals(entry, library:get(1))
+  library:close()
+  os.remove(path)
+end
+
+-- ============================================================================
+-- UNDO SNAPSHOT TESTS
+-- ============================================================================
+
+local undo_tests = {}
+
+local function make_undo_playlists()
+  local playlists = {}
+  for p = 1, 3 do
+    local items = {}
+    for i = 1, 4 do
+      items[i] = { type = 'region', rid = i, reps = 1, enabled = true, key = p .. '_' .. i }
+    end
+    playlists[p] = { id = 'pl_' .. p, name = 'Playlist ' .. p, items = items }
+  end
+  return playlists
+end
+
+-- Capture on a stand-in project holding regions 1-4
+local function with_undo_project(fn)
+  local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+  local UndoBridge = require('RegionPlaylist.data.undo')
+  local stub = ReaperStub.new()
+  for r = 1, 4 do stub:add_region(r, (r - 1) * 4, r * 4, 'Region ' .. r) end
+  UndoBridge.invalidate_all()
+  stub:run(function() fn(UndoBridge) end)
+end
+
+function undo_tests.test_unedited_playlists_share_frozen_copies()
+  with_undo_project(function(UndoBridge)
+    local playlists = make_undo_playlists()
+    local first = UndoBridge.capture_snapshot(playlists, 'pl_1')
+    local second = UndoBridge.capture_snapshot(playlists, 'pl_1')
+    for p = 1, #playlists do
+      assert.equals(first.playlists[p], second.playlists[p])
+      assert.truthy(first.playlists[p] ~= playlists[p])
+      assert.truthy(first.playlists[p].items[1] ~= playlists[p].items[1])
+    end
+
+    playlists[2].items[1].reps = 5
+    UndoBridge.mark_dirty(playlists[2])
+    local third = UndoBridge.capture_snapshot(playlists, 'pl_1')
+    assert.equals(first.playlists[1], third.playlists[1])
+    assert.equals(first.playlists[3], third.playlists[3])
+    assert.truthy(first.playlists[2] ~= third.playlists[2])
+    assert.equals(5, third.playlists[2].items[1].reps)
+    assert.equals(1, first.playlists[2].items[1].reps)
+  end)
+end
+
+function undo_tests.test_reorder_is_recopied_after_mark_dirty()
+  with_undo_project(function(UndoBridge)
+    local playlists = make_undo_playlists()
+    local before = UndoBridge.capture_snapshot(playlists, 'pl_1')
+
+    -- Same item count, new order
+    local items = playlists[3].items
+    items[1], items[2] = items[2], items[1]
+    UndoBridge.mark_dirty(playlists[3])
+    local after = UndoBridge.capture_snapshot(playlists, 'pl_1')
+    assert.equals('3_2', after.playlists[3].items[1].key)
+    assert.equals('3_1', before.playlists[3].items[1].key)
+
+    -- invalidate_all drops every frozen copy
+    UndoBridge.invalidate_all()
+    local fresh = UndoBridge.capture_snapshot(playlists, 'pl_1')
+    assert.truthy(fresh.playlists[1] ~= after.playlists[1])
+  end)
+end
+
+function undo_tests.test_restore_snapshot_seeds_frozen_cache()
+  with_undo_project(function(UndoBridge)
+    local playlists = make_undo_playlists()
+    playlists[3].items[4].rid = 9  -- Region no longer in the project
+    local snapshot = UndoBridge.capture_snapshot(playlists, 'pl_2')
+
+    local region_index = {}
+    for r = 1, 4 do region_index[r] = { rid = r } end
+    local restored, active, changes = UndoBridge.restore_snapshot(snapshot, region_index)
+    assert.equals('pl_2', active)
+    assert.equals(11, changes.items_count)
+    assert.truthy(restored[1] ~= snapshot.playlists[1])
+
+    -- Complete restores share the snapshot's copy; the one that lost an
+    -- item is copied again
+    local next_snapshot = UndoBridge.capture_snapshot(restored, 'pl_2')
+    assert.equals(snapshot.playlists[1], next_snapshot.playlists[1])
+    assert.equals(snapshot.playlists[2], next_snapshot.playlists[2])
+    assert.truthy(snapshot.playlists[3] ~= next_snapshot.playlists[3])
+    assert.equals(3, #next_snapshot.playlists[3].items)
+  end)
+end
+
+-- ============================================================================
+-- RPP SCAN TESTS
+-- ============================================================================
+
+local rpp_scan_tests = {}
+
+function rpp_scan_tests.test_malformed_lines_are_reported()
+  local RppScan = require('RegionPlaylist.data.rpp_scan')
+  local playlists = RppScan.parse_sws_playlists(table.concat({
+    '<S&M_RGN_PLAYLIST x 0',
+    '1073741825 2',
+    'bogus line',
+    '',
+    '1073741826 -1',
+    '12 abc',
+    '>',
+  }, '\n'))
+
+  local pl = playlists[1]
+  assert.equals(2, pl.count)
+  assert.equals(2, pl.malformed_count)
+  assert.equals('bogus line', pl.malformed[1].text)
+  assert.equals(2, pl.malformed[1].entry)
+  assert.equals('12 abc', pl.malformed[2].text)
+  assert.equals(-1, pl.sws_loop_counts[2])
+
+  -- The count stays exact past the reporting cap
+  local lines = { '<S&M_RGN_PLAYLIST y 0' }
+  for i = 1, 25 do lines[#lines + 1] = 'junk ' .. i end
+  lines[#lines + 1] = '>'
+  pl = RppScan.parse_sws_playlists(table.concat(lines, '\n'))[1]
+  assert.equals(0, pl.count)
+  assert.equals(25, pl.malformed_count)
+  assert.equals(20, #pl.malformed)
+end
+
+function rpp_scan_tests.test_crlf_line_endings()
+  local RppScan = require('RegionPlaylist.data.rpp_scan')
+  local playlists = RppScan.parse_sws_playlists(table.concat({
+    '<PROJECT',
+    '  <S&M_RGN_PLAYLIST "Main Set" 1',
+    '    1073741825 2',
+    '    1073741827 -1',
+    '    5 1',
+    '    not an item',
+    '  >',
+    '  <S&M_RGN_PLAYLIST Encore 0',
+    '    1073741826 1',
+    '  >',
+    '>',
+    '',
+  }, '\r\n'))
+
+  assert.equals(2, #playlists)
+  local main = playlists[1]
+  assert.equals('Main Set', main.name)
+  assert.truthy(main.is_active)
+  assert.equals(3, main.count)
+  assert.equals(1, main.region_numbers[1])
+  assert.equals(3, main.region_numbers[2])
+  assert.falsy(main.region_numbers[3])
+  assert.equals(-1, main.sws_loop_counts[2])
+  assert.equals(1, main.malformed_count)
+  assert.equals('    not an item', main.malformed[1].text)
+
+  assert.equals('Encore', playlists[2].name)
+  assert.falsy(playlists[2].is_active)
+  assert.equals(1, playlists[2].count)
+  assert.equals(0, playlists[2].malformed_count)
+end
+
+function rpp_scan_tests.test_last_line_without_newline()
+  local RppScan = require('RegionPlaylist.data.rpp_scan')
+  local pl = RppScan.parse_sws_playlists('<S&M_RGN_PLAYLIST x 0\n1073741825 2\n1073741827 3')[1]
+  assert.equals(2, pl.count)
+  assert.equals(3, pl.region_numbers[2])
+  assert.equals(3, pl.sws_loop_counts[2])
+  assert.equals(0, pl.malformed_count)
+
+  -- Same with CRLF and trailing blanks, and a header alone
+  pl = RppScan.parse_sws_playlists('<S&M_RGN_PLAYLIST x 1\r\n1073741825 2\r\n1073741826 4  ')[1]
+  assert.equals(2, pl.count)
+  assert.equals(4, pl.sws_loop_counts[2])
+  assert.truthy(pl.is_active)
+  pl = RppScan.parse_sws_playlists('<S&M_RGN_PLAYLIST "Empty" 0')[1]
+  assert.equals('Empty', pl.name)
+  assert.equals(0, pl.count)
+end
+
 -- ============================================================================
 -- REGISTER TEST SUITES
 -- ============================================================================
@@ -562,10 +2182,26 @@ TestRunner.register('RegionPlaylist.domain.region', region_tests)
 TestRunner.register('RegionPlaylist.domain.playlist', playlist_tests)
 TestRunner.register('RegionPlaylist.ui.state.preferences', ui_pref_tests)
 TestRunner.register('RegionPlaylist.domain.dependency', dependency_tests)
+TestRunner.register('RegionPlaylist.domain.playlist_audit', audit_tests)
+TestRunner.register('RegionPlaylist.domain.render_job', render_tests)
+TestRunner.register('RegionPlaylist.domain.playback_trace', trace_tests)
+TestRunner.register('RegionPlaylist.region_operations', region_ops_tests)
+TestRunner.register('RegionPlaylist.data.playlist_codec', codec_tests)
+TestRunner.register('RegionPlaylist.data.playlist_library', library_tests)
+TestRunner.register('RegionPlaylist.data.undo', undo_tests)
+TestRunner.register('RegionPlaylist.data.rpp_scan', rpp_scan_tests)
 
 return {
   region = region_tests,
   playlist = playlist_tests,
   ui_preferences = ui_pref_tests,
   dependency = dependency_tests,
+  playlist_audit = audit_tests,
+  render_job = render_tests,
+  playback_trace = trace_tests,
+  region_operations = region_ops_tests,
+  playlist_codec = codec_tests,
+  playlist_library = library_tests,
+  undo = undo_tests,
+  rpp_scan = rpp_scan_tests,
 }
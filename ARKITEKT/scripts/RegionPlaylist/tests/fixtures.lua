@@ -0,0 +1,103 @@
+-- @noindex
+-- RegionPlaylist/tests/fixtures.lua
+-- Synthetic stand-in projects shared by the tests and the benchmarks
+-- (built on tests/reaper_stub.lua)
+
+local ReaperStub = require('RegionPlaylist.tests.reaper_stub')
+
+local M = {}
+
+--- Build a stand-in session: regions back to back, one MIDI item per track
+--- per region, one envelope per track and a tempo marker per region
+--- @param opts table {tracks, regions, region_length, payload, points_per_region,
+---   item_offset (shift items so they straddle region bounds)}
+--- @return table stub
+function M.make_session(opts)
+  local stub = ReaperStub.new()
+  local len = opts.region_length or 4
+  for r = 1, opts.regions do
+    local start = (r - 1) * len
+    stub:add_region(r, start, start + len, 'Region ' .. r, 0x336699FF)
+    stub:add_tempo(start, 100 + r, 4, 4)
+  end
+  for _ = 1, opts.tracks do
+    local track = stub:add_track()
+    local points = {}
+    local per = opts.points_per_region or 0
+    for r = 1, opts.regions do
+      local start = (r - 1) * len
+      stub:add_item(track, start + (opts.item_offset or 0), len, { payload = opts.payload })
+      for k = 0, per - 1 do
+        points[#points + 1] = { start + k * len / per, k / per }
+      end
+    end
+    if per > 0 then stub:add_envelope(track, points) end
+  end
+  return stub
+end
+
+--- Items, tempo markers, envelope points and markers of a stand-in project
+--- @param stub table Stand-in project
+--- @return string signature Equal for projects with the same content
+function M.session_signature(stub)
+  local parts = {}
+  for t, track in ipairs(stub.tracks) do
+    local items = {}
+    for _, item in ipairs(track.items) do
+      items[#items + 1] = string.format('%.9f/%.9f', item.position, item.length)
+    end
+    table.sort(items)
+    parts[#parts + 1] = t .. ':' .. table.concat(items, ',')
+    for _, env in ipairs(track.envelopes) do
+      local points = {}
+      for _, p in ipairs(env.points) do
+        points[#points + 1] = string.format('%.9f=%.9f', p.time, p.value)
+      end
+      parts[#parts + 1] = table.concat(points, ',')
+    end
+  end
+  for _, m in ipairs(stub.tempo) do
+    parts[#parts + 1] = string.format('T%.9f/%g', m.time, m.bpm)
+  end
+  for _, m in ipairs(stub.markers) do
+    parts[#parts + 1] = string.format('M%d/%.9f/%.9f', m.number, m.pos, m.rgnend)
+  end
+  return table.concat(parts, '\n')
+end
+
+--- Build a synthetic marker store: n back-to-back regions (every 100th one
+--- reaches into the next, so it has a nested region), a marker inside every
+--- 50th region, and four playlists (the active one plays every region; the
+--- last nests the first)
+--- @param n number Region count
+--- @return table project {stub, regions, markers, playlists}
+function M.make_marker_project(n)
+  local stub = ReaperStub.new()
+  local regions, markers = {}, {}
+  for r = 1, n do
+    local start = (r - 1) * 2
+    local region = { rid = r, name = 'Region ' .. r, start = start, ['end'] = start + (r % 100 == 0 and 3 or 2) }
+    regions[r] = region
+    stub:add_region(r, region.start, region['end'], region.name, 0x336699FF)
+    if r % 50 == 0 then
+      markers[#markers + 1] = { number = #markers + 1, name = 'Cue', pos = start + 1 }
+      stub:add_marker(#markers, start + 1, 'Cue')
+    end
+  end
+
+  local playlists = {}
+  for p = 1, 4 do
+    local count = p == 1 and n or math.max(1, n // 4)
+    local items = {}
+    for i = 1, count do
+      items[i] = { type = 'region', rid = (i * p - 1) % n + 1, reps = 1, enabled = true, key = p .. '_item_' .. i }
+    end
+    if p == 4 then
+      items[1] = { type = 'playlist', playlist_id = 'pl_1', reps = 1, enabled = true, key = '4_nested' }
+    end
+    playlists[p] = { id = 'pl_' .. p, name = 'Playlist ' .. p, items = items, chip_color = 0xFF0000FF }
+  end
+  return { stub = stub, regions = regions, markers = markers, playlists = playlists }
+end
+
+return M
@@ -0,0 +1,710 @@
+-- @noindex
+-- RegionPlaylist/tests/reaper_stub.lua
+-- In-memory stand-in for the REAPER project API (tracks, items, envelopes,
+-- tempo map, regions) so region operations can be benchmarked headless
+--
+-- Models just enough of REAPER for arkitekt/reaper/region_operations.lua:
+-- item and track state chunks are real text (parsed on Set*StateChunk, so
+-- large MIDI payloads cost what they would), tempo markers are kept sorted
+-- and envelope inserts honour noSort; the master "Tempo map" envelope mirrors
+-- the tempo map as a state chunk. Project tabs are supported (41929
+-- opens one); play state and position are plain fields (GoToRegion moves
+-- the play position) for the playback engine. Every API call is counted in
+-- stub.calls, shared across tabs.
+--
+-- USAGE:
+--   local stub = ReaperStub.new()
+--   local track = stub:add_track()
+--   stub:add_item(track, 0, 4, { payload = 2000 })
+--   stub:add_region(1, 0, 4, 'Verse')
+--   stub:run(function() RegionOps.append_playlist_to_project(items) end)
+
+local M = {}
+
+local format = string.format
+
+local Stub = {}
+Stub.__index = Stub
+
+-- ============================================================================
+-- PROJECT MODEL
+-- ============================================================================
+
+--- Create an empty stand-in project (the first tab of a new host)
+--- @param host table|nil Shared tab state (internal: new tabs)
+--- @return table stub
+function M.new(host)
+  local self = setmetatable({
+    tracks = {},
+    markers = {},       -- Regions and markers, sorted by position
+    tempo = {},         -- Tempo markers, sorted by time
+    cursor = 0,
+    play_state = 0,     -- GetPlayState bits (1 = playing, 2 = paused)
+    play_position = 0,
+    state_change_count = 0,
+    loop_range = { 0, 0 },
+    item_list = nil,    -- Flattened item list (rebuilt lazily)
+  }, Stub)
+  self.master = { items = {}, envelopes = {}, index = 0, name = 'MASTER', project = self }
+
+  if not host then
+    host = { projects = {}, calls = {}, commands = {}, next_guid = 0, files = {} }
+    host.current = self
+    host.api = Stub._build_api(host)
+  end
+  host.projects[#host.projects + 1] = self
+  self.host = host
+  self.api = host.api
+  self.calls = host.calls
+  self.commands = host.commands  -- Main_OnCommand ids in call order
+  return self
+end
+
+function Stub:_guid()
+  local host = self.host
+  host.next_guid = host.next_guid + 1
+  return format('{%08X-0000-0000-0000-000000000000}', host.next_guid)
+end
+
+--- Project tab that is current (tabs opened by the code under test)
+--- @return table stub
+function Stub:current()
+  return self.host.current
+end
+
+--- Add a track
+--- @param name string|nil
+--- @return table track
+function Stub:add_track(name)
+  local track = { items = {}, envelopes = {}, index = #self.tracks + 1, name = name or '', project = self }
+  self.tracks[#self.tracks + 1] = track
+  return track
+end
+
+--- Add an envelope to a track
+--- @param track table
+--- @param points table|nil Array of {time, value}
+--- @return table envelope
+function Stub:add_envelope(track, points)
+  local env = { points = {}, track = track, name = 'VOLENV2' }
+  for i, p in ipairs(points or {}) do
+    env.points[i] = { time = p[1], value = p[2], shape = 0, tension = 0, selected = false }
+  end
+  track.envelopes[#track.envelopes + 1] = env
+  return env
+end
+
+--- Add an item with one take
+--- @param track table
+--- @param position number
+--- @param length number
+--- @param opts table|nil {payload = bytes of source data (MIDI-heavy items), name}
+--- @return table item
+function Stub:add_item(track, position, length, opts)
+  local payload = ''
+  local size = opts and opts.payload or 0
+  if size > 0 then
+    -- MIDI event lines, as REAPER writes them inside <SOURCE MIDI
+    local line = 'E 240 90 3c 60\n'
+    payload = line:rep(size // #line + 1)
+  end
+  local item = {
+    track = track,
+    position = position,
+    length = length,
+    fadein = 0,
+    fadeout = 0,
+    selected = false,
+    guid = self:_guid(),
+    takes = { { startoffs = 0, playrate = 1, name = opts and opts.name or '', payload = payload } },
+  }
+  track.items[#track.items + 1] = item
+  self.item_list = nil
+  return item
+end
+
+--- Add a region
+function Stub:add_region(number, start_pos, end_pos, name, color)
+  return self:_add_marker(true, start_pos, end_pos, name, number, color)
+end
+
+--- Add a marker
+function Stub:add_marker(number, pos, name)
+  return self:_add_marker(false, pos, pos, name, number, 0)
+end
+
+function Stub:_add_marker(isrgn, start_pos, end_pos, name, number, color)
+  if not number or number < 0 then
+    number = 1
+    for _, m in ipairs(self.markers) do
+      if m.isrgn == isrgn and m.number >= number then number = m.number + 1 end
+    end
+  end
+  local marker = { isrgn = isrgn, pos = start_pos, rgnend = end_pos, name = name or '', number = number, color = color or 0 }
+  local markers = self.markers
+  local i = #markers + 1
+  while i > 1 and markers[i - 1].pos > start_pos do i = i - 1 end
+  table.insert(markers, i, marker)
+  return number
+end
+
+--- Add a tempo marker
+function Stub:add_tempo(time, bpm, num, denom)
+  self:_insert_tempo({ time = time, bpm = bpm, num = num or 0, denom = denom or 0, linear = false })
+end
+
+-- Sorted insert; REAPER recomputes the tempo map after every change
+function Stub:_insert_tempo(marker)
+  local tempo = self.tempo
+  local i = #tempo + 1
+  while i > 1 and tempo[i - 1].time > marker.time do i = i - 1 end
+  table.insert(tempo, i, marker)
+  self:_rebuild_tempo()
+end
+
+-- Beat positions depend on every earlier marker: the rebuild walks the map
+function Stub:_rebuild_tempo()
+  local beats = 0
+  local tempo = self.tempo
+  for j, m in ipairs(tempo) do
+    m.index = j - 1
+    if j > 1 then
+      local prev = tempo[j - 1]
+      beats = beats + (m.time - prev.time) * prev.bpm / 60
+    end
+    m.beat = beats
+  end
+end
+
+function Stub:all_items()
+  if not self.item_list then
+    local list = {}
+    for _, track in ipairs(self.tracks) do
+      for _, item in ipairs(track.items) do list[#list + 1] = item end
+    end
+    self.item_list = list
+  end
+  return self.item_list
+end
+
+function Stub:regions()
+  local list = {}
+  for _, m in ipairs(self.markers) do
+    if m.isrgn then list[#list + 1] = m end
+  end
+  return list
+end
+
+--- Total API calls recorded
+--- @return number
+function Stub:call_count()
+  local n = 0
+  for _, count in pairs(self.calls) do n = n + count end
+  return n
+end
+
+--- Run fn with this stub's host as the global reaper table (unknown calls
+--- fall through to the real one)
+--- @param fn function
+--- @return any fn results
+function Stub:run(fn)
+  local previous = reaper
+  reaper = setmetatable({}, {
+    __index = function(_, k)
+      return self.api[k] or previous[k]
+    end,
+  })
+  local results = table.pack(pcall(fn))
+  reaper = previous
+  if not results[1] then error(results[2], 0) end
+  return table.unpack(results, 2, results.n)
+end
+
+-- ============================================================================
+-- ITEM STATE CHUNKS
+-- ============================================================================
+
+function Stub:_item_chunk(item)
+  local parts = {
+    '<ITEM',
+    format('POSITION %.14g', item.position),
+    format('LENGTH %.14g', item.length),
+    format('FADEIN 1 %.14g 0 1 0 0 0', item.fadein),
+    format('FADEOUT 1 %.14g 0 1 0 0 0', item.fadeout),
+    'SEL ' .. (item.selected and 1 or 0),
+    'IGUID ' .. item.guid,
+  }
+  for i, take in ipairs(item.takes) do
+    if i > 1 then parts[#parts + 1] = 'TAKE' end
+    parts[#parts + 1] = 'NAME "' .. take.name .. '"'
+    parts[#parts + 1] = format('SOFFS %.14g', take.startoffs)
+    parts[#parts + 1] = format('PLAYRATE %.14g 1 0 -1 0 0.0025', take.playrate)
+    parts[#parts + 1] = '<SOURCE MIDI\n' .. take.payload .. '>'
+  end
+  parts[#parts + 1] = '>'
+  return table.concat(parts, '\n')
+end
+
+function Stub:_apply_chunk(item, chunk)
+  local num = tonumber
+  item.position = num(chunk:match('\nPOSITION (%S+)')) or item.position
+  item.length = num(chunk:match('\nLENGTH (%S+)')) or item.length
+  item.fadein = num(chunk:match('\nFADEIN %S+ (%S+)')) or 0
+  item.fadeout = num(chunk:match('\nFADEOUT %S+ (%S+)')) or 0
+  item.selected = chunk:match('\nSEL 1') ~= nil
+  item.guid = chunk:match('\nIGUID (%S+)') or self:_guid()
+  local takes = {}
+  -- REAPER parses the whole chunk, source data included
+  for name, soffs, rate, payload in chunk:gmatch('\nNAME "(.-)"\nSOFFS (%S+)\nPLAYRATE (%S+)[^\n]*\n<SOURCE MIDI\n(.-)>') do
+    takes[#takes + 1] = { name = name, startoffs = num(soffs), playrate = num(rate), payload = payload }
+  end
+  item.takes = takes
+  return true
+end
+
+function Stub:_track_chunk(track)
+  local parts = { '<TRACK', 'NAME "' .. track.name .. '"' }
+  for _, env in ipairs(track.envelopes) do
+    parts[#parts + 1] = '<' .. env.name
+    for _, p in ipairs(env.points) do
+      parts[#parts + 1] = format('PT %.14g %.14g %d', p.time, p.value, p.shape)
+    end
+    parts[#parts + 1] = '>'
+  end
+  for _, item in ipairs(track.items) do
+    parts[#parts + 1] = self:_item_chunk(item)
+  end
+  parts[#parts + 1] = '>'
+  return table.concat(parts, '\n')
+end
+
+-- Rebuild a track from its chunk: name, envelope points and items
+function Stub:_apply_track_chunk(track, chunk)
+  track.name = chunk:match('\nNAME "(.-)"') or ''
+  track.envelopes, track.items = {}, {}
+  self.item_list = nil
+
+  local depth, block, env = 0, nil, nil
+  for line in chunk:gmatch('[^\n]+') do
+    local opens = line:sub(1, 1) == '<'
+    if block then
+      block[#block + 1] = line
+      if opens then depth = depth + 1 elseif line == '>' then depth = depth - 1 end
+      if depth == 1 then
+        local item = { track = track, takes = {} }
+        self:_apply_chunk(item, table.concat(block, '\n'))
+        track.items[#track.items + 1] = item
+        block = nil
+      end
+    elseif opens and depth == 1 and line:match('^<ITEM') then
+      block, depth = { line }, 2
+    elseif opens and depth == 1 then
+      env = { points = {}, track = track, name = line:sub(2) }
+      track.envelopes[#track.envelopes + 1] = env
+      depth = 2
+    elseif env and line:match('^PT ') then
+      local t, v, shape = line:match('^PT (%S+) (%S+) ?(%S*)')
+      env.points[#env.points + 1] = { time = tonumber(t), value = tonumber(v), shape = tonumber(shape) or 0, tension = 0 }
+    elseif opens then
+      depth = depth + 1
+    elseif line == '>' then
+      depth = depth - 1
+      env = nil
+    end
+  end
+  return true
+end
+
+-- ============================================================================
+-- API
+-- ============================================================================
+
+local ITEM_FIELDS = {
+  D_POSITION = 'position',
+  D_LENGTH = 'length',
+  D_FADEINLEN = 'fadein',
+  D_FADEOUTLEN = 'fadeout',
+  D_FADEINLEN_AUTO = 'fadein_auto',
+  D_FADEOUTLEN_AUTO = 'fadeout_auto',
+}
+
+local TAKE_FIELDS = {
+  D_STARTOFFS = 'startoffs',
+  D_PLAYRATE = 'playrate',
+}
+
+local function sort_points(env)
+  table.sort(env.points, function(a, b) return a.time < b.time end)
+end
+
+function Stub._build_api(host)
+  local api = {}
+
+  -- Project argument: a tab, or 0/nil for the current one
+  local function P(proj)
+    if type(proj) == 'table' then return proj end
+    return host.current
+  end
+
+  -- Project tabs
+  function api.EnumProjects(idx)
+    if idx < 0 then return host.current, '' end
+    return host.projects[idx + 1], ''
+  end
+  function api.SelectProjectInstance(proj) host.current = proj end
+  -- Deleted items carry .deleted; other objects stay valid while their project is open
+  function api.ValidatePtr2(_, ptr, kind)
+    if type(ptr) ~= 'table' then return false end
+    if kind == 'ReaProject*' then
+      for _, proj in ipairs(host.projects) do
+        if proj == ptr then return not ptr.closed end
+      end
+      return false
+    end
+    return not ptr.deleted
+  end
+
+  -- Tracks / items
+  function api.CountTracks(proj) return #P(proj).tracks end
+  function api.GetTrack(proj, i) return P(proj).tracks[i + 1] end
+  function api.GetMasterTrack(proj) return P(proj).master end
+  function api.InsertTrackAtIndex(idx)
+    local stub = host.current
+    local track = stub:add_track()
+    table.remove(stub.tracks)
+    table.insert(stub.tracks, idx + 1, track)
+  end
+  function api.GetTrackStateChunk(track) return true, track.project:_track_chunk(track) end
+  function api.SetTrackStateChunk(track, chunk) return track.project:_apply_track_chunk(track, chunk) end
+  function api.CountTrackMediaItems(track) return #track.items end
+  function api.GetTrackMediaItem(track, i) return track.items[i + 1] end
+  function api.CountMediaItems(proj) return #P(proj):all_items() end
+  function api.GetMediaItem(proj, i) return P(proj):all_items()[i + 1] end
+  function api.GetMediaItem_Track(item) return item.track end
+
+  function api.GetMediaItemInfo_Value(item, field)
+    if field == 'B_UISEL' then return item.selected and 1 or 0 end
+    return item[ITEM_FIELDS[field]] or 0
+  end
+
+  function api.SetMediaItemInfo_Value(item, field, value)
+    if field == 'B_UISEL' then
+      item.selected = value ~= 0
+    elseif ITEM_FIELDS[field] then
+      item[ITEM_FIELDS[field]] = value
+    end
+    return true
+  end
+
+  function api.CountTakes(item) return #item.takes end
+  function api.GetMediaItemTake(item, i)
+    local take = item.takes[i + 1]
+    if take then take.item = item end
+    return take
+  end
+  function api.GetActiveTake(item) return api.GetMediaItemTake(item, 0) end
+  function api.GetMediaItemTakeInfo_Value(take, field) return take[TAKE_FIELDS[field]] or 0 end
+  function api.SetMediaItemTakeInfo_Value(take, field, value)
+    if TAKE_FIELDS[field] then take[TAKE_FIELDS[field]] = value end
+    return true
+  end
+
+  function api.AddMediaItemToTrack(track)
+    local stub = track.project
+    local item = {
+      track = track, position = 0, length = 0, fadein = 0, fadeout = 0,
+      selected = false, guid = stub:_guid(), takes = {},
+    }
+    track.items[#track.items + 1] = item
+    stub.item_list = nil
+    return item
+  end
+
+  function api.DeleteTrackMediaItem(track, item)
+    for i, it in ipairs(track.items) do
+      if it == item then
+        item.deleted = true
+        table.remove(track.items, i)
+        track.project.item_list = nil
+        return true
+      end
+    end
+    return false
+  end
+
+  function api.GetItemStateChunk(item) return true, item.track.project:_item_chunk(item) end
+  function api.SetItemStateChunk(item, chunk) return item.track.project:_apply_chunk(item, chunk) end
+
+  function api.SplitMediaItem(item, position)
+    if position <= item.position or position >= item.position + item.length then return nil end
+    local stub = item.track.project
+    local right = api.AddMediaItemToTrack(item.track)
+    stub:_apply_chunk(right, stub:_item_chunk(item))
+    right.guid = stub:_guid()
+    local cut = position - item.position
+    right.position = position
+    right.length = item.length - cut
+    right.fadein = 0
+    for _, take in ipairs(right.takes) do
+      take.startoffs = take.startoffs + cut * take.playrate
+    end
+    item.length = cut
+    item.fadeout = 0
+    return right
+  end
+
+  function api.SelectAllMediaItems(proj, selected)
+    for _, item in ipairs(P(proj):all_items()) do item.selected = selected end
+  end
+  function api.SetMediaItemSelected(item, selected) item.selected = selected end
+  function api.CountSelectedMediaItems(proj)
+    local n = 0
+    for _, item in ipairs(P(proj):all_items()) do
+      if item.selected then n = n + 1 end
+    end
+    return n
+  end
+
+  -- Nudge selected items by value seconds
+  function api.ApplyNudge(proj, _, _, _, value, reverse)
+    for _, item in ipairs(P(proj):all_items()) do
+      if item.selected then
+        item.position = item.position + (reverse and -value or value)
+      end
+    end
+    return true
+  end
+
+  -- Tempo map
+  function api.CountTempoTimeSigMarkers(proj) return #P(proj).tempo end
+  function api.GetTempoTimeSigMarker(proj, i)
+    local m = P(proj).tempo[i + 1]
+    if not m then return false, -1, 0, 0, 0, 0, 0, false end
+    return true, m.time, 0, 0, m.bpm, m.num, m.denom, m.linear
+  end
+  function api.SetTempoTimeSigMarker(proj, idx, time, _, _, bpm, num, denom, linear)
+    local stub = P(proj)
+    if idx >= 0 and stub.tempo[idx + 1] then
+      table.remove(stub.tempo, idx + 1)
+    end
+    stub:_insert_tempo({ time = time, bpm = bpm, num = num, denom = denom, linear = linear })
+    return true
+  end
+  function api.DeleteTempoTimeSigMarker(proj, i)
+    local stub = P(proj)
+    local removed = table.remove(stub.tempo, i + 1) ~= nil
+    stub:_rebuild_tempo()
+    return removed
+  end
+
+  -- Envelopes (autoitem_idx is ignored: only the underlying envelope exists)
+  function api.CountTrackEnvelopes(track) return #track.envelopes end
+  function api.GetTrackEnvelope(track, i) return track.envelopes[i + 1] end
+  function api.GetEnvelopeName(env) return true, env.name end
+  function api.GetEnvelopeStateChunk(env)
+    if env.tempo_of then
+      local parts = { '<TEMPOENVEX', 'ACT 0 -1' }
+      for _, m in ipairs(env.tempo_of.tempo) do
+        local timesig = m.num > 0 and format(' %d', m.num + (m.denom << 16)) or ''
+        parts[#parts + 1] = format('PT %.14g %.14g %d%s', m.time, m.bpm, m.linear and 0 or 1, timesig)
+      end
+      parts[#parts + 1] = '>'
+      return true, table.concat(parts, '\n')
+    end
+    local parts = { '<' .. env.name }
+    for _, p in ipairs(env.points) do
+      parts[#parts + 1] = format('PT %.14g %.14g %d', p.time, p.value, p.shape)
+    end
+    parts[#parts + 1] = '>'
+    return true, table.concat(parts, '\n')
+  end
+
+  -- The master tempo envelope mirrors the tempo map; like REAPER's it only
+  -- exists once the project has a tempo marker
+  function api.GetTrackEnvelopeByName(track, name)
+    local stub = track.project
+    if name == 'Tempo map' and track == stub.master then
+      if #stub.tempo == 0 then return nil end
+      stub.tempo_envelope = stub.tempo_envelope or { name = 'Tempo map', tempo_of = stub }
+      return stub.tempo_envelope
+    end
+    for _, env in ipairs(track.envelopes) do
+      if env.name == name then return env end
+    end
+    return nil
+  end
+  function api.SetEnvelopeStateChunk(env, chunk)
+    if not env.tempo_of then return false end
+    local tempo = {}
+    for time, bpm, shape, timesig in chunk:gmatch('\n%s*PT (%S+) (%S+) (%d+) ?(%d*)') do
+      timesig = tonumber(timesig) or 0
+      tempo[#tempo + 1] = {
+        time = tonumber(time), bpm = tonumber(bpm), linear = shape == '0',
+        num = timesig & 0xFFFF, denom = timesig >> 16,
+      }
+    end
+    for i, m in ipairs(tempo) do m.order = i end
+    table.sort(tempo, function(a, b)
+      if a.time ~= b.time then return a.time < b.time end
+      return a.order < b.order
+    end)
+    env.tempo_of.tempo = tempo
+    env.tempo_of:_rebuild_tempo()
+    return true
+  end
+  function api.CountTakeEnvelopes() return 0 end
+  function api.CountEnvelopePoints(env) return #env.points end
+  function api.CountEnvelopePointsEx(env) return #env.points end
+  function api.GetEnvelopePoint(env, i)
+    local p = env.points[i + 1]
+    if not p then return false, 0, 0, 0, 0, false end
+    return true, p.time, p.value, p.shape, p.tension, p.selected
+  end
+  function api.GetEnvelopePointEx(env, _, i) return api.GetEnvelopePoint(env, i) end
+  function api.InsertEnvelopePoint(env, time, value, shape, tension, selected, no_sort)
+    env.points[#env.points + 1] = { time = time, value = value, shape = shape, tension = tension, selected = selected }
+    if not no_sort then sort_points(env) end
+    return true
+  end
+  function api.InsertEnvelopePointEx(env, _, ...) return api.InsertEnvelopePoint(env, ...) end
+  function api.DeleteEnvelopePointEx(env, _, i)
+    return table.remove(env.points, i + 1) ~= nil
+  end
+  function api.DeleteEnvelopePointRange(env, t0, t1)
+    local kept = {}
+    for _, p in ipairs(env.points) do
+      if p.time < t0 or p.time >= t1 then kept[#kept + 1] = p end
+    end
+    env.points = kept
+    return true
+  end
+  function api.Envelope_SortPoints(env)
+    sort_points(env)
+    return true
+  end
+
+  -- Index of the last point at or before time (-1 if none)
+  function api.GetEnvelopePointByTime(env, time)
+    local lo, hi = 1, #env.points
+    local found = 0
+    while lo <= hi do
+      local mid = (lo + hi) // 2
+      if env.points[mid].time <= time then found = mid; lo = mid + 1 else hi = mid - 1 end
+    end
+    return found - 1
+  end
+  function api.GetEnvelopePointByTimeEx(env, _, time) return api.GetEnvelopePointByTime(env, time) end
+
+  -- Linear interpolation between points (shapes are not modelled)
+  function api.Envelope_Evaluate(env, time)
+    local points = env.points
+    if #points == 0 then return 0, 0 end
+    local i = api.GetEnvelopePointByTime(env, time) + 1
+    if i < 1 then return 0, points[1].value end
+    local a, b = points[i], points[i + 1]
+    if not b or a.shape == 1 or b.time == a.time then return 0, a.value end
+    return 0, a.value + (b.value - a.value) * (time - a.time) / (b.time - a.time)
+  end
+
+  -- Markers / regions
+  function api.CountProjectMarkers(proj)
+    local markers, regions = 0, 0
+    for _, m in ipairs(P(proj).markers) do
+      if m.isrgn then regions = regions + 1 else markers = markers + 1 end
+    end
+    return markers + regions, markers, regions
+  end
+  function api.EnumProjectMarkers3(proj, i)
+    local m = P(proj).markers[i + 1]
+    if not m then return 0 end
+    return i + 1, m.isrgn, m.pos, m.rgnend, m.name, m.number, m.color
+  end
+  function api.AddProjectMarker2(proj, isrgn, pos, rgnend, name, wantidx, color)
+    return P(proj):_add_marker(isrgn, pos, rgnend, name, wantidx, color)
+  end
+  function api.DeleteProjectMarker(proj, number, isrgn)
+    local markers = P(proj).markers
+    for i, m in ipairs(markers) do
+      if m.number == number and m.isrgn == isrgn then
+        table.remove(markers, i)
+        return true
+      end
+    end
+    return false
+  end
+  function api.GetSetProjectInfo() return 0 end
+  function api.GetSetProjectInfo_String() return false, '' end
+  function api.EnumerateFiles(dir, index)  -- host.files[dir] = { names }
+    return (host.files[dir] or {})[index + 1]
+  end
+  function api.GetProjectTimeSignature2() return 120, 4 end
+  function api.GetAppVersion() return '7.0/stub' end
+  function api.ColorFromNative(c) return c & 0xFF, (c >> 8) & 0xFF, (c >> 16) & 0xFF end
+
+  -- Transport / misc
+  function api.GetCursorPosition() return host.current.cursor end
+  function api.GetCursorPositionEx(proj) return P(proj).cursor end
+  function api.SetEditCurPos(pos) host.current.cursor = pos end
+  function api.SetEditCurPos2(proj, pos) P(proj).cursor = pos end
+  function api.GetPlayStateEx(proj) return P(proj).play_state end
+  function api.GetPlayPositionEx(proj) return P(proj).play_position end
+  function api.OnPlayButton() host.current.play_state = 1 end
+  function api.OnStopButton() host.current.play_state = 0 end
+  function api.OnPauseButton() host.current.play_state = 2 end
+  function api.GoToRegion(proj, number)
+    for _, m in ipairs(P(proj).markers) do
+      if m.isrgn and m.number == number then
+        P(proj).play_position = m.pos
+        return
+      end
+    end
+  end
+  function api.GetProjectStateChangeCount(proj) return P(proj).state_change_count end
+  function api.GetSet_LoopTimeRange(is_set, _, s, e)
+    return api.GetSet_LoopTimeRange2(0, is_set, _, s, e)
+  end
+  function api.GetSet_LoopTimeRange2(proj, is_set, _, s, e)
+    local stub = P(proj)
+    if is_set then stub.loop_range = { s, e } end
+    return stub.loop_range[1], stub.loop_range[2]
+  end
+  function api.Main_OnCommand(cmd)
+    host.commands[#host.commands + 1] = cmd
+    if cmd == 41929 then  -- New project tab (ignore default template)
+      host.current = M.new(host)
+    elseif cmd == 41823 then  -- Add project to render queue
+      local dir = reaper.GetResourcePath() .. '/QueuedRenders'
+      local queued = host.files[dir] or {}
+      queued[#queued + 1] = format('qrender_%d.rpp', #queued + 1)
+      host.files[dir] = queued
+    elseif cmd == 41207 then  -- Render all queued renders
+      host.files[reaper.GetResourcePath() .. '/QueuedRenders'] = nil
+    end
+  end
+  function api.Main_OnCommandEx(cmd) api.Main_OnCommand(cmd) end
+  function api.PreventUIRefresh() end
+  function api.Undo_BeginBlock() end
+  function api.Undo_EndBlock() end
+  function api.Undo_BeginBlock2() end
+  function api.Undo_EndBlock2() end
+  function api.Undo_OnStateChange2() end
+  function api.Undo_OnStateChangeEx2(_, _, flags)
+    host.undo_flags = flags
+  end
+  function api.time_precise() return os.clock() end
+  function api.UpdateArrange() end
+  function api.UpdateTimeline() end
+  function api.TrackList_AdjustWindows() end
+
+  -- Count every call
+  local counted = {}
+  for name, fn in pairs(api) do
+    counted[name] = function(...)
+      host.calls[name] = (host.calls[name] or 0) + 1
+      return fn(...)
+    end
+  end
+  return counted
+end
+
+return M
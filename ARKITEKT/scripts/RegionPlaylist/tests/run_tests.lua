@@ -19,6 +19,14 @@ function M.run_all()
   results.playlist = TestRunner.run('RegionPlaylist.domain.playlist')
   results.ui_preferences = TestRunner.run('RegionPlaylist.ui.state.preferences')
   results.dependency = TestRunner.run('RegionPlaylist.domain.dependency')
+  results.playlist_audit = TestRunner.run('RegionPlaylist.domain.playlist_audit')
+  results.render_job = TestRunner.run('RegionPlaylist.domain.render_job')
+  results.playback_trace = TestRunner.run('RegionPlaylist.domain.playback_trace')
+  results.region_operations = TestRunner.run('RegionPlaylist.region_operations')
+  results.playlist_codec = TestRunner.run('RegionPlaylist.data.playlist_codec')
+  results.playlist_library = TestRunner.run('RegionPlaylist.data.playlist_library')
+  results.undo = TestRunner.run('RegionPlaylist.data.undo')
+  results.rpp_scan = TestRunner.run('RegionPlaylist.data.rpp_scan')
 
   -- Calculate totals
   local total = 0
@@ -0,0 +1,106 @@
+-- @noindex
+-- RegionPlaylist/tools/monitor_reader.lua
+-- Reference reader for the monitor feed (runs with plain Lua, outside REAPER)
+--
+-- USAGE:
+--   lua monitor_reader.lua <path/to/monitor.txt> [interval_ms] [--once]
+--
+-- The feed file is written by data/monitor_feed.lua. A record is valid only
+-- when its 'seq=N' header matches its 'end=N' footer; otherwise the reader
+-- retries (the writer replaced the file mid-read). Unchanged seq values are
+-- skipped, so the display only redraws when the engine published new data.
+
+-- Resolve module paths relative to this file (scripts/ and the ARKITEKT root)
+local script_path = (arg and arg[0] or ''):gsub('\\', '/')
+local tools_dir = script_path:match('^(.*)/[^/]*$') or '.'
+local scripts_dir = tools_dir .. '/../..'
+package.path = scripts_dir .. '/?.lua;' .. scripts_dir .. '/../?.lua;' .. package.path
+
+local MonitorFeed = require('RegionPlaylist.data.monitor_feed')
+
+local path = arg and arg[1]
+local interval_ms = tonumber(arg and arg[2]) or 50
+local once = false
+for i = 1, arg and #arg or 0 do
+  if arg[i] == '--once' then once = true end
+end
+
+if not path then
+  io.stderr:write('usage: lua monitor_reader.lua <monitor.txt> [interval_ms] [--once]\n')
+  os.exit(1)
+end
+
+local MAX_RETRIES = 3
+
+local function read_record()
+  for _ = 1, MAX_RETRIES do
+    local f = io.open(path, 'rb')
+    if f then
+      local payload = f:read('a')
+      f:close()
+      local rec, seq = MonitorFeed.parse(payload)
+      if rec then return rec, seq end
+    end
+  end
+  return nil
+end
+
+local function format_time(seconds)
+  seconds = tonumber(seconds) or 0
+  local m = math.floor(seconds / 60)
+  return string.format('%d:%06.3f', m, seconds - m * 60)
+end
+
+local function render(rec)
+  local loop_text = ''
+  if (tonumber(rec.loops) or 1) > 1 then
+    loop_text = string.format('  [loop %s/%s]', rec.loop, rec.loops)
+  end
+  local sync = rec.playlist_mode == '1' and 'SYNC' or 'FREE'
+  return string.format('%-7s %-4s %s/%s  NOW: %s%s  (%s / -%s)  NEXT: %s',
+    rec.state:upper(), sync, rec.index, rec.count,
+    rec.current_name ~= '' and rec.current_name or '-', loop_text,
+    format_time(rec.elapsed), format_time(rec.remaining),
+    rec.next_name ~= '' and rec.next_name or '-')
+end
+
+-- Stock Lua has no sleep: one long-running shell child prints a line every
+-- interval and the loop blocks reading it, so the reader idles between polls
+-- and only one process is started (PowerShell alone takes hundreds of ms to
+-- start, far longer than the poll interval). Ctrl+C ends the child; the read
+-- then returns nil and the loop stops.
+local IS_WINDOWS = package.config:sub(1, 1) == '\\'
+local function start_ticker(ms)
+  local command
+  if IS_WINDOWS then
+    command = string.format(
+      'powershell -NoProfile -Command "while ($true) { Start-Sleep -Milliseconds %d; [Console]::WriteLine() }"', ms)
+  else
+    command = string.format('while sleep %.3f; do echo; done', ms / 1000)
+  end
+  return io.popen(command, 'r')
+end
+
+local ticker = nil
+if not once then
+  local err
+  ticker, err = start_ticker(interval_ms)
+  if not ticker then
+    io.stderr:write('monitor_reader: cannot start timer: ', tostring(err), '\n')
+    os.exit(1)
+  end
+end
+
+local last_seq = nil
+repeat
+  local rec, seq = read_record()
+  if rec and seq ~= last_seq then
+    io.write('\r', render(rec), '\27[K')
+    io.flush()
+    last_seq = seq
+  end
+until once or not ticker:read('l')
+
+if ticker then ticker:close() end
+
+io.write('\n')
@@ -0,0 +1,150 @@
+-- @noindex
+-- RegionPlaylist/tools/rpp_analyzer.lua
+-- Headless SWS region playlist audit of .RPP files (runs with plain Lua 5.4, outside REAPER)
+--
+-- USAGE:
+--   lua rpp_analyzer.lua [--jobs N] [--min-length SECONDS] [--pretty] <project.rpp>...
+--
+-- Prints a JSON array with one entry per file, in argument order:
+--   { file, error?, regions, markers, playlists = [ { name, active, items,
+--     length, infinite, malformed_lines, findings = { missing, nested, short,
+--     unsafe_markers } } ] }
+-- See domain/playlist_audit.lua for the semantics (SWS GetLength/IsInfinite
+-- and the PlaylistPlay preflight checks).
+--
+-- PARALLELISM:
+-- Stock Lua has no threads, so --jobs N splits the file list across N worker
+-- processes (this script re-run with --worker); each prints one JSON line per
+-- file and the parent merges them. Default: one job per file up to 4.
+
+-- Resolve module paths relative to this file (scripts/ and the ARKITEKT root)
+local script_path = (arg and arg[0] or ''):gsub('\\', '/')
+local tools_dir = script_path:match('^(.*)/[^/]*$') or '.'
+local scripts_dir = tools_dir .. '/../..'
+package.path = scripts_dir .. '/?.lua;' .. scripts_dir .. '/../?.lua;' .. package.path
+
+local JSON = require('arkitekt.core.json')
+local RppScan = require('RegionPlaylist.data.rpp_scan')
+local PlaylistAudit = require('RegionPlaylist.domain.playlist_audit')
+
+local DEFAULT_MAX_JOBS = 4
+
+local function usage()
+  io.stderr:write('usage: lua rpp_analyzer.lua [--jobs N] [--min-length SECONDS] [--pretty] <project.rpp>...\n')
+  os.exit(1)
+end
+
+local files, jobs, min_length, pretty, worker = {}, nil, nil, false, false
+local i = 1
+while arg and i <= #arg do
+  local a = arg[i]
+  if a == '--jobs' then
+    i = i + 1
+    jobs = tonumber(arg[i]) or usage()
+  elseif a == '--min-length' then
+    i = i + 1
+    min_length = tonumber(arg[i]) or usage()
+  elseif a == '--pretty' then
+    pretty = true
+  elseif a == '--worker' then
+    worker = true
+  elseif a:sub(1, 2) == '--' then
+    usage()
+  else
+    files[#files + 1] = a
+  end
+  i = i + 1
+end
+
+if #files == 0 then usage() end
+
+local function analyze_file(path)
+  local f, err = io.open(path, 'rb')
+  if not f then
+    return { file = path, error = err }
+  end
+  local text = f:read('a')
+  f:close()
+
+  local regions, markers = RppScan.parse_markers(text)
+  local project = PlaylistAudit.build_project(regions, markers)
+  local playlists = {}
+  for n, pl in ipairs(RppScan.parse_sws_playlists(text)) do
+    playlists[n] = PlaylistAudit.analyze_playlist(pl, project, { min_length = min_length })
+  end
+  return { file = path, regions = #regions, markers = #markers, playlists = playlists }
+end
+
+local IS_WINDOWS = package.config:sub(1, 1) == '\\'
+
+-- Shell-quote an argument for io.popen
+local function quote(s)
+  if IS_WINDOWS then
+    return '"' .. s:gsub('"', '\\"') .. '"'
+  end
+  return "'" .. s:gsub("'", "'\\''") .. "'"
+end
+
+-- io.popen runs 'cmd.exe /c <command>' on Windows, which strips the first
+-- and last quote of a command that starts with one (the quoted interpreter
+-- path); one extra outer pair keeps the argument quotes intact
+local function shell_command(args)
+  local command = table.concat(args, ' ')
+  if IS_WINDOWS then
+    return '"' .. command .. '"'
+  end
+  return command
+end
+
+local results = {}
+
+if worker then
+  for _, path in ipairs(files) do
+    local ok, result = pcall(analyze_file, path)
+    if not ok then result = { file = path, error = tostring(result) } end
+    io.write(JSON.encode(result), '\n')
+  end
+  os.exit(0)
+end
+
+jobs = math.max(1, math.min(jobs or DEFAULT_MAX_JOBS, #files))
+
+if jobs == 1 then
+  for n, path in ipairs(files) do
+    local ok, result = pcall(analyze_file, path)
+    results[n] = ok and result or { file = path, error = tostring(result) }
+  end
+else
+  -- Round-robin split; all workers are started before any output is read
+  local interpreter = arg[-1] or 'lua'
+  local pipes, order = {}, {}
+  for j = 1, jobs do
+    local cmd = { quote(interpreter), quote(script_path), '--worker' }
+    if min_length then cmd[#cmd + 1] = '--min-length ' .. min_length end
+    order[j] = {}
+    for n = j, #files, jobs do
+      cmd[#cmd + 1] = quote(files[n])
+      order[j][#order[j] + 1] = n
+    end
+    pipes[j] = io.popen(shell_command(cmd), 'r')
+  end
+
+  for j = 1, jobs do
+    local k = 0
+    for line in pipes[j]:lines() do
+      k = k + 1
+      local n = order[j][k]
+      if n then
+        local ok, result = pcall(JSON.decode, line)
+        results[n] = ok and result or { file = files[n], error = 'Worker output unreadable' }
+      end
+    end
+    pipes[j]:close()
+    for m = k + 1, #order[j] do
+      local n = order[j][m]
+      results[n] = { file = files[n], error = 'Worker failed' }
+    end
+  end
+end
+
+io.write(JSON.encode(results, { pretty = pretty }), '\n')
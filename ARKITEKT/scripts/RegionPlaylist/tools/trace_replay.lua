@@ -0,0 +1,58 @@
+-- @noindex
+-- RegionPlaylist/tools/trace_replay.lua
+-- Replay a recorded playback trace through the engine (runs with plain Lua 5.4, outside REAPER)
+--
+-- USAGE:
+--   lua trace_replay.lua [--no-resync] [--pretty] <trace.bin>
+--
+-- The trace is written by domain/playback/recorder.lua when trace recording
+-- is enabled. Prints a JSON report:
+--   { file, steps, frames, commands, unsupported, skipped, seeks,
+--     diffs = [ { seq, time, step, kind, field, recorded, replayed } ] }
+-- Exit status is 0 when the replayed decisions match the recorded ones, 1
+-- when they differ, 2 when the file cannot be read. --no-resync keeps the
+-- replayed engine on its own course after a difference (every follow-on
+-- difference is reported too).
+
+-- Resolve module paths relative to this file (scripts/ and the ARKITEKT root)
+local script_path = (arg and arg[0] or ''):gsub('\\', '/')
+local tools_dir = script_path:match('^(.*)/[^/]*$') or '.'
+local scripts_dir = tools_dir .. '/../..'
+package.path = scripts_dir .. '/?.lua;' .. scripts_dir .. '/../?.lua;' .. package.path
+
+local JSON = require('arkitekt.core.json')
+local TraceFile = require('RegionPlaylist.data.trace_file')
+local Replay = require('RegionPlaylist.domain.playback.replay')
+
+local function usage()
+  io.stderr:write('usage: lua trace_replay.lua [--no-resync] [--pretty] <trace.bin>\n')
+  os.exit(2)
+end
+
+local path, resync, pretty = nil, true, false
+for i = 1, arg and #arg or 0 do
+  local a = arg[i]
+  if a == '--no-resync' then
+    resync = false
+  elseif a == '--pretty' then
+    pretty = true
+  elseif a:sub(1, 2) == '--' or path then
+    usage()
+  else
+    path = a
+  end
+end
+
+if not path then usage() end
+
+local records, err = TraceFile.read(path)
+if not records then
+  io.stderr:write(tostring(err), '\n')
+  os.exit(2)
+end
+
+local report = Replay.run(Replay.decode(records), { resync = resync })
+
+report.file = path
+io.write(JSON.encode(report, { pretty = pretty }), '\n')
+os.exit(#report.diffs == 0 and 0 or 1)
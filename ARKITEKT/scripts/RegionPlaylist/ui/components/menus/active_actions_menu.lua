@@ -6,13 +6,20 @@ local ImGui = require('arkitekt.core.imgui')
 local ContextMenu = require('arkitekt.gui.widgets.overlays.context_menu')
 local ModalDialog = require('arkitekt.gui.widgets.overlays.overlay.modal_dialog')
 local SWSImporter = require('RegionPlaylist.data.sws_import')
+local PlaylistLibrary = require('RegionPlaylist.data.playlist_library')
 local State = require('RegionPlaylist.app.state')
+local Trace = require('arkitekt.debug.trace')
 
 local M = {}
 
 -- Modal state
 local sws_result_data = nil
 
+-- Planned append/paste/crop: {plan, proj, title, summary, job}. job is nil
+-- while the plan waits for confirmation, then stepped once per frame
+local region_job = nil
+local REGION_JOB_BUDGET = 0.02  -- Seconds of work per frame
+
 -- Helper: Extract region items from a playlist for operations
 local function extract_playlist_region_items(playlist)
   local items = {}
@@ -29,18 +36,36 @@ local function extract_playlist_region_items(playlist)
   return items
 end
 
--- Helper: Refresh UI after successful import and select first imported playlist
-local function refresh_after_import(coordinator)
-  State.reload_project_data()
-
-  -- Select first imported playlist (prepended at index 1)
-  local playlists = State.get_playlists()
-  if playlists and #playlists > 0 then
-    State.set_active_playlist(playlists[1].id)
+-- Helper: Save a copy of a playlist into another project (crop to new tab).
+-- Region numbers are preserved there; the project monitor loads it on switch.
+local function save_playlist_copy(proj, playlist, playlist_items)
+  local Storage = require('RegionPlaylist.data.storage')
+  local UUID = require('arkitekt.core.uuid')
+  local copy = {
+    id = UUID.generate(),
+    name = playlist.name or 'Cropped Playlist',
+    chip_color = playlist.chip_color,
+    items = {},
+  }
+  for _, item in ipairs(playlist_items) do
+    copy.items[#copy.items + 1] = {
+      type = 'region',
+      rid = item.rid,
+      reps = item.reps,
+      enabled = true,
+      key = UUID.generate(),
+    }
   end
+  Storage.save_playlists({ copy }, proj)
+  Storage.save_active_playlist(copy.id, proj)
+end
 
-  -- Update tabs UI
-  coordinator.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
+-- Helper: Refresh UI after successful import and select first imported playlist
+-- Adopts the saved list directly (no read-back) as one load: one resync, and
+-- the tabs rebuild once through the change set.
+local function refresh_after_import(playlists)
+  -- First imported playlist is at index 1 (imports are prepended)
+  State.reload_project_data(playlists, playlists and playlists[1] and playlists[1].id)
 end
 
 -- Helper: Execute SWS import and handle results
@@ -56,14 +81,15 @@ local function execute_sws_import(coordinator, ctx)
   end
 
   -- Execute import
-  local success, report, err = SWSImporter.execute_import(true, true)
+  local compact = coordinator.controller and coordinator.controller.auto_compact
+  local success, report, err, playlists = SWSImporter.execute_import(true, true, compact)
 
   if success and report then
     sws_result_data = {
       title = 'Import Successful',
       message = 'Import successful!\n\n' .. SWSImporter.format_report(report)
     }
-    refresh_after_import(coordinator)
+    refresh_after_import(playlists)
   else
     sws_result_data = {
       title = 'Import Failed',
@@ -72,6 +98,197 @@ local function execute_sws_import(coordinator, ctx)
   end
 end
 
+-- Helper: Default library path (next to the project, else resource path)
+local function default_library_path()
+  local dir = reaper.GetProjectPath('')
+  if not dir or dir == '' then
+    dir = reaper.GetResourcePath()
+  end
+  return dir .. '/RegionPlaylists.' .. PlaylistLibrary.EXTENSION
+end
+
+-- Helper: Export playlists to a library file
+local function execute_library_export(playlists)
+  local path = default_library_path()
+  if reaper.JS_Dialog_BrowseForSaveFile then
+    local rv, chosen = reaper.JS_Dialog_BrowseForSaveFile('Export Playlist Library', '',
+      path, 'Playlist library (*.' .. PlaylistLibrary.EXTENSION .. ')\0*.' .. PlaylistLibrary.EXTENSION .. '\0')
+    if rv ~= 1 or not chosen or chosen == '' then return end
+    path = chosen
+  end
+
+  local ok, err = PlaylistLibrary.write(path, playlists, State.get_region_index())
+  sws_result_data = ok and {
+    title = 'Export Successful',
+    message = string.format('Exported %d playlist(s) to:\n%s', #playlists, path),
+  } or {
+    title = 'Export Failed',
+    message = 'Export failed: ' .. tostring(err),
+  }
+end
+
+-- Helper: Write the active playlist's flattened timeline to a new .RPP
+-- (the open project is only read)
+local function execute_flatten_export(playlist)
+  local playlist_items = extract_playlist_region_items(playlist)
+  if #playlist_items == 0 then return end
+
+  local dir = reaper.GetProjectPath('')
+  if not dir or dir == '' then
+    dir = reaper.GetResourcePath()
+  end
+  local file = (playlist.name or 'Playlist'):gsub('[\\/:*?"<>|]', '_') .. ' (flattened).RPP'
+  local path = dir .. '/' .. file
+  if reaper.JS_Dialog_BrowseForSaveFile then
+    local rv, chosen = reaper.JS_Dialog_BrowseForSaveFile('Export Flattened Project', dir, file,
+      'REAPER project (*.RPP)\0*.RPP\0')
+    if rv ~= 1 or not chosen or chosen == '' then return end
+    path = chosen
+  end
+
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local ok, result = RegionOps.write_playlist_rpp(playlist_items, path)
+  sws_result_data = ok and {
+    title = 'Export Successful',
+    message = string.format('Wrote %d region(s), %d item(s) to:\n%s', result.regions, result.items, path),
+  } or {
+    title = 'Export Failed',
+    message = 'Export failed: ' .. tostring(result),
+  }
+end
+
+-- Helper: Render the playlist's resolved sequence (nested playlists and
+-- loops included) into one WAV; the project is left as it was
+local function execute_playlist_render(playlist)
+  local RenderQueue = require('arkitekt.reaper.render_queue')
+  if not RenderQueue.renders_wav(0) then
+    sws_result_data = {
+      title = 'Render Failed',
+      message = 'Set the project render format to WAV: the playlist is rendered range by range and joined.',
+    }
+    return
+  end
+
+  local SequenceExpander = require('RegionPlaylist.domain.playback.expander')
+  local RenderJob = require('RegionPlaylist.domain.render_job')
+  local sequence = SequenceExpander.expand_playlist(playlist, State.get_playlist_by_id)
+  local job = RenderJob.build(sequence, State.get_region_by_rid)
+  if #job.ranges == 0 then return end
+
+  local dir = reaper.GetProjectPath('')
+  if not dir or dir == '' then
+    dir = reaper.GetResourcePath()
+  end
+  local file = (playlist.name or 'Playlist'):gsub('[\\/:*?"<>|]', '_') .. '.wav'
+  local path = dir .. '/' .. file
+  if reaper.JS_Dialog_BrowseForSaveFile then
+    local rv, chosen = reaper.JS_Dialog_BrowseForSaveFile('Render Playlist', dir, file, 'WAV file (*.wav)\0*.wav\0')
+    if rv ~= 1 or not chosen or chosen == '' then return end
+    path = chosen
+  end
+
+  local WavJoin = require('RegionPlaylist.data.wav_join')
+  local ok, result = RenderJob.run(job, RenderQueue.new(0), path, WavJoin.join)
+  sws_result_data = ok and {
+    title = 'Render Successful',
+    message = string.format('Rendered %d range(s), %.1f s to:\n%s', result.ranges, result.length, path),
+  } or {
+    title = 'Render Failed',
+    message = 'Render failed: ' .. tostring(result),
+  }
+end
+
+-- Helper: Save the recorded trace events as Chrome trace JSON
+-- (only offered while tracing is on, see Features.TRACE_ENABLED)
+local function execute_trace_dump()
+  local dir = reaper.GetProjectPath('')
+  if not dir or dir == '' then
+    dir = reaper.GetResourcePath()
+  end
+  local file = 'RegionPlaylist trace.json'
+  local path = dir .. '/' .. file
+  if reaper.JS_Dialog_BrowseForSaveFile then
+    local rv, chosen = reaper.JS_Dialog_BrowseForSaveFile('Save Trace', dir, file, 'Chrome trace (*.json)\0*.json\0')
+    if rv ~= 1 or not chosen or chosen == '' then return end
+    path = chosen
+  end
+
+  local ok, err = Trace.dump(path)
+  sws_result_data = ok and {
+    title = 'Trace Saved',
+    message = 'Open in chrome://tracing or ui.perfetto.dev:\n' .. path,
+  } or {
+    title = 'Trace Failed',
+    message = 'Could not write trace: ' .. tostring(err),
+  }
+end
+
+-- Helper: Plan an append/paste/crop of the active playlist for preview
+-- (render() shows the plan; once confirmed the work runs in per-frame
+-- steps with a progress dialog, on the project it was planned on)
+local function start_region_job(mode)
+  if region_job then return end
+  local playlist_items = extract_playlist_region_items(State.get_active_playlist())
+  if #playlist_items == 0 then return end
+
+  local RegionOps = require('arkitekt.reaper.region_operations')
+  local proj = reaper.EnumProjects(-1)
+  local plan = RegionOps.plan_playlist(mode, playlist_items, proj)
+  if #plan.copies == 0 then return end
+  region_job = {
+    plan = plan,
+    proj = proj,
+    title = plan.label,
+    summary = RegionOps.describe_plan(plan),
+  }
+end
+
+-- Helper: Import all playlists from a library file (one undo step)
+local function execute_library_import(coordinator)
+  local rv, path = reaper.GetUserFileNameForRead(default_library_path(), 'Import Playlist Library',
+    PlaylistLibrary.EXTENSION)
+  if not rv then return end
+
+  local library, err = PlaylistLibrary.open(path)
+  if not library then
+    sws_result_data = { title = 'Import Failed', message = 'Import failed: ' .. tostring(err) }
+    return
+  end
+
+  local entries = {}
+  for i = 1, library:count() do
+    local entry, entry_err = library:get(i)
+    if not entry then
+      library:close()
+      sws_result_data = { title = 'Import Failed', message = 'Import failed: ' .. tostring(entry_err) }
+      return
+    end
+    entries[i] = entry
+  end
+  library:close()
+
+  local existing_ids = {}
+  for _, pl in ipairs(State.get_playlists()) do
+    existing_ids[pl.id] = true
+  end
+
+  local UUID = require('arkitekt.core.uuid')
+  local playlists, report = PlaylistLibrary.prepare_import(entries, State.get_regions(), {
+    new_id = UUID.generate,
+    new_key = UUID.generate,
+    existing_ids = existing_ids,
+  })
+
+  local ok, result = coordinator.controller:import_playlists(playlists)
+  sws_result_data = ok and {
+    title = 'Import Successful',
+    message = PlaylistLibrary.format_report(report),
+  } or {
+    title = 'Import Failed',
+    message = 'Import failed: ' .. tostring(result),
+  }
+end
+
 -- =============================================================================
 -- PUBLIC API
 -- =============================================================================
@@ -94,12 +311,7 @@ function M.render(ctx, coordinator, shell_state)
   -- Render popup
   if ContextMenu.begin(ctx, 'ActionsMenu') then
     if ContextMenu.item(ctx, 'Crop Project to Playlist') then
-      local playlist = State.get_active_playlist()
-      local playlist_items = extract_playlist_region_items(playlist)
-      if #playlist_items > 0 then
-        local RegionOps = require('arkitekt.reaper.region_operations')
-        RegionOps.crop_to_playlist(playlist_items)
-      end
+      start_region_job('crop')
       ImGui.CloseCurrentPopup(ctx)
     end
 
@@ -108,27 +320,36 @@ function M.render(ctx, coordinator, shell_state)
       local playlist_items = extract_playlist_region_items(playlist)
       if #playlist_items > 0 then
         local RegionOps = require('arkitekt.reaper.region_operations')
-        RegionOps.crop_to_playlist_new_tab(playlist_items, playlist.name, playlist.chip_color)
+        local new_proj = RegionOps.crop_to_playlist_new_tab(playlist_items)
+        if new_proj then
+          save_playlist_copy(new_proj, playlist, playlist_items)
+        end
       end
       ImGui.CloseCurrentPopup(ctx)
     end
 
     if ContextMenu.item(ctx, 'Append Playlist to Project') then
+      start_region_job('append')
+      ImGui.CloseCurrentPopup(ctx)
+    end
+
+    if ContextMenu.item(ctx, 'Paste Playlist at Edit Cursor') then
+      start_region_job('paste')
+      ImGui.CloseCurrentPopup(ctx)
+    end
+
+    if ContextMenu.item(ctx, 'Render Playlist (.wav)') then
       local playlist = State.get_active_playlist()
-      local playlist_items = extract_playlist_region_items(playlist)
-      if #playlist_items > 0 then
-        local RegionOps = require('arkitekt.reaper.region_operations')
-        RegionOps.append_playlist_to_project(playlist_items)
+      if playlist then
+        execute_playlist_render(playlist)
       end
       ImGui.CloseCurrentPopup(ctx)
     end
 
-    if ContextMenu.item(ctx, 'Paste Playlist at Edit Cursor') then
+    if ContextMenu.item(ctx, 'Export Flattened Project (.RPP)') then
       local playlist = State.get_active_playlist()
-      local playlist_items = extract_playlist_region_items(playlist)
-      if #playlist_items > 0 then
-        local RegionOps = require('arkitekt.reaper.region_operations')
-        RegionOps.paste_playlist_at_cursor(playlist_items)
+      if playlist then
+        execute_flatten_export(playlist)
       end
       ImGui.CloseCurrentPopup(ctx)
     end
@@ -137,6 +358,29 @@ function M.render(ctx, coordinator, shell_state)
       coordinator._sws_import_requested = true
       ImGui.CloseCurrentPopup(ctx)
     end
+
+    if ContextMenu.item(ctx, 'Export Active Playlist to Library') then
+      local playlist = State.get_active_playlist()
+      if playlist then
+        execute_library_export({ playlist })
+      end
+      ImGui.CloseCurrentPopup(ctx)
+    end
+
+    if ContextMenu.item(ctx, 'Export All Playlists to Library') then
+      execute_library_export(State.get_playlists())
+      ImGui.CloseCurrentPopup(ctx)
+    end
+
+    if ContextMenu.item(ctx, 'Import from Playlist Library') then
+      coordinator._library_import_requested = true
+      ImGui.CloseCurrentPopup(ctx)
+    end
+
+    if Trace.enabled and ContextMenu.item(ctx, 'Save Trace (.json)') then
+      execute_trace_dump()
+      ImGui.CloseCurrentPopup(ctx)
+    end
     ContextMenu.end_menu(ctx)
   end
 
@@ -146,7 +390,56 @@ function M.render(ctx, coordinator, shell_state)
     execute_sws_import(coordinator, ctx)
   end
 
-  -- Show SWS import result modal
+  -- Execute library import (file dialog outside the popup)
+  if coordinator._library_import_requested then
+    coordinator._library_import_requested = false
+    if coordinator.controller then
+      execute_library_import(coordinator)
+    end
+  end
+
+  -- Preview the planned append/paste/crop; apply only once confirmed
+  if region_job and not region_job.job then
+    local pending = region_job
+    ModalDialog.show_confirm(ctx, window, pending.title, pending.summary, {
+      id = '##region_job_confirm',
+      confirm_label = 'Apply',
+      on_confirm = function()
+        local RegionOps = require('arkitekt.reaper.region_operations')
+        pending.job = RegionOps.apply_plan(pending.plan, pending.proj)
+      end,
+      on_cancel = function()
+        if region_job == pending then region_job = nil end
+      end,
+      width = 0.45,
+      height = 0.3,
+    })
+  end
+
+  -- Step the running append/paste/crop job; show progress while it lasts
+  if region_job and region_job.job then
+    local job = region_job.job
+    if not job:step(REGION_JOB_BUDGET) then
+      ModalDialog.show_progress(ctx, window, region_job.title, {
+        id = '##region_job_progress',
+        message = region_job.summary,
+        progress = function()
+          if job.state ~= 'running' then return nil end
+          return job:progress(), job:status()
+        end,
+        on_cancel = function() job:cancel() end,
+        width = 0.45,
+        height = 0.3,
+      })
+    else
+      if job.error then
+        sws_result_data = { title = region_job.title .. ' Stopped', message = job.error .. '\nChanges made so far were rolled back.' }
+      end
+      region_job = nil
+    end
+  end
+
+  -- Show import/export result modal
   if sws_result_data then
     ModalDialog.show_message(ctx, window, sws_result_data.title, sws_result_data.message, {
       id = '##sws_import_result',
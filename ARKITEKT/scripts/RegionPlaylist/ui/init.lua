@@ -13,7 +13,10 @@ local BatchOperations = require('RegionPlaylist.ui.components.batch_operations')
 local TransportView = require('RegionPlaylist.ui.views.transport.transport_view')
 local LayoutView = require('RegionPlaylist.ui.views.layout_view')
 local OverflowModalView = require('RegionPlaylist.ui.views.overflow_modal_view')
+local ChangeSet = require('RegionPlaylist.app.change_set')
+local ScriptApi = require('RegionPlaylist.data.script_api')
 local Logger = require('arkitekt.debug.logger')
+local Trace = require('arkitekt.debug.trace')
 
 local M = {}
 local GUI = {}
@@ -46,8 +49,8 @@ function M.create(State, AppConfig, settings)
     State.set_separator_position_vertical(Config.SEPARATOR.vertical.default_position)
   end
   
+  -- Tabs follow via the change set (persist marks PLAYLISTS if they differ)
   State.on_state_restored = function()
-    self:refresh_tabs()
     if self.region_tiles.active_grid and self.region_tiles.active_grid.selection then
       self.region_tiles.active_grid.selection:clear()
     end
@@ -113,6 +116,10 @@ function M.create(State, AppConfig, settings)
     on_active_reorder = function(new_order)
       self.controller:reorder_items(State.get_active_playlist_id(), new_order)
     end,
+
+    on_active_move = function(item_keys, before_key)
+      self.controller:move_items(State.get_active_playlist_id(), item_keys, before_key)
+    end,
     
     on_active_remove = function(item_key)
       self.controller:delete_items(State.get_active_playlist_id(), {item_key})
@@ -135,33 +142,26 @@ function M.create(State, AppConfig, settings)
 
     -- Single item rename (inline editing)
     on_active_rename = function(item_key, new_name)
+      -- Tabs refresh on the next frame if a playlist was renamed (change set)
       self.controller:rename_item(State.get_active_playlist_id(), item_key, new_name)
-      -- Refresh tabs in case a playlist was renamed
-      self.region_tiles.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
     end,
 
     -- Batch rename with wildcards
     on_active_batch_rename = function(item_keys, pattern)
-      local has_playlists = BatchOperations.rename_active(
+      BatchOperations.rename_active(
         item_keys, pattern,
         self.region_tiles.active_grid.get_items,
         self.controller
       )
-      if has_playlists then
-        self.region_tiles.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
-      end
     end,
 
     -- Batch rename and recolor
     on_active_batch_rename_and_recolor = function(item_keys, pattern, color)
-      local has_playlists = BatchOperations.rename_and_recolor_active(
+      BatchOperations.rename_and_recolor_active(
         item_keys, pattern, color,
         self.region_tiles.active_grid.get_items,
         self.controller
       )
-      if has_playlists then
-        self.region_tiles.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
-      end
     end,
 
     -- Batch recolor only
@@ -185,32 +185,24 @@ function M.create(State, AppConfig, settings)
         local playlist_id = item_key:match('pool_playlist_(.+)')
         if playlist_id then
           self.controller:rename_playlist(playlist_id, new_name)
-          -- Refresh tabs to show updated playlist name
-          self.region_tiles.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
         end
       end
     end,
 
     -- Batch rename from pool
     on_pool_batch_rename = function(item_keys, pattern)
-      local has_playlists = BatchOperations.rename_pool(
+      BatchOperations.rename_pool(
         item_keys, pattern,
         self.controller
       )
-      if has_playlists then
-        self.region_tiles.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
-      end
     end,
 
     -- Batch rename and recolor from pool
     on_pool_batch_rename_and_recolor = function(item_keys, pattern, color)
-      local has_playlists = BatchOperations.rename_and_recolor_pool(
+      BatchOperations.rename_and_recolor_pool(
         item_keys, pattern, color,
         self.controller
       )
-      if has_playlists then
-        self.region_tiles.active_container:set_tabs(State.get_tabs(), State.get_active_playlist_id())
-      end
     end,
 
     -- Batch recolor from pool
@@ -323,10 +315,19 @@ function M.create(State, AppConfig, settings)
   self.overflow_modal_view = OverflowModalView.new(self.region_tiles, State, function()
     self:refresh_tabs()
   end)
+
+  -- Batch edit requests from other ReaScripts
+  self.script_api = ScriptApi.new_server()
   
   return self
 end
 
+function GUI:close()
+  if self.script_api then
+    self.script_api:close()
+  end
+end
+
 function GUI:refresh_tabs()
   self.region_tiles:set_tabs(self.State.get_tabs(), self.State.get_active_playlist_id())
 end
@@ -338,6 +339,17 @@ function GUI:update_state(ctx, window)
 
   self.State.get_bridge():update()
   self.State.Update()
+  self.script_api:poll(self.controller, self.State)
+
+  -- Coalesced refresh: everything marked since last frame, applied once.
+  -- Tabs are only rebuilt when the playlist set itself changed.
+  local changes = self.State.take_changes()
+  if changes ~= 0 then
+    if changes & ChangeSet.PLAYLISTS ~= 0 then
+      self:refresh_tabs()
+    end
+    self.layout_view:invalidate(changes)
+  end
 
   -- Sync layout_mode from State to region_tiles when it changes
   local current_layout_mode = self.State.get_layout_mode()
@@ -395,9 +407,12 @@ function GUI:update_state(ctx, window)
 end
 
 function GUI:draw(ctx, window, shell_state)
+  local span = Trace.begin('ui', 'draw')
   self.shell_state = shell_state
 
+  local update_span = Trace.begin('ui', 'update_state')
   self:update_state(ctx, window)
+  Trace.finish(update_span)
 
   -- Get cursor position BEFORE drawing transport
   local transport_start_x, transport_start_y = ImGui.GetCursorScreenPos(ctx)
@@ -413,6 +428,7 @@ function GUI:draw(ctx, window, shell_state)
   self.layout_view:draw(ctx, self.region_tiles, shell_state)
 
   self.region_tiles:draw_ghosts(ctx)
+  Trace.finish(span)
 end
 
 return M
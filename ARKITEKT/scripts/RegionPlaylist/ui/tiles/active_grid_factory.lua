@@ -179,21 +179,43 @@ local function create_behaviors(rt)
             end
           end
         end
-      elseif rt.on_active_reorder then
+      elseif rt.on_active_move or rt.on_active_reorder then
         local playlist_items = grid.get_items()
         local items_by_key = {}
         for _, item in ipairs(playlist_items) do
           items_by_key[item.key] = item
         end
 
-        local new_items = {}
-        for _, key in ipairs(new_order) do
-          if items_by_key[key] then
-            new_items[#new_items + 1] = items_by_key[key]
+        if rt.on_active_move then
+          -- Batch move: new_order is [prefix, dragged..., suffix]; the first
+          -- suffix key is the drop anchor. One splice on the full playlist
+          -- (also correct when the view is search-filtered).
+          local dragged_ids = grid.drag:get_dragged_ids()
+          local dragged_set = {}
+          for _, key in ipairs(dragged_ids) do dragged_set[key] = true end
+
+          local before_key = nil
+          local seen_dragged = false
+          for _, key in ipairs(new_order) do
+            if dragged_set[key] then
+              seen_dragged = true
+            elseif seen_dragged then
+              before_key = key
+              break
+            end
           end
-        end
 
-        rt.on_active_reorder(new_items)
+          rt.on_active_move(dragged_ids, before_key)
+        else
+          local new_items = {}
+          for _, key in ipairs(new_order) do
+            if items_by_key[key] then
+              new_items[#new_items + 1] = items_by_key[key]
+            end
+          end
+
+          rt.on_active_reorder(new_items)
+        end
 
         -- Show move notification
         if rt.State and rt.State.set_state_change_notification and grid.drag then
@@ -465,6 +487,8 @@ function M.create_opts(rt, config)
     min_col_w = rt._active_min_col_w_fn or function() return ActiveTile.CONFIG.tile_width end,
     fixed_tile_h = rt._active_tile_height or base_tile_height,
     items = rt._active_items or {},
+    -- Large playlists: only lay out visible rows
+    virtual = #(rt._active_items or {}) >= ActiveTile.CONFIG.virtual_threshold,
     key = function(item) return item.key end,
 
     external_drag_check = create_external_drag_check(rt),
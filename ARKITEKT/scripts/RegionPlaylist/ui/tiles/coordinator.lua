@@ -14,6 +14,7 @@ local Dnd = require('arkitekt.gui.interaction.drag_visual')
 local DragIndicator = Dnd.DragIndicator
 local BatchRenameModal = require('arkitekt.gui.widgets.overlays.batch_rename_modal')
 local State = require('RegionPlaylist.app.state')
+local PlaylistDomain = require('RegionPlaylist.domain.playlist')
 
 -- Menu components
 local ActiveActionsMenu = require('RegionPlaylist.ui.components.menus.active_actions_menu')
@@ -121,22 +122,22 @@ function Coordinator:_get_drag_colors()
     if type(data) == 'table' and self.active_grid then
       local playlist_items = self.active_grid.get_items()
       for _, key in ipairs(data) do
-        for _, item in ipairs(playlist_items) do
-          if item.key == key then
-            if item.type == 'playlist' then
-              if self.get_playlist_by_id then
-                local playlist = self.get_playlist_by_id(item.playlist_id)
-                if playlist and playlist.chip_color then
-                  colors[#colors + 1] = playlist.chip_color
-                end
-              end
-            else
-              local region = self.get_region_by_rid(item.rid)
-              if region and region.color then
-                colors[#colors + 1] = region.color
+        -- Position lookup (O(1)) instead of scanning the playlist per dragged key
+        local idx = PlaylistDomain.find_item_index(playlist_items, key)
+        local item = idx and playlist_items[idx]
+        if item then
+          if item.type == 'playlist' then
+            if self.get_playlist_by_id then
+              local playlist = self.get_playlist_by_id(item.playlist_id)
+              if playlist and playlist.chip_color then
+                colors[#colors + 1] = playlist.chip_color
               end
             end
-            break
+          else
+            local region = self.get_region_by_rid(item.rid)
+            if region and region.color then
+              colors[#colors + 1] = region.color
+            end
           end
         end
       end
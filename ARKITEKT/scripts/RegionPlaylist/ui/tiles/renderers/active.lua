@@ -31,7 +31,7 @@ local M = {}
 -- ============================================================================
 -- PROFILING (set to true to enable, check REAPER console for output)
 -- ============================================================================
-local PROFILE_ENABLED = true
+local PROFILE_ENABLED = false
 local _profile = {
   animator = 0,
   color = 0,
@@ -96,6 +96,9 @@ M.CONFIG = {
   badge_text_nudge_y = -1,
   -- Spawn animation
   spawn = { enabled = true, duration = 0.25, scale_start = 0.8 },
+  -- Playlists at or above this size use the grid's virtual mode
+  -- (only visible rows are laid out; no reorder animation)
+  virtual_threshold = 300,
   -- Overlap warning badge (RED - nested regions)
   overlap = {
     icon = '⚠',
@@ -123,6 +126,61 @@ M.CONFIG = {
   },
 }
 
+-- ============================================================================
+-- PER-FRAME PLAYBACK SNAPSHOT
+-- ============================================================================
+-- Bridge queries are resolved once per frame instead of once per tile.
+-- Tiles that are not part of the current playback chain only do table lookups.
+
+local _frame = {
+  is_playing = false,
+  current_key = nil,
+  progress = 0,
+  skipped = nil,
+  active_playlists = {},   -- ancestry key -> true
+  playlist_progress = {},  -- ancestry key -> progress (lazy)
+  bridge = nil,
+}
+
+--- Capture playback state for this frame (call once before drawing the grid)
+--- @param bridge table|nil App bridge
+function M.begin_frame(bridge)
+  local f = _frame
+  f.bridge = bridge
+  f.current_key = nil
+  f.progress = 0
+  f.skipped = nil
+
+  local active = f.active_playlists
+  for k in pairs(active) do active[k] = nil end
+  local progress = f.playlist_progress
+  for k in pairs(progress) do progress[k] = nil end
+
+  f.is_playing = bridge and bridge.engine and bridge.engine:get_is_playing() or false
+  if not f.is_playing then return end
+
+  f.current_key = bridge:get_current_item_key()
+  f.progress = f.current_key and bridge:get_progress() or 0
+  f.skipped = bridge:get_skipped_keys()
+
+  local ancestry = bridge:get_current_ancestry()
+  if ancestry then
+    for i = 1, #ancestry do
+      local key = ancestry[i].key
+      if key then active[key] = true end
+    end
+  end
+end
+
+local function get_playlist_progress(key)
+  local cached = _frame.playlist_progress[key]
+  if cached == nil then
+    cached = _frame.bridge:get_playlist_progress(key) or 0
+    _frame.playlist_progress[key] = cached
+  end
+  return cached
+end
+
 local function clamp_min_lightness(color, min_l)
   local lum = Colors_Luminance(color)
   if lum < (min_l or 0) then
@@ -170,7 +228,6 @@ function M.render_region(opts)
   local hover_config = opts.hover_config
   local tile_height = opts.tile_height
   local border_thickness = opts.border_thickness
-  local bridge = opts.bridge
   local grid = opts.grid
   local dl = ImGui.GetWindowDrawList(ctx)
   local x1, y1, x2, y2 = rect[1], rect[2], rect[3], rect[4]
@@ -180,11 +237,8 @@ function M.render_region(opts)
   local is_enabled = item.enabled ~= false
 
   -- Check if this item is being skipped due to scheduled transition
-  local is_skipped = false
-  if bridge then
-    local skipped_keys = bridge:get_skipped_keys()
-    is_skipped = skipped_keys and skipped_keys[item.key] or false
-  end
+  local skipped_keys = _frame.skipped
+  local is_skipped = skipped_keys and skipped_keys[item.key] or false
 
   animator:track(item.key, 'hover', state.hover and 1.0 or 0.0, hover_config and hover_config.animation_speed_hover or 12.0)
   animator:track(item.key, 'enabled', is_enabled and 1.0 or 0.0, M.CONFIG.disabled.fade_speed)
@@ -217,10 +271,9 @@ function M.render_region(opts)
   local t3 = PROFILE_ENABLED and time_precise() or 0
 
   local playback_progress, playback_fade = 0, 0
-  if bridge and bridge:get_state().is_playing then
-    local current_key = bridge:get_current_item_key()
-    if current_key == item.key then
-      playback_progress = bridge:get_progress() or 0
+  if _frame.is_playing then
+    if _frame.current_key == item.key then
+      playback_progress = _frame.progress
       -- Store progress for fade out
       animator:track(item.key, 'last_progress', playback_progress, 999)  -- Instant update
       -- Time-based fade: fade in when playing, fade out at 100% or when stopped
@@ -508,10 +561,10 @@ function M.render_playlist(opts)
 
   -- Check if this playlist is currently playing (includes nested playlists)
   local playback_progress, playback_fade = 0, 0
-  if bridge and bridge:get_state().is_playing then
-    -- Use is_playlist_active to support deep nesting - all parent playlists show progress
-    if bridge:is_playlist_active(item.key) then
-      playback_progress = bridge:get_playlist_progress(item.key) or 0
+  if _frame.is_playing then
+    -- Ancestry set supports deep nesting - all parent playlists show progress
+    if _frame.active_playlists[item.key] then
+      playback_progress = get_playlist_progress(item.key)
       -- Store progress for fade out
       animator:track(item.key, 'last_progress', playback_progress, 999)  -- Instant update
       -- Time-based fade: fade in when playing, fade out at 100% or when stopped
@@ -590,7 +643,7 @@ function M.render_playlist(opts)
       local reps_text = (reps == 0) and '∞' or tostring(reps)
       local tooltip = string.format('Playlist • %d items • ×%s repeats', playlist_data.item_count, reps_text)
       
-      if bridge and bridge:get_state().is_playing then
+      if bridge and _frame.is_playing then
         local current_playlist_key = bridge:get_current_playlist_key()
         if current_playlist_key == item.key then
           local time_remaining = bridge:get_playlist_time_remaining(item.key)
@@ -56,6 +56,35 @@ M.CONFIG = {
 -- Cache for reserved index width (calculated once per context)
 local _reserved_index_width_cache = {}
 
+-- Cache for formatted bar lengths: [start][end] -> string
+-- format_bar_length hits the tempo map (3 API calls), so tiles reuse the
+-- string until the project state count (marker/tempo generation) changes.
+local _length_cache = {}
+local _length_generation = nil
+
+--- Invalidate cached cell text when the project generation changes
+--- @param generation number|nil Project state change count
+function M.begin_frame(generation)
+  if generation ~= _length_generation then
+    _length_cache = {}
+    _length_generation = generation
+  end
+end
+
+local function get_length_string(start_time, end_time)
+  local by_start = _length_cache[start_time]
+  if not by_start then
+    by_start = {}
+    _length_cache[start_time] = by_start
+  end
+  local str = by_start[end_time]
+  if not str then
+    str = TileUtil.format_bar_length(start_time, end_time, 0)
+    by_start[end_time] = str
+  end
+  return str
+end
+
 -- ========================================
 -- AUTOMATED TEXT OVERFLOW SYSTEM
 -- ========================================
@@ -300,7 +329,7 @@ function M.draw_length_display(ctx, dl, rect, region, base_color, text_alpha)
   local height_factor = min(1.0, max(0.0, ((y2 - rect[2]) - 20) / (72 - 20)))
   local fx_config = TileFXConfig.get()
 
-  local length_str = TileUtil.format_bar_length(region.start, region['end'], 0)
+  local length_str = get_length_string(region.start, region['end'])
   local scaled_margin = M.CONFIG.length_margin * (0.3 + 0.7 * height_factor)
 
   -- Measure text at actual draw size (ReaImGui draws at full font size)
@@ -326,7 +355,7 @@ function M.draw_playlist_length_display(ctx, dl, rect, playlist_data, base_color
 
   -- Format using TileUtil.format_bar_length (same as regions)
   -- Pass 0 as start and total_duration as end to get the duration formatted
-  local length_str = TileUtil.format_bar_length(0, total_duration_seconds, 0)
+  local length_str = get_length_string(0, total_duration_seconds)
 
   local scaled_margin = M.CONFIG.length_margin * (0.3 + 0.7 * height_factor)
 
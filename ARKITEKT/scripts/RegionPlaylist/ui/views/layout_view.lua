@@ -6,6 +6,9 @@ local ImGui = require('arkitekt.core.imgui')
 local Ark = require('arkitekt')
 local Logger = require('arkitekt.debug.logger')
 local TileFXConfig = require('arkitekt.gui.renderers.tile.defaults')
+local BaseRenderer = require('RegionPlaylist.ui.tiles.renderers.base')
+local ActiveTile = require('RegionPlaylist.ui.tiles.renderers.active')
+local ChangeSet = require('RegionPlaylist.app.change_set')
 
 -- Performance: Localize math functions for hot path (30% faster in loops)
 local max = math.max
@@ -13,6 +16,14 @@ local min = math.min
 
 local M = {}
 
+-- Which change bits make each pool mode's data stale
+local POOL_DEPENDENCIES = {
+  regions = ChangeSet.REGIONS | ChangeSet.POOL_VIEW,
+  playlists = ChangeSet.PLAYLISTS | ChangeSet.ITEMS | ChangeSet.REGIONS | ChangeSet.POOL_VIEW,
+  mixed = ChangeSet.ALL,
+}
+local ACTIVE_FILTER_DEPENDENCIES = ChangeSet.PLAYLISTS | ChangeSet.ITEMS | ChangeSet.REGIONS
+
 local LayoutView = {}
 LayoutView.__index = LayoutView
 
@@ -20,18 +31,39 @@ function M.new(config, state_module)
   return setmetatable({
     config = config,
     state = state_module,
+
+    -- Cached per-frame query results, rebuilt only when their inputs change
+    pending_changes = ChangeSet.ALL,
+    pool_data = nil,
+    pool_data_mode = nil,
+    active_filtered = nil,
+    active_filter_key = nil,
   }, LayoutView)
 end
 
+--- Accumulate changes consumed from State (GUI calls this once per frame)
+--- @param mask number ChangeSet bits
+function LayoutView:invalidate(mask)
+  self.pending_changes = self.pending_changes | mask
+end
+
 function LayoutView:get_filtered_active_items(playlist)
   local filter = self.state.active_search_filter or ''
   
   if filter == '' then
+    self.active_filtered = nil
     return playlist.items
   end
+
+  local filter_key = playlist.id .. '\0' .. filter
+  if self.active_filtered and self.active_filter_key == filter_key
+      and self.pending_changes & ACTIVE_FILTER_DEPENDENCIES == 0 then
+    return self.active_filtered
+  end
   
   local filtered = {}
   local filter_lower = filter:lower()
+  local region_matches = self.state.search_regions(filter_lower)
   
   for _, item in ipairs(playlist.items) do
     if item.type == 'playlist' then
@@ -40,24 +72,49 @@ function LayoutView:get_filtered_active_items(playlist)
       if name_lower:find(filter_lower, 1, true) then
         filtered[#filtered + 1] = item
       end
-    else
-      local region = self.state.get_region_by_rid(item.rid)
-      if region then
-        local name_lower = region.name:lower()
-        if name_lower:find(filter_lower, 1, true) then
-          filtered[#filtered + 1] = item
-        end
-      end
+    elseif region_matches[item.rid] then
+      filtered[#filtered + 1] = item
     end
   end
   
+  self.active_filtered = filtered
+  self.active_filter_key = filter_key
   return filtered
 end
 
+--- Pool data for the current mode, rebuilt only when its inputs changed
+function LayoutView:get_pool_data()
+  local pool_mode = self.state.get_pool_mode()
+  local deps = POOL_DEPENDENCIES[pool_mode] or ChangeSet.ALL
+  if self.pool_data and pool_mode == self.pool_data_mode
+      and self.pending_changes & deps == 0 then
+    return self.pool_data
+  end
+
+  local pool_data
+  if pool_mode == 'playlists' then
+    pool_data = self.state.get_playlists_for_pool()
+  elseif pool_mode == 'mixed' then
+    pool_data = self.state.get_mixed_pool_sorted()
+  else
+    pool_data = self.state.get_filtered_pool_regions()
+  end
+
+  self.pool_data = pool_data
+  self.pool_data_mode = pool_mode
+  return pool_data
+end
+
 function LayoutView:draw(ctx, region_tiles, shell_state)
   -- PERF: Cache TileFXConfig once per frame before rendering grids
   TileFXConfig.begin_frame(ctx)
 
+  -- PERF: Resolve playback state once per frame (not per tile), and drop
+  -- cached tile text when regions/tempo changed (project state count)
+  local bridge = self.state.get_bridge()
+  ActiveTile.begin_frame(bridge)
+  BaseRenderer.begin_frame(bridge and bridge.engine.state.state_change_count)
+
   local pl = self.state.get_active_playlist()
   local filtered_active_items = self:get_filtered_active_items(pl)
   local display_playlist = {
@@ -66,15 +123,10 @@ function LayoutView:draw(ctx, region_tiles, shell_state)
     items = filtered_active_items,
   }
 
-  local pool_data
-  local pool_mode = self.state.get_pool_mode()
-  if pool_mode == 'playlists' then
-    pool_data = self.state.get_playlists_for_pool()
-  elseif pool_mode == 'mixed' then
-    pool_data = self.state.get_mixed_pool_sorted()
-  else
-    pool_data = self.state.get_filtered_pool_regions()
-  end
+  local pool_data = self:get_pool_data()
+
+  -- Both caches are up to date for this frame's changes
+  self.pending_changes = 0
 
   -- Sync layout_mode from State to region_tiles if changed (handles mid-frame updates)
   local current_layout_mode = self.state.get_layout_mode()